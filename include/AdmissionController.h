@@ -0,0 +1,103 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <optional>
+
+/**
+ * @brief 线程池前的准入控制
+ *
+ * 每个进入线程池的任务先申请一张 Ticket，占用一个任务名额、其图像数据的字节数
+ * 和按滤镜估算的工作量；任一项超过上限即拒绝，由 Reactor 直接回复 503。
+ * Ticket 随任务一起销毁时归还占用。所有判定结果都会计数，供 /stats 查看调优。
+ * 线程安全：Reactor 线程申请，线程池线程归还。
+ */
+class AdmissionController {
+public:
+    struct Limits {
+        size_t max_tasks;    // 排队 + 执行中的任务数上限
+        size_t max_bytes;    // 任务持有的图像数据总字节数上限
+        size_t max_work;     // 估算工作量总和上限
+    };
+
+    struct Stats {
+        uint64_t admitted;
+        uint64_t rejected_tasks;
+        uint64_t rejected_bytes;
+        uint64_t rejected_work;
+        size_t tasks;
+        size_t bytes;
+        size_t work;
+    };
+
+    /**
+     * @brief 准入凭证，析构时归还占用（只允许移动）
+     */
+    class Ticket {
+    public:
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket();
+
+    private:
+        friend class AdmissionController;
+        Ticket(AdmissionController* owner, size_t bytes, size_t work)
+            : _owner(owner), _bytes(bytes), _work(work) {}
+        void release();
+
+        AdmissionController* _owner;
+        size_t _bytes;
+        size_t _work;
+    };
+
+    AdmissionController(const Limits& limits, int retry_after_seconds);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    /**
+     * @brief 申请执行一个任务
+     * @param bytes 任务持有的数据字节数
+     * @param work 估算工作量（见 estimate_work）
+     * @return 准入时返回 Ticket，超出任一上限返回空
+     */
+    std::optional<Ticket> try_admit(size_t bytes, size_t work);
+
+    /**
+     * @brief 按滤镜类型和图像大小估算工作量（单位：一次普通滤镜处理 1MB 图像）
+     */
+    static size_t estimate_work(const std::string& filter, size_t bytes);
+
+    /**
+     * @brief 拒绝时建议客户端重试的间隔（Retry-After，秒）
+     */
+    int retry_after_seconds() const { return _retry_after_seconds; }
+
+    const Limits& limits() const { return _limits; }
+
+    Stats stats() const;
+
+private:
+    void release(size_t bytes, size_t work);
+
+    const Limits _limits;
+    const int _retry_after_seconds;
+
+    mutable std::mutex _mutex;
+    size_t _tasks;
+    size_t _bytes;
+    size_t _work;
+
+    std::atomic<uint64_t> _admitted;
+    std::atomic<uint64_t> _rejected_tasks;
+    std::atomic<uint64_t> _rejected_bytes;
+    std::atomic<uint64_t> _rejected_work;
+};
+
+#endif // ADMISSION_CONTROLLER_H
@@ -0,0 +1,54 @@
+#ifndef BATCH_RESPONSE_H
+#define BATCH_RESPONSE_H
+
+#include "Server.h"
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 批量接口（POST /batch）的 multipart/mixed 响应，各图像按完成顺序写出
+ *
+ * 每个 part 带 X-Index（图像在请求中的序号）和 X-Status，客户端据此与请求对应。
+ * HTTP/1.1 使用 chunked 响应，图像处理完即发送，不必等整批完成；
+ * HTTP/1.0 客户端不支持 chunked，所有 part 缓存到最后一张完成时一次发送。
+ *
+ * 同一批的任务共享一个实例（shared_ptr），complete() 可在任意线程调用。
+ * 有任务异常退出时最后一张永远不会完成，最后一个引用释放时由 RequestGuard 关闭连接，
+ * 客户端收不到结束分隔符，可以识别出响应不完整。
+ */
+class BatchResponse {
+public:
+    /**
+     * @param chunked 客户端是否支持 chunked 响应（HTTP/1.1）
+     * @param count 本批图像数
+     */
+    BatchResponse(Reactor& reactor, uint64_t handle, bool keep_alive, bool chunked, size_t count);
+
+    /**
+     * @brief 一张图像处理完成，立即作为一个 part 发送（线程安全）
+     * @param index 图像在请求中的序号
+     * @param name 图像 part 的字段名
+     * @param content_type 图像的 Content-Type
+     * @param data 编码后的图像，为空表示处理失败（发送 X-Status: 500 的文本 part）
+     */
+    void complete(size_t index, const std::string& name, const std::string& content_type, std::vector<char> data);
+
+    BatchResponse(const BatchResponse&) = delete;
+    BatchResponse& operator=(const BatchResponse&) = delete;
+
+private:
+    void write(std::vector<char> data);
+
+    std::mutex _mutex;
+    RequestGuard _guard;
+    bool _keep_alive;
+    bool _chunked;
+    std::string _boundary;
+    size_t _remaining;     // 尚未完成的图像数
+    bool _first_part;      // 第一个分隔符前面没有 "\r\n"
+    std::vector<char> _buffered;  // HTTP/1.0：缓存的完整 body
+};
+
+#endif // BATCH_RESPONSE_H
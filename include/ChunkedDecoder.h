@@ -0,0 +1,52 @@
+#ifndef CHUNKED_DECODER_H
+#define CHUNKED_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief 增量 chunked 传输编码解码器
+ *
+ * 用于被接管的连接（推流等）：请求体长度未知，客户端以 Transfer-Encoding: chunked 发送。
+ * 数据可在任意位置被切分，负载原样交给 sink，不缓存；chunk 扩展和 trailer 被忽略。
+ */
+class ChunkedDecoder {
+public:
+    using Sink = std::function<void(const char* data, size_t len)>;
+
+    ChunkedDecoder();
+
+    /**
+     * @brief 解码一段数据
+     * @param sink 依次收到各 chunk 的负载（可能分多次）
+     * @return 格式错误时返回 false，之后的调用都返回 false
+     */
+    bool decode(const char* data, size_t len, const Sink& sink);
+
+    // 已收到结束 chunk 和 trailer，之后的数据被忽略
+    bool done() const { return _state == State::DONE; }
+
+    void reset();
+
+private:
+    enum class State {
+        SIZE,        // chunk 长度（十六进制）
+        EXTENSION,   // 长度之后的扩展，直到 "\r"
+        SIZE_LF,
+        DATA,
+        DATA_CR,     // 负载之后的 "\r\n"
+        DATA_LF,
+        TRAILER,     // 结束 chunk 之后的 trailer 行，直到空行
+        TRAILER_LF,
+        DONE,
+        ERROR
+    };
+
+    State _state;
+    uint64_t _remaining;   // 当前 chunk 剩余的负载字节（SIZE 阶段为已解析的长度）
+    size_t _digits;        // 已解析的十六进制位数
+    size_t _line_len;      // 当前 trailer 行的长度
+};
+
+#endif // CHUNKED_DECODER_H
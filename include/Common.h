@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <memory>
 #include <functional>
 
@@ -16,7 +17,20 @@ constexpr int BACKLOG = 128;
 
 // 文件上传限制
 constexpr size_t MAX_FILE_SIZE = 50 * 1024 * 1024;  // 50MB
-constexpr size_t MAX_IMAGE_SIZE = 20 * 1024 * 1024; // 20MB (图像专用)
+constexpr size_t MAX_IMAGE_SIZE = 20 * 1024 * 1024; // 20MB (图像专用，image_processing.max_image_size 的上限)
+constexpr size_t MAX_HEADER_SIZE = 16 * 1024;       // 请求行 + 请求头默认上限 (server.max_header_size)
+
+// 只读字节视图（C++17 没有 std::span），不持有数据，调用方保证数据在使用期间有效
+struct ByteView {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    ByteView() = default;
+    ByteView(const char* bytes, size_t len) : data(bytes), size(len) {}
+    ByteView(const std::vector<char>& bytes) : data(bytes.data()), size(bytes.size()) {}
+
+    bool empty() const { return size == 0; }
+};
 
 // 文件保存路径配置
 constexpr const char* UPLOAD_DIR = "uploads";  // 上传文件保存目录
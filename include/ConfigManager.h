@@ -44,8 +44,21 @@ public:
     
     // 服务器配置
     std::vector<int> getServerPorts() const;
+    std::vector<std::string> getServerUnixSockets() const;  // server.ports 中的 "unix:..." 地址
+    int getUnixSendBufferSize() const;
+    int getUnixRecvBufferSize() const;
     int getThreadPoolSize() const;
+    int getReactorThreads() const;
     int getMaxConnections() const;
+    int getAcceptBatch() const;
+    int getDeferAcceptSeconds() const;
+    int getHeaderTimeoutMs() const;
+    int getBodyTimeoutMs() const;
+    int getMinBodyRate() const;
+    int getKeepAliveTimeoutMs() const;
+    int getMaxHeaderSize() const;
+    std::string getIOBackend() const;
+    std::string getHotRestartSocket() const;
     std::string getServerIP() const;
     
     // YOLO配置
@@ -63,6 +76,26 @@ public:
     std::vector<std::string> getSupportedFormats() const;
     int getOutputQuality() const;
     
+    // 准入控制配置
+    int getAdmissionMaxQueuedTasks() const;
+    long long getAdmissionMaxInflightBytes() const;
+    int getAdmissionMaxWorkUnits() const;
+    int getAdmissionRetryAfterSeconds() const;
+    
+    // 流式响应配置
+    bool isStreamingEnabled() const;
+    int getStreamingMinPixels() const;
+    int getStreamingChunkSize() const;
+
+    // 批量接口配置
+    int getBatchMaxImages() const;
+    int getBatchYOLOBatchSize() const;
+
+    // HTTP/2 (h2c) 配置
+    bool isHttp2Enabled() const;
+    int getHttp2MaxConcurrentStreams() const;
+    int getHttp2InitialWindowSize() const;
+    
     // 日志配置
     std::string getLogLevel() const;
     bool isConsoleLogEnabled() const;
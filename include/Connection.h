@@ -0,0 +1,56 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include "HttpParser.h"
+#include "HttpResponse.h"
+#include "TimerWheel.h"
+#include "StreamHandler.h"
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <memory>
+
+/**
+ * @brief 客户端连接状态
+ *
+ * 由所属 Reactor 线程独占访问。Connection 对象保存在按 fd 索引的
+ * ConnectionTable 中，连接关闭后对象保留并在同一 fd 再次被分配时复用；
+ * 同一连接上的 HttpParser 在 keep-alive 期间通过 reset() 复用。
+ */
+struct Connection {
+    using Clock = std::chrono::steady_clock;
+
+    int fd = -1;
+    uint32_t generation = 0;  // 每次复用递增，用于识别过期的句柄
+    bool active = false;
+
+    HttpParser parser;
+    bool in_flight = false;  // 请求已分发、响应尚未完成，期间暂停读取
+    std::shared_ptr<StreamHandler> handler;  // 连接已被接管，收到的数据直接交给处理器
+
+    // 待发送的响应数据，由 Reactor 在 EPOLLOUT 时继续发送
+    std::deque<HttpResponse> out_queue;
+    bool keep_alive_after_write = true;
+    bool streaming = false;  // chunked 响应的分块尚未全部交来，发送队列清空时不结束请求
+    bool lingering = false;  // 拒绝请求的响应已发出并半关闭，丢弃客户端剩余的数据后关闭
+    size_t lingered = 0;     // lingering 期间丢弃的字节数
+
+    Clock::time_point accepted_at;    // 连接建立时间
+    Clock::time_point last_activity;  // 最近一次读写时间
+
+    // 超时管理：同一时刻只有一个定时器生效，类型由连接所处阶段决定
+    enum class Timeout {
+        NONE,     // 请求处理中（线程池），不计时
+        HEADER,   // 等待请求头接收完整
+        BODY,     // 接收 body，按周期检查最低速率
+        IDLE,     // keep-alive 空闲，等待下一个请求
+        WRITE,    // 响应发送受阻，等待客户端读取
+        LINGER,   // 拒绝请求后丢弃剩余数据，到期时关闭
+        STREAM    // 连接已被接管，超过 keep-alive 超时没有收到数据时关闭
+    };
+    TimerNode timer;
+    Timeout timeout = Timeout::NONE;
+    size_t body_checkpoint = 0;  // 上一次速率检查时已接收的 body 字节数
+};
+
+#endif // CONNECTION_H
@@ -0,0 +1,92 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include "Connection.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 按 fd 直接索引的连接池
+ *
+ * 内核总是分配最小的可用 fd，因此以 fd 为下标的数组足够紧凑；查找无需哈希，
+ * 槽位中的 Connection 在连接关闭后保留并复用，连接频繁建立/断开时不再分配内存。
+ *
+ * 句柄（handle）= generation << 32 | fd，存放在 epoll_event.data.u64 中，
+ * 也用于跨线程投递的回调：fd 被关闭并重新分配后旧句柄自动失效。
+ *
+ * HTTP/2 连接上的每个流另有流句柄 = STREAM_HANDLE_FLAG | token << 32 | fd，
+ * token 由 Reactor 分配，由接管连接的处理器映射到流；流句柄不指向连接本身。
+ */
+class ConnectionTable {
+public:
+    // 句柄高两位留给 Reactor 区分监听socket/唤醒事件
+    static constexpr uint32_t GENERATION_MASK = 0x3FFFFFFF;
+    // 流句柄的标记位（流句柄不进入 epoll/io_uring，不与 Reactor 的标记冲突）
+    static constexpr uint64_t STREAM_HANDLE_FLAG = 1ULL << 63;
+    static constexpr uint32_t STREAM_TOKEN_MASK = 0x7FFFFFFF;
+
+    /**
+     * @brief 为新连接分配（或复用）槽位
+     * @return 已初始化的连接
+     */
+    Connection& open(int fd);
+
+    /**
+     * @brief 释放槽位（不关闭 fd），槽位中的对象留待复用
+     */
+    void release(int fd);
+
+    /**
+     * @brief 按 fd 查找活跃连接
+     * @return 连接，不存在返回 nullptr
+     */
+    Connection* get(int fd) const {
+        if (fd < 0 || static_cast<size_t>(fd) >= _slots.size()) return nullptr;
+        Connection* conn = _slots[fd].get();
+        return (conn && conn->active) ? conn : nullptr;
+    }
+
+    /**
+     * @brief 按句柄查找活跃连接，句柄过期或是流句柄时返回 nullptr
+     */
+    Connection* get_by_handle(uint64_t handle) const {
+        if (is_stream_handle(handle)) return nullptr;
+        Connection* conn = get(handle_fd(handle));
+        return (conn && conn->generation == handle_generation(handle)) ? conn : nullptr;
+    }
+
+    static uint64_t make_handle(const Connection& conn) {
+        return (static_cast<uint64_t>(conn.generation) << 32) | static_cast<uint32_t>(conn.fd);
+    }
+    static int handle_fd(uint64_t handle) {
+        return static_cast<int>(static_cast<uint32_t>(handle));
+    }
+    static uint32_t handle_generation(uint64_t handle) {
+        return static_cast<uint32_t>(handle >> 32) & GENERATION_MASK;
+    }
+    static uint64_t make_stream_handle(int fd, uint32_t token) {
+        return STREAM_HANDLE_FLAG | (static_cast<uint64_t>(token & STREAM_TOKEN_MASK) << 32) | static_cast<uint32_t>(fd);
+    }
+    static bool is_stream_handle(uint64_t handle) {
+        return (handle & STREAM_HANDLE_FLAG) != 0;
+    }
+    static uint32_t handle_token(uint64_t handle) {
+        return static_cast<uint32_t>(handle >> 32) & STREAM_TOKEN_MASK;
+    }
+
+    /**
+     * @brief 遍历所有活跃连接
+     */
+    template<class F>
+    void for_each(F&& f) {
+        for (auto& slot : _slots) {
+            if (slot && slot->active) f(*slot);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Connection>> _slots;  // 下标为 fd
+};
+
+#endif // CONNECTION_TABLE_H
@@ -0,0 +1,46 @@
+#ifndef EPOLL_REACTOR_H
+#define EPOLL_REACTOR_H
+
+#include <sys/epoll.h>
+#include <cstdint>
+#include <vector>
+#include "Reactor.h"
+
+/**
+ * @brief 基于 epoll 的 Reactor 后端（默认）
+ *
+ * 监听 socket 为水平触发，按批 accept4；客户端 socket 以边缘触发一次性注册读写事件，
+ * 读取使用 readv（body 阶段直接读入解析器缓冲区），发送使用 sendmsg 合并整个响应队列。
+ * epoll_wait 的超时取自最近的连接定时器。
+ */
+class EpollReactor : public Reactor {
+public:
+    EpollReactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                 const std::vector<ListenSocket>& inherited = {});
+    ~EpollReactor() override;
+
+    void run() override;
+    const char* backend_name() const override { return "epoll"; }
+    void close_connection(int fd) override;
+
+protected:
+    void handle_client_data(int client_fd) override;
+    void flush(Connection& conn) override;
+    void stop_accepting() override;
+
+private:
+    void handle_new_connection(int listen_fd);
+    void handle_client_write(int client_fd);
+
+    // epoll_event.data.u64 的高位用于区分事件来源，避免逐个比较监听 socket
+    static constexpr uint64_t LISTEN_TAG = 1ULL << 63;
+    static constexpr uint64_t WAKEUP_TAG = 1ULL << 62;
+
+    int _epoll_fd;
+    int _accept_batch;  // 每次监听事件最多接受的连接数（server.accept_batch）
+
+    // 本 Reactor 所有连接共用的接收缓冲区（头部和超出 body 的数据），避免每次事件分配
+    std::vector<char> _recv_buffer;
+};
+
+#endif // EPOLL_REACTOR_H
@@ -0,0 +1,79 @@
+#ifndef HOT_RESTART_H
+#define HOT_RESTART_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include "Reactor.h"
+
+/**
+ * @brief 热重启：通过 Unix 域 socket（SCM_RIGHTS）把监听 socket 交给新进程
+ *
+ * 运行中的进程在 server.hot_restart_socket 上等待升级。新进程（-u 启动）：
+ * 1. fetch() 取得旧进程的全部监听 socket 直接使用，交接期间到达的连接
+ *    留在共享的监听队列中，不会被拒绝；
+ * 2. 模型加载、预热完成后 notify_ready()，旧进程随即停止 accept，
+ *    处理完已有连接和线程池任务后退出；
+ * 3. 自己再调用 serve() 等待下一次升级。
+ * 新进程在 notify_ready() 之前退出时，旧进程照常服务，可以再次升级。
+ */
+class HotRestart {
+public:
+    explicit HotRestart(const std::string& socket_path);
+    ~HotRestart();
+
+    HotRestart(const HotRestart&) = delete;
+    HotRestart& operator=(const HotRestart&) = delete;
+
+    /**
+     * @brief 新进程：从旧进程取得监听 socket
+     * @throws std::runtime_error 旧进程不存在或交接失败
+     */
+    std::vector<ListenSocket> fetch();
+
+    /**
+     * @brief 新进程：通知旧进程已就绪，等待其确认开始排空
+     */
+    void notify_ready();
+
+    /**
+     * @brief 旧进程：在后台线程等待新进程接管
+     * @param listeners 返回当前进程的全部监听 socket
+     * @param on_handoff 新进程就绪后调用（停止 accept 并排空）
+     * @throws std::runtime_error 无法创建 Unix 域 socket
+     */
+    void serve(std::function<std::vector<ListenSocket>()> listeners, std::function<void()> on_handoff);
+
+    /**
+     * @brief 停止等待升级并删除 socket 文件（析构时自动调用）
+     */
+    void stop();
+
+private:
+    void serve_loop();
+
+    /**
+     * @brief 处理一次升级会话
+     * @return 是否已交接给新进程
+     */
+    bool handle_session(int conn_fd);
+
+    /**
+     * @brief 等待并接收一条消息，期间响应 stop()
+     * @return 接收的字节数，对端关闭返回 0，出错或停止返回 -1
+     */
+    ssize_t wait_message(int conn_fd, char* buffer, size_t len);
+
+    std::string _path;
+    int _client_fd;  // 新进程：与旧进程的连接，notify_ready() 后关闭
+    int _listen_fd;  // 旧进程：等待升级的 socket，交接后关闭
+
+    std::function<std::vector<ListenSocket>()> _listeners;
+    std::function<void()> _on_handoff;
+    std::thread _thread;
+    std::atomic<bool> _stop;
+};
+
+#endif // HOT_RESTART_H
@@ -0,0 +1,108 @@
+#ifndef HPACK_H
+#define HPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief HPACK（RFC 7541）头部压缩，HTTP/2 连接的两个方向各用一个实例
+ *
+ * 静态表 61 项，动态表按 RFC 的记账方式（每项 name + value + 32 字节）淘汰最旧的项；
+ * 字符串的 Huffman 编码表是规范 Huffman 码，只保存各符号的码长，码字在首次使用时生成。
+ */
+struct HpackHeader {
+    std::string name;   // 小写
+    std::string value;
+};
+
+/**
+ * @brief 动态表：新项插入表头，索引 62 起依次指向最新到最旧的项
+ */
+class HpackTable {
+public:
+    static constexpr size_t STATIC_SIZE = 61;
+    static constexpr size_t ENTRY_OVERHEAD = 32;
+
+    explicit HpackTable(size_t max_size) : _size(0), _max_size(max_size) {}
+
+    /**
+     * @brief 按索引查找（1 起，静态表在前），越界返回 nullptr
+     */
+    const HpackHeader* get(size_t index) const;
+
+    /**
+     * @brief 查找完全匹配的项（返回索引）或只有名称匹配的项（name_index），都没有时返回 0
+     */
+    size_t find(std::string_view name, std::string_view value, size_t& name_index) const;
+
+    void add(std::string_view name, std::string_view value);
+    void set_max_size(size_t max_size);
+    size_t max_size() const { return _max_size; }
+
+private:
+    void evict(size_t needed);
+
+    std::deque<HpackHeader> _entries;
+    size_t _size;      // 按 RFC 计算的表大小
+    size_t _max_size;
+};
+
+class HpackDecoder {
+public:
+    /**
+     * @param max_table_size 本端在 SETTINGS_HEADER_TABLE_SIZE 中公布的动态表上限
+     */
+    explicit HpackDecoder(size_t max_table_size = 4096);
+
+    /**
+     * @brief 解码一个完整的头部块（HEADERS + CONTINUATION 的负载拼接而成）
+     *
+     * 格式错误时返回 false（连接级的 COMPRESSION_ERROR，动态表已不可信）。
+     * 解码出的头部总大小（按 RFC 的记账方式）超过 max_list_size 时仍会解完整个块以保持
+     * 动态表同步，但返回的列表为空且 oversized 置为 true，由调用方回复 431。
+     */
+    bool decode(const uint8_t* data, size_t len, size_t max_list_size, std::vector<HpackHeader>& headers,
+                bool& oversized);
+
+private:
+    HpackTable _table;
+    size_t _settings_max;  // 表大小更新不能超过该值
+};
+
+class HpackEncoder {
+public:
+    HpackEncoder() : _table(4096), _pending_update(false) {}
+
+    /**
+     * @brief 对端 SETTINGS_HEADER_TABLE_SIZE 变化，下一个头部块开头发出表大小更新
+     */
+    void set_max_table_size(size_t max_size);
+
+    /**
+     * @brief 编码一个头部块；indexable 为 false 的头部（Content-Length 等每次都不同的值）
+     *        不进入动态表
+     */
+    void encode(const std::vector<HpackHeader>& headers, std::string& out);
+
+    static bool indexable(std::string_view name);
+
+private:
+    HpackTable _table;
+    bool _pending_update;
+};
+
+namespace hpack {
+
+// 整数编码（prefix_bits 位前缀，first_byte 提供前缀之外的高位标志）
+void encode_integer(uint64_t value, int prefix_bits, uint8_t first_byte, std::string& out);
+// Huffman 编码比原文短时使用 Huffman
+void encode_string(std::string_view text, std::string& out);
+bool huffman_decode(const uint8_t* data, size_t len, std::string& out);
+
+} // namespace hpack
+
+#endif // HPACK_H
@@ -0,0 +1,183 @@
+#ifndef HTTP2_SESSION_H
+#define HTTP2_SESSION_H
+
+#include "StreamHandler.h"
+#include "HttpParser.h"
+#include "Hpack.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Reactor;
+class HttpResponse;
+
+/**
+ * @brief HTTP/2 明文连接（h2c，RFC 9113）：接管连接后在一个连接上并发处理多个请求
+ *
+ * 入口有两种：客户端直接发送连接前言（prior knowledge，HttpParser 把前言的第一行解析为
+ * "PRI * HTTP/2.0" 请求），或者 HTTP/1.1 请求带 Upgrade: h2c，回复 101 后该请求作为流 1。
+ *
+ * 每个流的请求头和 body 转换为 HTTP/1.1 格式交给该流自己的 HttpParser，完整后经
+ * Reactor::dispatch_stream() 交给 Server 按原有路由处理；响应（包括线程池任务交还的响应
+ * 和 chunked 分块）经流句柄回到 on_response()，转换为 HEADERS 和 DATA 帧。
+ * 响应体按流量控制窗口切成 DATA 帧，在有数据的流之间轮流写出，先完成的任务先返回，
+ * 大图的响应不会阻塞同一连接上的其他流。发送队列中最多积压几帧，其余留在各流中等待调度。
+ * 对端不读取回复帧、队列积压过多时以 ENHANCE_YOUR_CALM 断开；被取消的流在任务结束前
+ * 仍计入并发上限。
+ *
+ * 尚未分发的请求 body 在一个连接上合计不超过 2 倍 max_body_size：带 Content-Length 的流
+ * 打开时按长度占用额度，不带的流按收到的字节占用，超出额度的流以 REFUSED_STREAM 拒绝；
+ * 连接级接收窗口只补到额度的剩余部分，流分发后额度和窗口才随之释放。
+ *
+ * 不支持服务端推送和优先级（PRIORITY 帧被忽略）。
+ * 所有状态只在 Reactor 线程中访问。
+ */
+class Http2Session : public StreamHandler, public std::enable_shared_from_this<Http2Session> {
+public:
+    struct Limits {
+        size_t max_header_size;          // 请求头列表上限，超出时回复 431（server.max_header_size）
+        size_t max_body_size;            // 单个请求 body 上限，超出时回复 413
+        uint32_t max_concurrent_streams; // http2.max_concurrent_streams
+        uint32_t initial_window_size;    // 每个流的接收窗口（http2.initial_window_size）
+    };
+
+    /**
+     * @param handle 连接句柄
+     * @param upgraded 通过 Upgrade: h2c 升级（需要接收完整的连接前言）；
+     *                 否则前言的第一行已被 HttpParser 消费
+     */
+    Http2Session(Reactor& reactor, uint64_t handle, const Limits& limits, bool upgraded);
+
+    /**
+     * @brief 解码升级请求的 HTTP2-Settings 头部（base64url 编码的 SETTINGS 负载）
+     * @return 格式错误时返回 false，调用方回复 400
+     */
+    static bool decode_upgrade_settings(std::string_view header, std::string& payload);
+
+    /**
+     * @brief 发送服务端前言并开始处理数据（attach_handler 之后、升级时在 101 之后调用）
+     * @param upgrade_settings 已解码的 HTTP2-Settings 负载
+     * @param upgrade_request 升级请求，作为流 1 处理（请求已由连接的解析器完整接收）
+     */
+    void start(const std::string& upgrade_settings = std::string(), HttpParser* upgrade_request = nullptr);
+
+    bool on_data(const char* data, size_t len) override;
+    void on_close() override;
+    void on_response(uint32_t token, HttpResponse&& response) override;
+    void on_abort(uint32_t token) override;
+    void on_writable() override;
+    bool idle() const override { return _streams.empty(); }
+    bool on_drain() override;
+
+    Http2Session(const Http2Session&) = delete;
+    Http2Session& operator=(const Http2Session&) = delete;
+
+private:
+    // 流上待发送的响应体片段，引用响应对象中的数据，不拷贝
+    struct Segment {
+        std::shared_ptr<const HttpResponse> owner;
+        std::string_view data;
+    };
+
+    struct Stream {
+        uint32_t id = 0;
+        uint32_t token = 0;            // 流句柄中的令牌
+        std::unique_ptr<HttpParser> parser;
+        bool request_complete = false; // 已收到 END_STREAM
+        bool dispatched = false;
+        bool body_known = false;       // 请求带 Content-Length，DATA 直接交给解析器
+        std::string request_head;      // 未带 Content-Length 时暂存的请求头
+        std::vector<char> body;        // 未带 Content-Length 时缓存 body，结束后补上长度
+        size_t body_reserved = 0;      // 占用的 body 额度（Content-Length 或已缓存的字节）
+        size_t body_received = 0;      // 已交给解析器或缓存的 body 字节
+        int64_t recv_window = 0;
+        int64_t send_window = 0;
+
+        bool headers_sent = false;
+        bool response_complete = false;  // 最后一段数据已交来
+        bool end_sent = false;           // 已发送 END_STREAM
+        bool scheduled = false;          // 在 _ready 中
+        std::deque<Segment> pending;
+    };
+
+    // 帧处理
+    void process_input(const char* data, size_t len);
+    bool process_frame(uint8_t type, uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len);
+    bool on_headers_frame(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len);
+    bool on_header_block(uint32_t stream_id, bool end_stream);
+    bool on_data_frame(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len);
+    bool on_settings(uint8_t flags, const uint8_t* payload, size_t len);
+    bool apply_settings(const uint8_t* payload, size_t len);
+    bool on_window_update(uint32_t stream_id, const uint8_t* payload, size_t len);
+    bool on_rst_stream(uint32_t stream_id, size_t len);
+
+    // 请求
+    Stream* open_stream(uint32_t stream_id);
+    bool build_request(Stream& stream, const std::vector<HpackHeader>& headers, bool end_stream);
+    void feed_body(Stream& stream, const char* data, size_t len);
+    void finish_request(Stream& stream);
+    void dispatch(Stream& stream, HttpParser& parser);
+    void respond_error(Stream& stream, int status);
+    void release_body(Stream& stream);
+    int64_t conn_window_limit() const;
+    void replenish(Stream* stream);
+
+    // 响应
+    void handle_response(Stream& stream, HttpResponse response);
+    void send_headers(Stream& stream, const HttpResponse& response, bool end_stream);
+    void schedule(Stream& stream);
+    void pump();
+    void finish_stream(Stream& stream);
+    void reset_stream(uint32_t stream_id, uint32_t error);
+    void close_stream(uint32_t stream_id);
+
+    // 连接
+    void send_frame(uint8_t type, uint8_t flags, uint32_t stream_id, std::string_view payload, bool keep_alive = true);
+    bool connection_error(uint32_t error);
+    void go_away(uint32_t error, bool close_after);
+
+    Reactor& _reactor;
+    uint64_t _handle;
+    int _fd;
+    Limits _limits;
+
+    std::string _buffer;          // 未凑成完整帧的数据
+    size_t _preface_remaining;    // 连接前言中尚未收到的字节数
+    bool _settings_received;      // 前言之后的第一帧必须是 SETTINGS
+    bool _started;                // start() 之前收到的数据只缓存
+
+    HpackDecoder _decoder;
+    HpackEncoder _encoder;
+    std::string _header_block;    // HEADERS + CONTINUATION 拼接中的头部块
+    uint32_t _continuation_stream;  // 正在接收 CONTINUATION 的流，0 表示没有
+    bool _header_block_end_stream;
+
+    std::unordered_map<uint32_t, std::unique_ptr<Stream>> _streams;
+    std::unordered_map<uint32_t, uint32_t> _tokens;  // 流令牌 -> 流 ID
+    std::unordered_set<uint32_t> _cancelled;         // 已关闭但任务仍在执行的流令牌，计入并发数
+    uint32_t _last_stream_id;     // 已接受的最大流 ID
+
+    // 对端的设置
+    uint32_t _peer_initial_window;
+    uint32_t _peer_max_frame_size;
+
+    int64_t _conn_send_window;
+    int64_t _conn_recv_window;
+    int64_t _conn_window_target;  // 连接级接收窗口，消耗过半时补回
+
+    size_t _body_budget;          // 未分发的请求 body 合计上限
+    size_t _body_reserved;        // 各流占用的额度之和
+    size_t _body_buffered;        // 各流实际持有的 body 字节之和
+
+    std::deque<uint32_t> _ready;  // 有数据待发送的流，轮流写出
+    bool _pumping;
+    bool _going_away;             // 已发送 GOAWAY，不再接受新流
+    bool _closed;
+};
+
+#endif // HTTP2_SESSION_H
@@ -2,8 +2,12 @@
 #define HTTP_PARSER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include <utility>
+#include "MultipartParser.h"
+#include "HttpScanner.h"
+#include "Common.h"
 
 enum class ParseState {
     METHOD,
@@ -11,7 +15,8 @@ enum class ParseState {
     VERSION,
     HEADERS,
     BODY,
-    COMPLETE
+    COMPLETE,
+    ERROR     // 请求格式错误或超出限制，error_status() 给出应回复的状态码，连接应关闭
 };
 
 class HttpParser {
@@ -19,36 +24,94 @@ public:
     HttpParser();
 
     void parse(const char* data, size_t len);
-    void reset(); // 添加重置方法
+
+    /**
+     * @brief 设置请求头和 body 的大小上限
+     *
+     * 请求头超过 max_header_size 时回复 431；Content-Length 超过 max_body_size 时
+     * 在头部解析完成后立即回复 413，不再接收 body。
+     */
+    void set_limits(size_t max_header_size, size_t max_body_size);
+
+    // 头部解析完成后，body 中尚未填充的区域；Reactor 可用 readv 直接读入，省去一次拷贝
+    // 区域大小有上限（随已收数据增长，最多 1MB），写满后再次调用得到下一段；不在接收 body 时返回 {nullptr, 0}
+    std::pair<char*, size_t> body_window();
+    // 记录通过 body_window() 直接写入的字节数
+    void commit_body(size_t len);
+    // 重置为下一个请求复用；若已缓存流水线数据，会立即继续解析
+    void reset();
+    // 连接关闭时调用：丢弃流水线数据，并释放过大的缓冲区
+    void clear();
 
     bool is_request_ready() const;
-    std::string get_method() const;
-    std::string get_path() const;
-    std::vector<char> get_image_data() const;
-    std::string get_filter_type() const;
-    std::string get_image_uuid() const;
-    std::string get_blur_intensity() const;
-    std::string get_sharpen_intensity() const;
+    bool is_receiving_body() const { return _state == ParseState::BODY; }
+    bool has_partial_headers() const { return _state < ParseState::BODY && !_buffer.empty(); }
+    bool has_error() const { return _state == ParseState::ERROR; }
+    int error_status() const { return _error_status; }
+    // 客户端发送了 Expect: 100-continue 并在等待 100 响应，每个请求只返回一次 true
+    bool take_expect_continue();
+    size_t body_received() const { return _body_received; }
+    size_t content_length() const { return _content_length; }
+    bool keep_alive() const; // 是否保持连接 (HTTP/1.1 默认保持，除非 Connection: close)
+    // 请求带 Transfer-Encoding（不带 Content-Length）：头部之后的数据都留在流水线缓存中，
+    // body 边界未知，只有接管连接的处理器（推流）可以使用，其他请求应拒绝并关闭连接
+    bool has_transfer_encoding() const { return _transfer_encoded; }
+
+    // 以下视图指向解析器内部的数据，在 reset()/clear() 之前有效；需要保留时由调用方拷贝
+    std::string_view get_method() const { return _head.method; }
+    std::string_view get_path() const { return _head.path; }  // 包含查询字符串
+    std::string_view get_query() const;                          // 路径中 '?' 之后的部分，没有时为空
+    std::string_view get_version() const { return _head.version; }
+    std::string_view get_header(std::string_view name) const { return _head.find(name); } // 不存在时返回空视图
+    std::string_view get_header(HeaderId id) const { return _head.header(id); }
+    ImageServerDEF::ByteView get_image_data() const;        // image 字段不完整时为空
+    // 移出图片数据（不拷贝），之后 get_image_data() 为空
+    std::vector<char> take_image();
+    // 移出全部文件 part（批量接口），按出现顺序
+    std::vector<MultipartParser::FilePart> take_files() { return _multipart.take_files(); }
+    // multipart body 格式错误，解析器已放弃后续数据
+    bool multipart_failed() const { return !_boundary.empty() && _multipart.failed(); }
+    bool is_multipart() const { return !_boundary.empty(); }
+    std::string_view get_boundary() const { return _boundary; }
+    // WebSocket 握手：GET + Upgrade: websocket + Connection 含 upgrade + Sec-WebSocket-Key（不检查版本）
+    bool is_websocket_upgrade() const;
+    // 取出当前请求之后已收到的数据（连接被接管时交给处理器）
+    std::string take_pipelined();
+    // 非 multipart 请求的原始 body，请求完整之前为空
+    ImageServerDEF::ByteView get_body() const;
+    // 移出原始 body（不拷贝），Reactor 通过 body_window() 读入的数据原样交给调用方
+    std::vector<char> take_body();
+    std::string_view get_filter_type() const { return _multipart.field("filter"); }
+    std::string_view get_image_uuid() const { return _multipart.field("uuid"); }
+    std::string_view get_blur_intensity() const { return _multipart.field("blur_intensity"); }
+    std::string_view get_sharpen_intensity() const { return _multipart.field("sharpen_intensity"); }
 
 private:
-    void parse_headers();
-    void parse_multipart_body();
+    bool parse_headers(size_t head_len);
+    void append_body(const char* data, size_t len);
+    void grow_body(size_t min_size);
+    void check_body_complete();
+    void fail(int status);
 
     ParseState _state;
-    std::string _buffer;
-    std::string _method;
-    std::string _path;
-    std::unordered_map<std::string, std::string> _headers;
-    std::vector<char> _body;
+    std::string _buffer;   // 请求头部；解析后保留到 reset()，_head 中的视图指向这里
+    RequestHead _head;
+    std::vector<char> _body;   // 非 multipart 的 body，按 Content-Length 预留容量、分段初始化，_body_received 之前为有效数据
+    size_t _body_received;
     size_t _content_length;
 
-    // 用于 multipart/form-data
+    size_t _max_header_size;
+    size_t _max_body_size;
+    int _error_status;
+    bool _expect_continue;
+    bool _transfer_encoded;
+
+    // 当前请求之后收到的数据（流水线中的下一个请求），reset() 时重新解析
+    std::string _pipelined;
+
+    // 用于 multipart/form-data：body 边接收边解析，不经过 _body
     std::string _boundary;
-    std::vector<char> _image_data;
-    std::string _filter_type;
-    std::string _image_uuid;
-    std::string _blur_intensity;
-    std::string _sharpen_intensity;
+    MultipartParser _multipart;
 };
 
 #endif // HTTP_PARSER_H
@@ -0,0 +1,140 @@
+#ifndef HTTP_RESPONSE_H
+#define HTTP_RESPONSE_H
+
+#include <sys/uio.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+/**
+ * @brief HTTP 响应（响应头 + 响应体）
+ *
+ * 响应头由预先格式化的片段拼接到对象内部的定长缓冲区中，构造状态行和
+ * 常用头部不产生堆分配；响应体可以接管 std::vector<char>，也可以引用
+ * 外部共享的只读数据。发送时头部和响应体作为 iovec 通过一次 sendmsg
+ * 写出，部分写入由 consume() 记录偏移。
+ */
+class HttpResponse {
+public:
+    static constexpr size_t HEADER_CAPACITY = 1024;
+
+    /**
+     * @param status HTTP 状态码（200, 404, 500 ...）
+     * @param keep_alive 响应发送后是否保持连接
+     */
+    HttpResponse(int status, bool keep_alive);
+
+    // 响应体可能指向自身持有的缓冲区，只允许移动
+    HttpResponse(HttpResponse&&) = default;
+    HttpResponse& operator=(HttpResponse&&) = default;
+    HttpResponse(const HttpResponse&) = delete;
+    HttpResponse& operator=(const HttpResponse&) = delete;
+
+    /**
+     * @brief 设置 Content-Type 头
+     */
+    HttpResponse& set_content_type(std::string_view content_type);
+
+    /**
+     * @brief 追加一个响应头（name: value）
+     */
+    HttpResponse& add_header(std::string_view name, std::string_view value);
+
+    /**
+     * @brief 接管响应体数据（不拷贝）
+     */
+    HttpResponse& set_body(std::vector<char> body);
+
+    /**
+     * @brief 拷贝一段文本作为响应体（用于短小的错误信息）
+     */
+    HttpResponse& set_body(std::string_view text);
+
+    /**
+     * @brief 引用外部只读数据作为响应体，owner 保证数据在发送完成前有效
+     */
+    HttpResponse& set_body_view(const char* data, size_t len, std::shared_ptr<const void> owner = nullptr);
+
+    /**
+     * @brief 修改响应发送后是否保持连接（finish() 之前有效）
+     */
+    HttpResponse& set_keep_alive(bool keep_alive);
+
+    /**
+     * @brief 使用 Transfer-Encoding: chunked 流式发送，本对象只作为响应头，
+     *        响应体由随后的 chunk() 和 last_chunk() 依次交给连接
+     */
+    HttpResponse& set_chunked();
+
+    /**
+     * @brief 流式响应的一个分块（长度行 + 数据 + CRLF），接管数据不拷贝
+     */
+    static HttpResponse chunk(std::vector<char> data);
+
+    /**
+     * @brief 流式响应的结束分块，发送完毕后按 keep_alive 结束请求
+     */
+    static HttpResponse last_chunk(bool keep_alive);
+
+    /**
+     * @brief 协议切换后（WebSocket 等）的原始数据：head 拷贝到头部缓冲区，data 接管不拷贝
+     * @param keep_alive 为 false 时发送完毕后关闭连接
+     */
+    static HttpResponse raw(std::string_view head, std::vector<char> data, bool keep_alive);
+
+    /**
+     * @brief 写入 Content-Length、Connection 和头部结束标记，之后不可再修改
+     */
+    void finish();
+
+    /**
+     * @brief 将尚未发送的部分填入 iovec 数组
+     * @return 使用的 iovec 个数
+     */
+    int fill_iovec(struct iovec* iov, int max_iov) const;
+
+    /**
+     * @brief 记录已发送的字节数
+     * @return 已发送字节中属于本响应的字节数（其余属于队列中的下一个响应）
+     */
+    size_t consume(size_t bytes);
+
+    bool done() const { return _sent == total_size(); }
+    bool keep_alive() const { return _keep_alive; }
+    bool starts_stream() const { return _chunked; }
+    bool ends_stream() const { return _last_chunk; }
+    int status() const { return _status; }
+    size_t total_size() const { return _header_len + _body_len + _trailer.size(); }
+    std::string_view header() const { return std::string_view(_header, _header_len); }
+    std::string_view body() const { return std::string_view(_body_data, _body_len); }
+    // 分块中的数据（不含长度行和结尾的 CRLF），转换为 HTTP/2 的 DATA 帧时使用
+    std::string_view chunk_data() const { return body(); }
+
+private:
+    // 分块和原始数据没有状态行
+    struct ChunkTag {};
+    HttpResponse(ChunkTag, bool keep_alive);
+
+    void append(std::string_view text);
+
+    int _status;
+    bool _keep_alive;
+    bool _finished;
+    bool _chunked;     // 流式响应的响应头
+    bool _last_chunk;  // 流式响应的结束分块
+
+    char _header[HEADER_CAPACITY];
+    size_t _header_len;
+
+    std::vector<char> _body;
+    const char* _body_data;
+    size_t _body_len;
+    std::shared_ptr<const void> _body_owner;
+    std::string_view _trailer;  // 响应体之后的静态数据（分块结尾的 CRLF）
+
+    size_t _sent;  // 已发送的字节数（头部 + 响应体）
+};
+
+#endif // HTTP_RESPONSE_H
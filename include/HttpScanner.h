@@ -0,0 +1,75 @@
+#ifndef HTTP_SCANNER_H
+#define HTTP_SCANNER_H
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+// 需要快速访问的请求头，解析时直接放入固定槽位
+enum class HeaderId {
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    CONNECTION,
+    EXPECT,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    IF_NONE_MATCH,
+    COUNT  // 槽位数；lookup() 对其他头部返回 COUNT
+};
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * @brief 解析后的请求行和请求头，全部是指向原始数据的视图
+ *
+ * 原始数据在下一次 clear() 之前必须保持有效；headers 的容量在连接复用时保留，
+ * 解析一个请求不产生堆分配。
+ */
+struct RequestHead {
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::array<std::string_view, static_cast<size_t>(HeaderId::COUNT)> known;  // 不存在时 data() 为 nullptr
+    std::vector<HttpHeader> headers;  // 全部请求头（包括已知头部），按出现顺序
+
+    void clear();
+    std::string_view header(HeaderId id) const { return known[static_cast<size_t>(id)]; }
+    // 大小写不敏感查找，不存在时返回空视图
+    std::string_view find(std::string_view name) const;
+};
+
+/**
+ * @brief 请求行和请求头的向量化扫描器（思路同 picohttpparser）
+ *
+ * 每个字段的结束位置通过"查找第一个落入给定字节区间的字节"得到：
+ * SSE4.2 用 pcmpestri 一次比较 16 字节，AVX2 用无符号 min/max 比较 32 字节，
+ * 其他 CPU 和末尾不足一个向量的部分逐字节比较。启动时按 CPU 特性选择实现。
+ */
+class HttpScanner {
+public:
+    enum class Backend { SCALAR, SSE42, AVX2 };
+
+    /**
+     * @brief 解析完整的请求头部
+     * @param data 请求头部，以 "\r\n\r\n" 结尾
+     * @param len 头部长度（包括结尾的空行）
+     * @return 请求行或某个请求头格式错误时返回 false
+     */
+    static bool parse(const char* data, size_t len, RequestHead& head);
+
+    // 头部名称对应的槽位（大小写不敏感），不是已知头部时返回 HeaderId::COUNT
+    static HeaderId lookup(std::string_view name);
+
+    static bool equals_ci(std::string_view a, std::string_view b);
+    static bool contains_ci(std::string_view text, std::string_view token);
+
+    static Backend backend();
+    static const char* backend_name(Backend backend);
+    // 切换实现（用于测试和基准测试），CPU 不支持时返回 false；不可与 parse() 并发调用
+    static bool select_backend(Backend backend);
+};
+
+#endif // HTTP_SCANNER_H
@@ -3,17 +3,62 @@
 
 #include <vector>
 #include <string>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <opencv2/opencv.hpp>
 #include "YOLOv8Detector.h"
+#include "Common.h"
 
 class ImageProcessor {
 public:
-    static bool process(const std::vector<char>& input_data,
+    // input_data 只在调用期间使用，可以直接指向上传缓冲区
+    static bool process(ImageServerDEF::ByteView input_data,
                        std::vector<char>& output_data,
                        const std::string& filter_type,
                        std::string& output_content_type,
                        const std::string& blur_intensity = "",
                        const std::string& sharpen_intensity = "");
+
+    // 解码并应用滤镜（包括 YOLO），得到待编码的图像及其 Content-Type，供流式编码使用
+    static bool render(ImageServerDEF::ByteView input_data,
+                       cv::Mat& output_image,
+                       const std::string& filter_type,
+                       std::string& output_content_type,
+                       const std::string& blur_intensity = "",
+                       const std::string& sharpen_intensity = "");
+
+    // 批量 YOLO（yolo_detect / yolo_segment / yolo_segment_with_boxes）：全部解码后合成一次推理，
+    // 再分别绘制结果。输出为 JPEG；解码失败或模型加载失败的图像，outputs 中对应项为空
+    static void renderYOLOBatch(const std::vector<ImageServerDEF::ByteView>& inputs,
+                                const std::string& filter_type,
+                                std::vector<cv::Mat>& outputs);
+
+    // 只推理、不绘制也不编码（/detect、/segment 返回 JSON）；image_size 为解码后的原图尺寸
+    static bool detectImage(ImageServerDEF::ByteView input_data, cv::Size& image_size,
+                            std::vector<YOLODetection>& detections);
+    static bool segmentImage(ImageServerDEF::ByteView input_data, cv::Size& image_size,
+                             std::vector<YOLOSegmentation>& segmentations);
+
+    // 解码图像：矩阵头直接指向输入缓冲区，不拷贝
+    static bool decode(ImageServerDEF::ByteView input_data, cv::Mat& image);
+
+    // 对已解码的视频帧做目标检测（推流接口逐帧调用，不输出日志）；模型加载失败时返回 false
+    static bool detectFrame(const cv::Mat& image, std::vector<YOLODetection>& detections);
+
+    // 是否是需要 YOLO 模型推理的滤镜
+    static bool isYOLOFilter(const std::string& filter_type);
+
+    // 按 Content-Type 整体编码（image/png 或 image/jpeg）
+    static bool encode(const cv::Mat& image, const std::string& content_type, std::vector<char>& output_data);
+
+    // 边编码边输出：每攒够 chunk_size 字节交给 sink 一次，最后一块可能更小。
+    // JPEG 在编译时找到 libjpeg 时按行编码，其他情况整体编码后切分
+    static bool encodeChunked(const cv::Mat& image,
+                              const std::string& content_type,
+                              size_t chunk_size,
+                              const std::function<void(std::vector<char>)>& sink);
     
     // YOLOv8目标检测相关方法（使用YOLOv8Detector）
     static bool loadYOLOModel(const std::string& model_path, const std::string& config_path = "");
@@ -33,10 +78,19 @@ public:
                                                     std::vector<char>& output_data,
                                                     std::string& output_content_type);
     
-    // 获取检测器实例（延迟初始化）
+    // 获取检测器实例（延迟初始化）：目标检测模型和分割模型各有一个
     static YOLOv8Detector* getDetector();
+    static YOLOv8Detector* getSegmentationDetector();
+
+    // 启动时加载配置的检测和分割模型，各用空白图像推理一次，避免首个请求承担加载和初始化的延迟
+    static bool warmup();
 
 private:
+    // 指定模型文件的检测器（延迟创建，不加载模型）
+    static YOLOv8Detector* detectorFor(const std::string& model_path);
+    // 该模型文件的检测器未加载模型时加载
+    static bool ensureModelLoaded(const std::string& model_path);
+
     // OpenCV滤镜效果方法
     static cv::Mat applySepiaFilter(const cv::Mat& image);
     static cv::Mat applyEmbossFilter(const cv::Mat& image);
@@ -45,7 +99,9 @@ private:
     static cv::Mat applyOilPaintingFilter(const cv::Mat& image);
 
 private:
-    static YOLOv8Detector* yolo_detector;
+    static std::unordered_map<std::string, std::unique_ptr<YOLOv8Detector>> yolo_detectors;  // 模型路径 -> 检测器
+    static std::mutex detectors_mutex;  // 保护 yolo_detectors
+    static std::mutex load_mutex;       // 串行化模型加载
 };
 
 #endif // IMAGE_PROCESSOR_H
@@ -0,0 +1,100 @@
+#ifndef MJPEG_STREAM_H
+#define MJPEG_STREAM_H
+
+#include "StreamHandler.h"
+#include "ChunkedDecoder.h"
+#include "MultipartParser.h"
+#include "AdmissionController.h"
+#include "YOLOv8Detector.h"
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Reactor;
+class ThreadPool;
+class HttpResponse;
+
+/**
+ * @brief 推流接口（POST /stream）：一个连接上持续收到 multipart JPEG 帧，
+ *        逐帧做目标检测，标注后的帧以 multipart/x-mixed-replace 返回
+ *
+ * 每帧依次经过解码、检测、绘制并编码三个阶段，每个阶段同一时间只有一个线程池任务，
+ * 不同帧在各阶段间交叠执行（第 N 帧检测时第 N+1 帧已在解码）。阶段之间只有一个槽位：
+ * 下游还没取走上一帧时新帧直接替换它，发送时连接上还有未发完的帧也丢弃新帧，
+ * 处理或网络跟不上时丢帧而不是排队，延迟不会随时间累积。
+ *
+ * 接管连接后 on_data()/on_close() 在 Reactor 线程中调用，阶段任务持有 shared_ptr，
+ * 连接关闭后各阶段取完手上的帧即停止。
+ */
+class MjpegStream : public StreamHandler, public std::enable_shared_from_this<MjpegStream> {
+public:
+    /**
+     * @param handle 连接句柄
+     * @param boundary 请求的 multipart boundary
+     * @param chunked_input 请求体是否为 chunked 编码（否则读到结束分隔符或连接关闭为止）
+     * @param max_frame_size 单帧 JPEG 的大小上限，超过时视为格式错误
+     * @param ticket 推流期间一直占用的准入名额
+     */
+    MjpegStream(Reactor& reactor, uint64_t handle, ThreadPool& pool, const std::string& boundary,
+                bool chunked_input, size_t max_frame_size, AdmissionController::Ticket ticket);
+
+    // chunked 响应头，接管连接之前由 Server 发送
+    HttpResponse response_head() const;
+
+    bool on_data(const char* data, size_t len) override;
+    void on_close() override;
+
+    MjpegStream(const MjpegStream&) = delete;
+    MjpegStream& operator=(const MjpegStream&) = delete;
+
+private:
+    enum Stage { DECODE, DETECT, ENCODE, STAGE_COUNT };
+
+    struct Frame {
+        std::vector<char> jpeg;  // 收到的帧；编码阶段复用其缓冲区输出
+        cv::Mat image;
+        std::vector<YOLODetection> detections;
+    };
+
+    void feed(const char* data, size_t len);
+    void end_of_input();
+    void push(int stage, Frame frame);
+    void run(int stage);
+    bool process(int stage, Frame& frame);
+    void finish_if_idle();
+
+    // 以下在 Reactor 线程中执行
+    void send_frame(std::vector<char> jpeg);
+    void send_end();
+
+    Reactor& _reactor;
+    uint64_t _handle;
+    ThreadPool& _pool;
+    AdmissionController::Ticket _ticket;
+
+    // 输入解析（Reactor 线程）
+    bool _chunked_input;
+    ChunkedDecoder _dechunk;
+    MultipartParser _frames;
+
+    std::string _boundary;  // 响应的 boundary
+    bool _first_part;       // 第一个分隔符前面没有 "\r\n"（Reactor 线程）
+
+    std::mutex _mutex;  // 保护以下状态
+    std::array<std::optional<Frame>, STAGE_COUNT> _slots;  // 各阶段等待处理的帧
+    std::array<bool, STAGE_COUNT> _running;  // 各阶段是否有任务在执行
+    bool _input_done;  // 输入已结束，处理完剩余帧后发送结束分隔符
+    bool _ended;       // 已安排发送结束分隔符
+    bool _closed;      // 连接已关闭
+
+    std::atomic<uint64_t> _received;
+    std::atomic<uint64_t> _sent;
+    std::atomic<uint64_t> _dropped;
+};
+
+#endif // MJPEG_STREAM_H
@@ -0,0 +1,125 @@
+#ifndef MULTIPART_PARSER_H
+#define MULTIPART_PARSER_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+/**
+ * @brief 增量 multipart/form-data 解析器
+ *
+ * 数据到达时即查找分隔符（"\r\n--" + boundary），不需要先缓存整个 body；
+ * 查找使用 Boyer-Moore-Horspool，跳转表在 reset() 时按 boundary 预先计算。
+ *
+ * 每个 part 的数据直接写入该 part 的缓冲区：image 字段和其他文件字段（带 filename）
+ * 各写入一个图片缓冲区，解析完成后由 take_image() / take_files() 移出；
+ * 其他文本字段写入各自的字符串；前导和结尾只保留可能属于分隔符的末尾几个字节。
+ * Reactor 通过 window()/commit() 可把 socket 数据直接读入图片缓冲区；缓冲区随该 part
+ * 自身的数据翻倍增长（不超过剩余 body），完成后收缩掉大块的空闲容量。
+ */
+class MultipartParser {
+public:
+    // 一个完整接收的文件 part
+    struct FilePart {
+        std::string name;        // Content-Disposition 的 name 参数
+        std::string header;      // part 头部原文
+        std::vector<char> data;
+
+        // part 头部中的字段值（大小写不敏感），不存在时返回空视图
+        std::string_view header_value(std::string_view field) const;
+    };
+
+    MultipartParser();
+
+    /**
+     * @brief 开始解析新的 body
+     * @param boundary Content-Type 中的 boundary 参数（不含前导 "--"）
+     * @param content_length body 总长度，图片缓冲区最多按此分配；单个文件超过该长度时视为格式错误
+     * @param every_part_is_file 每个 part 都按文件接收（MJPEG 推流的 part 没有 Content-Disposition）
+     */
+    void reset(const std::string& boundary, size_t content_length, bool every_part_is_file = false);
+
+    // 丢弃解析状态和字段（保留缓冲区供下一个请求复用）
+    void clear();
+    // 连接关闭时调用：释放过大的缓冲区
+    void release();
+
+    // 处理一段 body 数据
+    void feed(const char* data, size_t len);
+
+    /**
+     * @brief 可直接写入的区域，最多 max_len 字节
+     *
+     * 文件 part 收到 64KB 之后是其缓冲区的尾部（随已收数据翻倍，最多 1MB）；
+     * 其他情况是一块小的暂存区，写入后由 commit() 按普通数据解析。
+     */
+    std::pair<char*, size_t> window(size_t max_len);
+    // 记录直接写入 window() 的字节数
+    void commit(size_t len);
+
+    bool complete() const { return _state == State::DONE; }
+    bool failed() const { return _state == State::ERROR; }
+
+    // image 字段已完整接收
+    bool image_complete() const { return find_image() != nullptr; }
+    // 第一个 image 字段的数据，不完整时为空
+    const std::vector<char>& image() const;
+    // 移出第一个 image 字段的缓冲区（不拷贝），image 字段不完整时返回空
+    std::vector<char> take_image();
+    // 移出全部已完整接收的文件 part（按出现顺序，包括 image 字段）
+    std::vector<FilePart> take_files();
+    // 文本字段，不存在时返回空字符串
+    const std::string& field(const std::string& name) const;
+
+private:
+    enum class State {
+        PREAMBLE,          // 第一个分隔符之前
+        DELIMITER_SUFFIX,  // 分隔符之后："\r\n" 开始下一个 part，"--" 表示结束
+        PART_HEADER,       // part 头部，直到空行
+        PART_DATA,         // part 数据，直到下一个分隔符
+        DONE,              // 结束分隔符之后（忽略剩余数据）
+        ERROR
+    };
+
+    // 当前数据写入的缓冲区
+    enum class Sink { DISCARD, IMAGE, FIELD };
+
+    void parse(const char* data, size_t len);
+    size_t find_delimiter(const char* data, size_t len) const;
+    char* reserve(size_t len);
+    void scan(std::string& leftover);
+    // unparsed: 本次收到的数据中，part 头部之后还没解析的字节数
+    void start_part(size_t unparsed);
+    void finish_part(size_t len);
+    std::vector<char>& sink_buffer();
+    const FilePart* find_image() const;
+
+    State _state;
+    std::string _delimiter;              // "\r\n--" + boundary
+    std::array<size_t, 256> _skip;       // BMH 跳转表
+    size_t _content_length;
+    bool _every_part_is_file;
+    size_t _received;  // 已交给解析器的 body 字节数
+
+    Sink _sink;
+    size_t _sink_len;   // 当前缓冲区中的有效字节（缓冲区大小可能更大）
+    size_t _scan_from;  // 下一次从这里开始查找分隔符
+    size_t _image_limit;  // 当前文件 part 的容量上限
+
+    std::vector<char> _image;    // 正在接收的文件 part，唯一一份
+    std::vector<FilePart> _files;  // 已完整接收的文件 part
+    std::vector<char> _text;     // 正在接收的文本字段
+    std::vector<char> _discard;  // 被丢弃的数据，只保留可能的分隔符前缀
+    std::vector<char> _scratch;  // window() 在非图片阶段返回的暂存区
+    bool _window_is_scratch;
+
+    std::string _suffix;       // 分隔符之后已收到的字符
+    std::string _part_header;  // 当前 part 的头部
+    std::string _part_name;    // 当前 part 的字段名
+    std::unordered_map<std::string, std::string> _fields;
+};
+
+#endif // MULTIPART_PARSER_H
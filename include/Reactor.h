@@ -0,0 +1,289 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <sys/uio.h>
+#include "ConnectionTable.h"
+#include "TimerWheel.h"
+
+class Server;
+class HttpResponse;
+class HttpParser;
+
+// 监听 socket 及其端口，热重启时在新旧进程之间传递
+struct ListenSocket {
+    int port;                  // Unix 域 socket 为 0
+    int fd;
+    std::string unix_address;  // Unix 域 socket 的监听地址（unix:/path 或 unix:@name），TCP 为空
+};
+
+/**
+ * @brief 事件循环（Reactor）的公共部分
+ *
+ * 每个 Reactor 运行在独立线程中，拥有自己的 SO_REUSEPORT 监听 socket（每个端口一个）、
+ * 连接表、超时时间轮和跨线程任务队列，由内核在多个 Reactor 之间分发新连接。
+ *
+ * 请求解析与分发、响应队列的记账、超时策略等与 I/O 方式无关的逻辑在这里实现；
+ * 具体的 I/O 后端（EpollReactor / UringReactor）只负责接受连接、读取数据和发送响应队列。
+ * Server 和线程池任务只通过本类的接口与连接交互。
+ */
+class Reactor {
+public:
+    /**
+     * @param inherited 从旧进程接管的监听 socket（热重启），其余端口自行创建
+     */
+    Reactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+            const std::vector<ListenSocket>& inherited = {});
+    virtual ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * @brief 运行事件循环（阻塞），排空完成后返回
+     */
+    virtual void run() = 0;
+
+    /**
+     * @brief 后端名称，用于日志
+     */
+    virtual const char* backend_name() const = 0;
+
+    /**
+     * @brief 关闭连接并从本 Reactor 中移除
+     * @param fd 客户端文件描述符
+     */
+    virtual void close_connection(int fd) = 0;
+
+    /**
+     * @brief 当前请求的响应已发送完毕（Reactor 线程调用）
+     *
+     * keep_alive 为 true 时复用连接的解析器继续处理流水线请求，否则关闭连接。
+     * @param fd 客户端文件描述符
+     * @param keep_alive 是否保持连接
+     */
+    void complete_request(int fd, bool keep_alive);
+
+    /**
+     * @brief 完成请求并继续读取该连接（用于线程池任务完成后的回调）
+     * @param handle 连接句柄，连接已关闭或 fd 已被复用时忽略
+     */
+    void resume_connection(uint64_t handle, bool keep_alive);
+
+    /**
+     * @brief 将响应放入连接的发送队列并尽量立即发送（Reactor 线程调用）
+     *
+     * 头部和响应体合并为一次写出；未能立即写完的数据留在队列中由后端继续发送，
+     * 全部发送完毕后按响应的 keep_alive 结束请求。chunked 响应头之后的分块
+     * 同样经由这里入队，直到结束分块发送完毕才结束请求。
+     * @param fd 客户端文件描述符
+     * @param response 待发送的响应
+     */
+    void send_response(int fd, HttpResponse response);
+
+    /**
+     * @brief 线程安全版本的 send_response，供线程池任务交还响应
+     * @param handle 连接句柄，连接已关闭或 fd 已被复用时丢弃响应
+     */
+    void post_response(uint64_t handle, HttpResponse response);
+
+    /**
+     * @brief 由处理器接管连接（Reactor 线程调用，通常在 Server::handle_request 中）
+     *
+     * 当前请求视为已完成，之后收到的数据（包括已缓存的部分）都交给处理器，
+     * 响应头（101、流式响应头等）须在接管之后发送，否则会被当作请求的完成。
+     * 连接超过 keep-alive 超时没有收到数据时关闭。发送队列积压时暂停读取，
+     * 对端不读取回复（PONG、ACK 等）就不会继续收到它的数据。处理器发出的响应带
+     * Connection: close 时，发送完毕后关闭连接。
+     * @param fd 客户端文件描述符
+     * @param handler 处理器，连接关闭时收到 on_close()
+     */
+    void attach_handler(int fd, std::shared_ptr<StreamHandler> handler);
+
+    /**
+     * @brief 把多路复用连接（HTTP/2）上一个流的请求交给 Server 处理（Reactor 线程调用）
+     *
+     * 处理期间 handle_of() 返回流句柄，发往该连接的响应（同步的 send_response()
+     * 和之后经流句柄投递的响应）都交给连接处理器的 on_response()。
+     * @param stream_handle ConnectionTable::make_stream_handle() 生成的流句柄
+     * @param parser 已完成解析的请求（由处理器按 HTTP/1.1 格式构造）
+     */
+    void dispatch_stream(uint64_t stream_handle, HttpParser& parser);
+
+    /**
+     * @brief 分配流令牌（Reactor 线程调用），本 Reactor 内递增，不为 0
+     */
+    uint32_t next_stream_token();
+
+    /**
+     * @brief 连接发送队列中尚未发完的响应数（Reactor 线程调用），用于实时流的丢帧判断
+     * @param handle 连接句柄（或流句柄，返回所在连接的值），连接已关闭或 fd 已被复用时返回 SIZE_MAX
+     */
+    size_t queued_responses(uint64_t handle) const;
+
+    /**
+     * @brief 获取连接当前的句柄（Reactor 线程调用），用于跨线程回调
+     */
+    uint64_t handle_of(int fd) const;
+
+    /**
+     * @brief 投递任务到本 Reactor 线程执行（线程安全，可在线程池中调用）
+     * @param task 在 Reactor 线程中执行的回调
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief 开始排空（Reactor 线程调用，热重启交接后由 Server 投递）
+     *
+     * 停止接受新连接并关闭空闲连接；此后的响应都带 Connection: close，
+     * 最后一个连接关闭后 run() 返回。
+     */
+    void begin_drain();
+
+    /**
+     * @brief 对构造时新建的 TCP socket 调用 listen()（在 run() 之前调用，可重复调用）
+     *
+     * 构造时只绑定不监听：SO_REUSEPORT 组中的 socket 一旦开始监听就会分到新连接，
+     * 热重启时新进程要等预热完成、准备好 accept 之后才加入，此前连接全部由旧进程处理。
+     */
+    void start_listening();
+
+    /**
+     * @brief 本 Reactor 的监听 socket，构造后到排空前不变，可在其他线程读取
+     */
+    const std::vector<ListenSocket>& listen_sockets() const { return _listeners; }
+
+    int id() const { return _id; }
+
+protected:
+    /**
+     * @brief 继续处理连接：分发已缓存的请求，并在空闲时继续读取
+     */
+    virtual void handle_client_data(int client_fd) = 0;
+
+    /**
+     * @brief 发送连接的响应队列，全部发出后调用 write_complete
+     */
+    virtual void flush(Connection& conn) = 0;
+
+    /**
+     * @brief 发送队列已全部发出：流式响应还有后续分块、或只发出了 100 Continue 时
+     *        继续等待，否则结束请求
+     */
+    void write_complete(Connection& conn);
+
+    /**
+     * @brief 将监听 socket 移出事件循环并关闭（排空开始时调用）
+     */
+    virtual void stop_accepting() = 0;
+
+    /**
+     * @brief 登记新接受的连接：检查连接数上限，分配连接对象并启动请求头计时
+     * @param listen_fd 接受该连接的监听 socket（Unix 域 socket 的连接在这里设置缓冲区大小）
+     * @return 新连接；超过上限时关闭 fd 并返回 nullptr
+     */
+    Connection* open_connection(int client_fd, int listen_fd);
+
+    /**
+     * @brief 从连接表中移除连接并更新计数（不关闭 fd，由后端负责）
+     */
+    void release_connection(int fd);
+
+    /**
+     * @brief 将收到的数据交给连接的解析器
+     */
+    void receive(Connection& conn, const char* data, size_t len);
+
+    /**
+     * @brief 依次分发连接上已解析完成的请求
+     * @return 仍可继续读取的连接；连接已关闭或请求正在处理时返回 nullptr
+     */
+    Connection* dispatch_requests(int client_fd);
+
+    /**
+     * @brief 将响应队列中尚未发送的部分填入 iovec 数组
+     * @return 使用的 iovec 个数
+     */
+    static int fill_iovecs(const Connection& conn, struct iovec* iov, int max_iov);
+
+    /**
+     * @brief 记录已发送的字节，弹出发送完毕的响应
+     * @return 响应队列是否已清空
+     */
+    static bool consume_sent(Connection& conn, size_t sent);
+
+    /**
+     * @brief 执行其他线程投递的任务（唤醒 fd 由后端负责读取）
+     */
+    void run_pending_tasks();
+
+    /**
+     * @brief 按连接当前所处阶段设置超时定时器
+     */
+    void update_timer(Connection& conn);
+
+    /**
+     * @brief 推进时间轮，处理到期的连接
+     */
+    void expire_timers();
+
+    /**
+     * @brief 排空已完成（连接全部关闭），事件循环应退出
+     */
+    bool drained() const { return _draining && _open_connections == 0; }
+
+    int _id;
+    Server& _server;
+    const char* _addr;
+    std::vector<int> _ports;
+    std::vector<ListenSocket> _listeners;  // 本 Reactor 的监听socket（TCP 为 SO_REUSEPORT，Unix 域 socket 与其他 Reactor 共享）
+    std::vector<int> _unlistened;          // 已绑定、等待 start_listening() 的新建 socket
+    int _wakeup_fd;  // eventfd，用于唤醒事件循环执行投递的任务
+
+    int _max_connections;       // 所有 Reactor 合计的最大连接数（server.max_connections）
+    int _defer_accept_seconds;  // TCP_DEFER_ACCEPT 超时，0 表示不启用（server.defer_accept_seconds）
+    int _unix_send_buffer;      // Unix 域 socket 连接的发送缓冲区，0 为内核默认（server.unix_send_buffer_size）
+    int _unix_recv_buffer;      // Unix 域 socket 连接的接收缓冲区（server.unix_recv_buffer_size）
+
+    // 按 fd 索引的连接池（仅本 Reactor 线程访问）
+    ConnectionTable _connections;
+
+    // 连接超时（仅本 Reactor 线程访问）
+    TimerWheel _timers;
+    std::chrono::milliseconds _header_timeout;      // 请求头须在此时间内接收完整（server.header_timeout_ms）
+    std::chrono::milliseconds _body_timeout;        // body/响应发送的速率检查周期（server.body_timeout_ms）
+    size_t _min_body_rate;                          // body 最低接收速率，字节/秒（server.min_body_rate）
+    std::chrono::milliseconds _keep_alive_timeout;  // keep-alive 最长空闲时间（server.keep_alive_timeout_ms）
+
+    // 请求大小上限，超出时回复 431/413 并关闭连接（格式错误的请求回复 400）
+    size_t _max_header_size;  // server.max_header_size
+    size_t _max_body_size;    // image_processing.max_image_size，不超过 MAX_IMAGE_SIZE
+
+    // 热重启排空（仅本 Reactor 线程访问）
+    bool _draining;           // 已停止接受连接，请求完成后关闭连接
+    size_t _open_connections; // 本 Reactor 的连接数
+
+private:
+    void setup_listening_sockets(const std::vector<ListenSocket>& inherited);
+    void handle_timeout(TimerNode& node);
+    void reject_request(Connection& conn);
+    void start_lingering(Connection& conn);
+    // 把发往流句柄的响应交给连接处理器
+    void deliver_to_stream(uint64_t stream_handle, HttpResponse response);
+
+    // 正在分发的流（dispatch_stream 期间），0 表示没有
+    uint64_t _dispatching;
+    uint32_t _next_stream_token;
+
+    // 其他线程投递过来的任务
+    std::mutex _pending_mutex;
+    std::vector<std::function<void()>> _pending_tasks;
+};
+
+#endif // REACTOR_H
@@ -2,50 +2,157 @@
 #define SERVER_H
 
 #include "ThreadPool.h"
-#include <sys/epoll.h>
+#include "StaticAssets.h"
+#include "AdmissionController.h"
+#include "Reactor.h"
 #include <string>
+#include <vector>
 #include <memory>
-#include <unordered_map>
 #include <atomic>
 
 class HttpParser;
+class HttpResponse;
 
-// RAII 包装类，用于自动管理文件描述符
-class SocketGuard {
+// RAII 包装类，线程池任务通过它把响应交还给所属 Reactor 发送
+// 任务未调用 respond() / end_stream() 就退出（例如抛出异常）时关闭连接，
+// 已开始的流式响应因此缺少结束分块，客户端可以识别出响应不完整
+class RequestGuard {
 public:
-    explicit SocketGuard(int fd) : _fd(fd) {}
-    ~SocketGuard();
-    SocketGuard(const SocketGuard&) = delete;
-    SocketGuard& operator=(const SocketGuard&) = delete;
+    RequestGuard(Reactor& reactor, uint64_t handle, bool keep_alive)
+        : _reactor(reactor), _handle(handle), _keep_alive(keep_alive), _responded(false) {}
+    ~RequestGuard();
+    void respond(HttpResponse response);
+
+    // 流式响应：先发送 chunked 响应头，再陆续发送分块（空数据忽略），最后结束
+    void begin_stream(HttpResponse head);
+    void send_chunk(std::vector<char> data);
+    void end_stream();
+
+    RequestGuard(const RequestGuard&) = delete;
+    RequestGuard& operator=(const RequestGuard&) = delete;
 private:
-    int _fd;
+    Reactor& _reactor;
+    uint64_t _handle;  // 连接句柄，连接已关闭或 fd 被复用时回调自动失效
+    bool _keep_alive;
+    bool _responded;
 };
 
 
 class Server {
 public:
-    Server(const char *addr,const std::vector<int>& ports, int thread_num);
+    /**
+     * @param inherited 热重启时从旧进程接管的监听 socket，按端口轮流分给各 Reactor
+     */
+    Server(const char *addr,const std::vector<int>& ports, int thread_num, int reactor_num = 1,
+           const std::vector<ListenSocket>& inherited = {});
     ~Server();
+
+    /**
+     * @brief 新建的 TCP 监听 socket 开始 listen()（预热完成后、通知旧进程之前调用）
+     */
+    void start_listening();
+
     void run();
 
-private:
-    void setup_listening_sockets();
-    void handle_new_connection(int listen_fd);
-    void handle_client_data(int client_fd);
-    void close_connection(int fd);
+    /**
+     * @brief 停止接受新连接，处理完已有连接后 run() 返回（线程安全，热重启交接时调用）
+     */
+    void begin_drain();
+
+    /**
+     * @brief 所有 Reactor 的监听 socket，交给热重启的新进程
+     */
+    std::vector<ListenSocket> listen_sockets() const;
+
+    /**
+     * @brief 处理一个已解析完成的请求（由 Reactor 线程回调）
+     * @param reactor 连接所属的 Reactor
+     * @param client_fd 客户端文件描述符
+     * @param parser 已完成解析的请求
+     */
+    void handle_request(Reactor& reactor, int client_fd, HttpParser& parser);
+
+    /**
+     * @brief 从内存静态资源表响应 GET 请求（支持 If-None-Match 和预压缩版本）
+     */
+    void serve_static(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive);
+
+    /**
+     * @brief 以 JSON 返回准入控制等运行时计数（GET /stats）
+     */
+    void serve_stats(Reactor& reactor, int client_fd, bool keep_alive);
+
+    /**
+     * @brief 批量处理（POST /batch）：每个文件 part 一张图像，分散到线程池并行处理，
+     *        YOLO 滤镜的图像合并推理，结果按完成顺序以 multipart/mixed 返回
+     */
+    void serve_batch(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive);
+
+    /**
+     * @brief 只做 YOLO 推理、以 JSON 返回结果（POST /detect、/segment），不绘制也不重新编码
+     * @param segment true 为图像分割（/segment），查询参数 masks=1 时附带 RLE 编码的掩码
+     */
+    void serve_detection(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive, bool segment);
+
+    /**
+     * @brief 推流（POST /stream）：请求体是持续的 multipart JPEG 流（chunked 或不带长度），
+     *        连接交给 MjpegStream 接管，标注后的帧以 multipart/x-mixed-replace 返回
+     */
+    void serve_stream(Reactor& reactor, int client_fd, HttpParser& parser);
 
+    /**
+     * @brief WebSocket 握手（GET /ws）：回复 101 后连接交给 WebSocketSession，
+     *        之后在同一连接上反复提交图像和参数
+     */
+    void serve_websocket(Reactor& reactor, int client_fd, HttpParser& parser);
+
+    /**
+     * @brief HTTP/2 明文连接（h2c）：客户端直接发送连接前言，或 HTTP/1.1 请求带 Upgrade: h2c，
+     *        连接交给 Http2Session 接管，各个流上的请求再按原有路由分发
+     * @param upgrade true 为 Upgrade 升级（回复 101，原请求作为流 1）
+     */
+    void serve_http2(Reactor& reactor, int client_fd, HttpParser& parser, bool upgrade);
+
+    /**
+     * @brief 经准入控制后把图像处理任务放入线程池（/upload 和 /process 共用）
+     * @param chunked_allowed 客户端是否支持 chunked 响应（HTTP/1.1）
+     * @param image_data 编码后的图片，移入任务，不拷贝
+     */
+    void submit_image_task(Reactor& reactor, int client_fd, bool keep_alive, bool chunked_allowed,
+                           std::vector<char> image_data, std::string filter,
+                           std::string blur_intensity, std::string sharpen_intensity);
+
+    /**
+     * @brief 线程池过载时直接由 Reactor 回复 503（带 Retry-After）
+     */
+    void reject_overloaded(Reactor& reactor, int client_fd, bool keep_alive);
+
+    // 连接数统计（所有 Reactor 共享）
+    std::atomic<int>& connection_counter() { return _current_connections; }
+
+private:
     const char * _addr;
     std::vector<int> _ports;
-    std::vector<int> _listen_fds;  // 多个监听socket
-    int _epoll_fd;
     ThreadPool _thread_pool;
-    
-    // 从 fd 映射到 HttpParser 实例
-    std::unordered_map<int, std::unique_ptr<HttpParser>> _client_parsers;
-    
+    StaticAssets _static_assets;  // web 目录的内存只读副本
+    AdmissionController _admission;  // 线程池前的准入控制
+
+    // 大图使用 chunked 流式响应，编码与发送交叠（streaming 配置）
+    bool _streaming_enabled;
+    size_t _stream_min_pixels;  // 输出像素数达到该值时流式发送
+    size_t _stream_chunk_size;  // 每个分块的大小
+
+    // 批量接口（batch 配置）
+    size_t _batch_max_images;  // 每个请求的图像数上限，超出回复 413
+    size_t _yolo_batch_size;   // 同一滤镜的 YOLO 图像每次合并推理的张数
+
+    bool _http2_enabled;  // 接受 h2c 连接（http2 配置）
+
+    // 每个 Reactor 一个事件循环（epoll 或 io_uring），各自持有 SO_REUSEPORT 监听socket和连接表
+    std::vector<std::unique_ptr<Reactor>> _reactors;
+
     // 当前连接数统计
     std::atomic<int> _current_connections;
 };
 
 #endif // SERVER_H
-
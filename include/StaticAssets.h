@@ -0,0 +1,71 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+
+/**
+ * @brief 单个静态文件（加载后只读）
+ */
+struct StaticAsset {
+    std::string mime_type;     ///< 由 get_mime_type 推断
+    std::string etag;          ///< 强 ETag（原始内容）
+    std::string body;          ///< 原始内容
+    std::string gzip_body;     ///< gzip 预压缩内容，为空表示不提供
+    std::string brotli_body;   ///< brotli 预压缩内容，为空表示不提供
+};
+
+/**
+ * @brief 静态资源表
+ *
+ * 启动时把 web 目录下的所有文件加载到内存中的只读表（URL 路径 -> 资源），
+ * 同时计算 ETag 并生成 gzip/brotli 预压缩版本。文件变化时（inotify）
+ * 重新加载并原子替换整张表，正在发送的旧资源由 shared_ptr 保持有效。
+ */
+class StaticAssets {
+public:
+    using Table = std::unordered_map<std::string, std::shared_ptr<const StaticAsset>>;
+
+    explicit StaticAssets(const std::string& root);
+    ~StaticAssets();
+
+    StaticAssets(const StaticAssets&) = delete;
+    StaticAssets& operator=(const StaticAssets&) = delete;
+
+    /**
+     * @brief 重新扫描目录并替换资源表
+     * @return 是否加载成功
+     */
+    bool load();
+
+    /**
+     * @brief 启动后台线程监视目录变化并自动重新加载
+     */
+    void watch();
+
+    /**
+     * @brief 按 URL 路径查找资源（"/" 映射到 "/index.html"）
+     * @return 资源，不存在返回 nullptr
+     */
+    std::shared_ptr<const StaticAsset> find(std::string_view path) const;
+
+    /**
+     * @brief 按 Accept-Encoding 选择内容编码（q 值较高者优先，相同时 brotli 优先）
+     * @return "br"、"gzip"，使用原始内容时返回 nullptr
+     */
+    static const char* select_encoding(const StaticAsset& asset, std::string_view accept_encoding);
+
+private:
+    void watch_loop(int inotify_fd);
+
+    std::string _root;
+    std::shared_ptr<const Table> _table;  // 通过 std::atomic_load/atomic_store 访问
+    std::thread _watcher;
+    std::atomic<bool> _stop;
+};
+
+#endif // STATIC_ASSETS_H
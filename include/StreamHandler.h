@@ -0,0 +1,61 @@
+#ifndef STREAM_HANDLER_H
+#define STREAM_HANDLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+class HttpResponse;
+
+/**
+ * @brief 接管连接的处理器（MJPEG 推流、WebSocket、HTTP/2 等长连接）
+ *
+ * Server 在分发请求时通过 Reactor::attach_handler() 接管连接：此后收到的数据
+ * 不再按 HTTP 请求解析，而是原样交给处理器；处理器通过 Reactor 的接口发送数据。
+ * 所有回调都在连接所属的 Reactor 线程中执行。
+ *
+ * 多路复用的处理器（HTTP/2）通过 Reactor::dispatch_stream() 把各个流上的请求
+ * 交给 Server 处理，发往流句柄的响应经由 on_response() 回到处理器。
+ */
+class StreamHandler {
+public:
+    virtual ~StreamHandler() = default;
+
+    /**
+     * @brief 收到数据
+     * @return false 表示数据格式错误，Reactor 随即关闭连接
+     */
+    virtual bool on_data(const char* data, size_t len) = 0;
+
+    /**
+     * @brief 连接已关闭（对端断开、出错或超时），之后不会再有回调
+     */
+    virtual void on_close() = 0;
+
+    /**
+     * @brief 发往流句柄的响应（响应头、分块或结束分块），token 为分发时使用的流令牌
+     */
+    virtual void on_response(uint32_t /*token*/, HttpResponse&& /*response*/) {}
+
+    /**
+     * @brief 流上的请求未能给出响应（线程池任务异常退出等）
+     */
+    virtual void on_abort(uint32_t /*token*/) {}
+
+    /**
+     * @brief 连接的发送队列已清空，可以继续写出
+     */
+    virtual void on_writable() {}
+
+    /**
+     * @brief 没有进行中的工作；只有空闲时才因超过 keep-alive 超时没有数据而关闭连接
+     */
+    virtual bool idle() const { return true; }
+
+    /**
+     * @brief 热重启排空开始
+     * @return true 表示处理器自行在工作完成后结束连接；false 时连接立即关闭
+     */
+    virtual bool on_drain() { return false; }
+};
+
+#endif // STREAM_HANDLER_H
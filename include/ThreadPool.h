@@ -2,13 +2,24 @@
 #define THREAD_POOL_H
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <memory>
 #include <functional>
 #include <future>
+#include <stdexcept>
 
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程有自己的无锁双端队列（WorkStealingDeque）：工作线程内提交的任务
+ * （例如推流流水线的下一阶段）放入自己的队列，后进先出，数据还在缓存中；
+ * Reactor 等外部线程提交的任务放入共享的注入队列，工作线程每次取出一批转入自己的队列。
+ * 自己的队列为空时从随机选择的其他线程窃取，都没有任务时通过 futex 休眠，
+ * 提交任务时只在有线程休眠时才唤醒一个，不再让所有提交和取出争用同一把锁。
+ */
 class ThreadPool {
 public:
     ThreadPool(size_t threads);
@@ -18,19 +29,44 @@ public:
     auto enqueue(F&& f, Args&&... args)
         -> std::future<typename std::result_of<F(Args...)>::type>;
 
+    // 停止接收新任务，执行完队列中剩余的任务后回收工作线程（可重复调用）
+    void shutdown();
+
 private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    bool stop;
+    using Task = std::function<void()>;
+    struct Worker;
+
+    // 放入当前工作线程的队列（在本线程池的工作线程中调用时）或注入队列
+    void submit(std::unique_ptr<Task> task);
+
+    void worker_loop(size_t index);
+    Task* find_task(Worker& self);
+    Task* take_injected(Worker& self);
+    Task* steal(Worker& self);
+    bool has_work() const;
+    void wake_one();
+    void park(uint32_t epoch);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // 外部线程提交的任务
+    std::mutex _injector_mutex;
+    std::deque<Task*> _injector;
+    std::atomic<size_t> _injected;  // 注入队列中的任务数，工作线程不加锁即可判断是否为空
+
+    // 休眠与唤醒：提交任务时递增 _epoch 并唤醒一个在其上等待的线程
+    std::atomic<uint32_t> _epoch;
+    std::atomic<int> _sleepers;
+
+    std::atomic<bool> _stop;
+
+    static thread_local Worker* _current_worker;  // 当前线程所属的工作线程（不是工作线程时为 nullptr）
 };
 
 // --- Template Implementation ---
 
 template<class F, class... Args>
-auto ThreadPool::enqueue(F&& f, Args&&... args) 
+auto ThreadPool::enqueue(F&& f, Args&&... args)
     -> std::future<typename std::result_of<F(Args...)>::type>
 {
     using return_type = typename std::result_of<F(Args...)>::type;
@@ -38,17 +74,9 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     auto task = std::make_shared<std::packaged_task<return_type()>>(
         std::bind(std::forward<F>(f), std::forward<Args>(args)...)
     );
-        
-    std::future<return_type> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
 
-        if(stop)
-            throw std::runtime_error("在已停止的线程池上入队");
-
-        tasks.emplace([task](){ (*task)(); });
-    }
-    condition.notify_one();
+    std::future<return_type> res = task->get_future();
+    submit(std::make_unique<Task>([task](){ (*task)(); }));
     return res;
 }
 
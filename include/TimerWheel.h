@@ -0,0 +1,77 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <chrono>
+#include <functional>
+
+/**
+ * @brief 侵入式定时器节点，嵌入在需要超时管理的对象中（如 Connection）
+ *
+ * 节点由 TimerWheel 通过双向链表串入时间槽，插入/删除均为 O(1)，不分配内存。
+ */
+struct TimerNode {
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    uint64_t expire_tick = 0;  // 到期的绝对 tick
+    uint64_t data = 0;         // 由使用者定义（Reactor 中存放连接句柄）
+    bool linked() const { return prev != nullptr; }
+};
+
+/**
+ * @brief 分层时间轮
+ *
+ * 共 LEVELS 层，每层 SLOTS 个槽，第 0 层每槽一个 tick（TICK_MS 毫秒），
+ * 上一层每槽覆盖下一层一整圈；高层槽在指针经过时逐级下移（cascade）。
+ * 定时器的设置、取消和到期处理均为 O(1)，无需扫描整张连接表。
+ * 仅由所属 Reactor 线程访问。
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int TICK_MS = 100;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;  // 64
+    static constexpr int LEVELS = 4;               // 覆盖约 64^4 * 100ms ≈ 19 天
+
+    TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief 设置（或重新设置）定时器的到期时间
+     */
+    void schedule(TimerNode& node, Clock::time_point deadline);
+
+    /**
+     * @brief 取消定时器，未设置时无操作
+     */
+    void cancel(TimerNode& node);
+
+    /**
+     * @brief 推进到当前时间，对每个到期节点调用 on_expire（节点已先行移除，可在回调中重新设置）
+     */
+    void advance(Clock::time_point now, const std::function<void(TimerNode&)>& on_expire);
+
+    /**
+     * @brief 距离下一次需要推进的毫秒数，作为 epoll_wait 的超时；没有定时器时返回 -1
+     */
+    int next_timeout_ms(Clock::time_point now) const;
+
+    size_t size() const { return _count; }
+
+private:
+    uint64_t to_tick(Clock::time_point time) const;
+    void link(TimerNode& node);
+    void cascade(int level);
+
+    // 每个槽是一个带哨兵的循环链表
+    TimerNode _slots[LEVELS][SLOTS];
+    Clock::time_point _start;
+    uint64_t _current_tick;  // 已处理到的 tick
+    size_t _count;
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,43 @@
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Unix 域监听 socket（server.ports 中的 "unix:/path"，"unix:@name" 为抽象命名空间）
+ *
+ * 同一主机上的客户端经由 Unix 域 socket 连接，不经过 TCP 协议栈。Unix 域 socket
+ * 不支持 SO_REUSEPORT，每个地址只创建一个监听 socket，由 Server 复制给各个 Reactor。
+ */
+namespace unix_socket {
+
+constexpr std::string_view PREFIX = "unix:";
+
+/**
+ * @brief 是否为 unix: 开头的监听地址
+ */
+bool is_address(std::string_view address);
+
+/**
+ * @brief 创建、绑定并监听；路径上遗留的 socket 文件（没有进程在监听）先删除
+ * @return 非阻塞的监听 socket
+ * @throws std::runtime_error 地址无效、已有进程在监听或绑定失败
+ */
+int listen(const std::string& address, int backlog);
+
+/**
+ * @brief socket 绑定的地址（unix: 格式），不是 Unix 域 socket 时返回空串
+ */
+std::string local_address(int fd);
+
+/**
+ * @brief 设置连接的发送和接收缓冲区，0 表示保持内核默认值
+ *
+ * 新连接不继承监听 socket 的缓冲区大小，需要在 accept 之后逐个设置。
+ */
+void set_buffer_sizes(int fd, int send_size, int recv_size);
+
+} // namespace unix_socket
+
+#endif // UNIX_SOCKET_H
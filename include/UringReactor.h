@@ -0,0 +1,81 @@
+#ifndef URING_REACTOR_H
+#define URING_REACTOR_H
+
+#include <liburing.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "Reactor.h"
+#include "HttpResponse.h"
+
+/**
+ * @brief 基于 io_uring 的 Reactor 后端（server.io_backend = "io_uring"）
+ *
+ * 与 EpollReactor 共用连接表、解析/分发和超时逻辑，区别只在 I/O 方式：
+ * - 监听 socket 使用 multishot accept，一次提交持续接受连接；
+ * - 客户端使用 multishot recv + 提供的缓冲区环（provided buffer ring），
+ *   读取无需逐个连接准备缓冲区，也没有 epoll_ctl；与 epoll 后端一样，
+ *   请求处理期间不读取，取消 recv，请求完成后重新提交；
+ * - 响应队列通过 sendmsg 提交；最后一个响应（Connection: close）与
+ *   取消 recv、close 链接提交，发送完成后由内核直接关闭连接。
+ * 一次 io_uring_submit_and_wait_timeout 同时完成提交和等待，超时取自最近的连接定时器。
+ */
+class UringReactor : public Reactor {
+public:
+    UringReactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                 const std::vector<ListenSocket>& inherited = {});
+    ~UringReactor() override;
+
+    void run() override;
+    const char* backend_name() const override { return "io_uring"; }
+    void close_connection(int fd) override;
+
+protected:
+    void handle_client_data(int client_fd) override;
+    void flush(Connection& conn) override;
+    void stop_accepting() override;
+
+private:
+    static constexpr int MAX_IOV = 16;
+
+    // 一次已提交的 sendmsg；完成前 iovec 指向的数据必须保持有效
+    struct SendOp {
+        uint64_t handle = 0;        // 发起发送的连接句柄
+        bool close_linked = false;  // 是否链接了 close
+        struct msghdr msg = {};
+        struct iovec iov[MAX_IOV];
+        std::deque<HttpResponse> orphaned;  // 发送期间连接被关闭时，暂存其响应数据
+    };
+
+    // 按 fd 索引的 I/O 状态
+    struct IoState {
+        bool recv_armed = false;  // multishot recv 是否仍在进行
+        bool recv_cancelling = false;  // 请求处理期间已提交取消，等待最后一个完成事件
+        bool closing = false;     // 已提交 close（或链接的 close），不再读写
+        SendOp* send = nullptr;   // 正在进行的发送
+    };
+
+    io_uring_sqe* get_sqe();
+    void reserve_sqes(unsigned count);
+    IoState& io_state(int fd);
+
+    void arm_accept(int listen_fd);
+    void arm_wakeup();
+    void arm_recv(Connection& conn);
+    void pause_recv(int fd);
+    void submit_close(int fd);
+    void recycle_buffer(uint16_t bid);
+
+    void handle_cqe(uint64_t user_data, int res, uint32_t flags);
+    void on_accept(int listen_fd, int res, uint32_t flags);
+    void on_recv(uint64_t handle, int res, uint32_t flags);
+    void on_send(SendOp* op, int res);
+    void on_close(uint64_t handle, int res);
+
+    io_uring _ring;
+    io_uring_buf_ring* _buf_ring;
+    std::vector<char> _buffers;  // 提供给内核的接收缓冲区
+    std::vector<IoState> _io;
+};
+
+#endif // URING_REACTOR_H
@@ -0,0 +1,87 @@
+#ifndef WEBSOCKET_PARSER_H
+#define WEBSOCKET_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class HttpResponse;
+
+/**
+ * @brief 增量 WebSocket（RFC 6455）帧解析器，只用于服务端
+ *
+ * 数据可在任意位置被切分；客户端帧的掩码在复制负载时去除，分片的数据帧拼成完整消息后
+ * 交给回调，控制帧（可能夹在分片之间）单独交出。不支持扩展（RSV 位必须为 0）。
+ */
+class WebSocketParser {
+public:
+    enum Opcode : uint8_t {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    // 关闭码
+    static constexpr uint16_t CLOSE_NORMAL = 1000;
+    static constexpr uint16_t CLOSE_PROTOCOL_ERROR = 1002;
+    static constexpr uint16_t CLOSE_TOO_BIG = 1009;
+
+    using Handler = std::function<void(Opcode opcode, std::vector<char> payload)>;
+
+    /**
+     * @param max_message_size 单条消息（所有分片之和）的上限，超过时以 1009 关闭
+     */
+    explicit WebSocketParser(size_t max_message_size);
+
+    /**
+     * @brief 解析一段数据，完整的消息和控制帧依次交给 handler
+     * @return 协议错误时返回 false，由 error_code() 给出关闭码，之后的数据被忽略
+     */
+    bool feed(const char* data, size_t len, const Handler& handler);
+
+    uint16_t error_code() const { return _error; }
+
+    /**
+     * @brief 握手响应的 Sec-WebSocket-Accept：base64(SHA-1(key + GUID))
+     */
+    static std::string accept_key(std::string_view key);
+
+    /**
+     * @brief 服务端帧（不加掩码，不分片），payload 接管不拷贝
+     * @param keep_alive 为 false 时发送完毕后关闭连接（CLOSE 帧）
+     * @param prefix 放在 payload 之前的一小段负载（与帧头一起拷贝，不超过 1KB）
+     */
+    static HttpResponse frame(Opcode opcode, std::vector<char> payload, bool keep_alive = true,
+                              std::string_view prefix = std::string_view());
+
+private:
+    bool fail(uint16_t code);
+    bool start_frame();
+    void finish_frame(const Handler& handler);
+
+    size_t _max_message_size;
+    uint16_t _error;
+
+    // 当前帧
+    uint8_t _header[14];   // 帧头最长 2 + 8 + 4 字节
+    size_t _header_len;
+    size_t _header_need;
+    bool _fin;
+    Opcode _opcode;
+    uint8_t _mask[4];
+    uint64_t _remaining;   // 当前帧剩余的负载字节
+    uint64_t _offset;      // 当前帧已收到的负载字节（掩码按此对齐）
+
+    // 分片消息
+    Opcode _message_opcode;  // CONTINUATION 表示没有未完成的消息
+    std::vector<char> _message;
+    std::vector<char> _control;  // 控制帧负载（最多 125 字节）
+};
+
+#endif // WEBSOCKET_PARSER_H
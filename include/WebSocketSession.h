@@ -0,0 +1,82 @@
+#ifndef WEBSOCKET_SESSION_H
+#define WEBSOCKET_SESSION_H
+
+#include "StreamHandler.h"
+#include "WebSocketParser.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Reactor;
+class ThreadPool;
+class AdmissionController;
+class HttpResponse;
+
+/**
+ * @brief 交互式处理的 WebSocket 会话（GET /ws 升级后接管连接）
+ *
+ * 一个连接上反复提交"参数 + 图像"，结果以二进制消息返回，省去每次的建连和 HTTP 解析。
+ * 请求与结果的消息格式都是：4 字节大端 JSON 长度 + JSON + 图像数据（可为空）。
+ *   请求 JSON: {"id": 任意, "filter": ..., "blur_intensity": ..., "sharpen_intensity": ...}
+ *   结果 JSON: {"id": 原样返回, "status": 200/400/409/500/503, "content_type": ...}
+ * 不带图像的请求（或文本消息，内容就是请求 JSON）沿用本连接上一次上传的图像，
+ * 拖动滑动条时只需发送参数。
+ *
+ * 每个会话同一时间只有一个任务在线程池中；处理期间收到的请求只保留最新一个，
+ * 被替换的请求回复 409，拖动滑动条产生的中间参数不会排队。
+ * 所有状态只在 Reactor 线程中访问（任务完成后通过 Reactor::post 交回）。
+ */
+class WebSocketSession : public StreamHandler, public std::enable_shared_from_this<WebSocketSession> {
+public:
+    /**
+     * @param handle 连接句柄
+     * @param max_message_size 单条消息的上限（图像大小上限加上参数）
+     */
+    WebSocketSession(Reactor& reactor, uint64_t handle, ThreadPool& pool, AdmissionController& admission,
+                     size_t max_message_size);
+
+    bool on_data(const char* data, size_t len) override;
+    void on_close() override;
+    void on_writable() override;
+
+    WebSocketSession(const WebSocketSession&) = delete;
+    WebSocketSession& operator=(const WebSocketSession&) = delete;
+
+private:
+    struct Request {
+        nlohmann::json id;  // 请求 JSON 中的 id 字段，原样放回结果
+        std::string filter;
+        std::string blur_intensity;
+        std::string sharpen_intensity;
+        std::shared_ptr<const std::vector<char>> image;
+    };
+
+    void on_message(WebSocketParser::Opcode opcode, std::vector<char> payload);
+    // 解析请求；带图像时图像数据从 payload 移出
+    bool parse_request(std::vector<char>& payload, bool binary, Request& request, std::string& error);
+    void submit(Request request);
+    void complete(const nlohmann::json& id, int status, const std::string& content_type, std::vector<char> image);
+    void reply(const nlohmann::json& id, int status, const std::string& error);
+    void send_result(const nlohmann::json& head, std::vector<char> image);
+    void send(HttpResponse frame);
+    void close(uint16_t code);
+
+    Reactor& _reactor;
+    uint64_t _handle;
+    ThreadPool& _pool;
+    AdmissionController& _admission;
+    WebSocketParser _parser;
+
+    std::shared_ptr<const std::vector<char>> _image;  // 最近一次上传的图像
+    bool _busy;                       // 有任务在线程池中
+    std::optional<Request> _pending;  // 处理期间收到的最新请求
+    std::vector<char> _pong;          // 发送队列清空后回复的最新 PING 载荷
+    bool _pong_pending;
+    bool _closing;  // 已发送 CLOSE 帧，忽略之后的数据
+    bool _closed;   // 连接已关闭
+};
+
+#endif // WEBSOCKET_SESSION_H
@@ -0,0 +1,130 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 无锁工作窃取双端队列（Chase-Lev，按 Lê 等人给出的 C11 内存序实现）
+ *
+ * 只有所属线程调用 push() 和 pop()，从底部后进先出；其他线程调用 steal()，从顶部先进先出。
+ * 只存放指针，元素的所有权由调用方管理。容量不足时加倍，旧的环形缓冲区可能仍被
+ * 窃取线程读取，保留到队列析构时才释放。
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256) : _top(0), _bottom(0) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        _buffers.push_back(std::make_unique<Buffer>(size));
+        _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief 放入底部（仅所属线程）
+     */
+    void push(T* item) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(buffer->mask)) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->put(bottom, item);
+        _bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 从底部取出（仅所属线程），为空时返回 nullptr
+     */
+    T* pop() {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = buffer->get(bottom);
+        if (top == bottom) {
+            // 只剩最后一个，与窃取线程竞争
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * @brief 从顶部窃取（任意线程），为空或与其他线程竞争失败时返回 nullptr
+     */
+    T* steal() {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Buffer* buffer = _buffer.load(std::memory_order_acquire);
+        T* item = buffer->get(top);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /**
+     * @brief 近似的元素个数（其他线程读取时只作为是否有任务的提示）
+     */
+    size_t size() const {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T*>[capacity]) {}
+
+        T* get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+        void put(int64_t index, T* item) {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    Buffer* grow(Buffer* old, int64_t top, int64_t bottom) {
+        _buffers.push_back(std::make_unique<Buffer>((old->mask + 1) * 2));
+        Buffer* buffer = _buffers.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            buffer->put(i, old->get(i));
+        }
+        _buffer.store(buffer, std::memory_order_release);
+        return buffer;
+    }
+
+    // 所属线程与窃取线程频繁写入不同的下标，各占一个缓存行
+    alignas(64) std::atomic<int64_t> _top;
+    alignas(64) std::atomic<int64_t> _bottom;
+    alignas(64) std::atomic<Buffer*> _buffer;
+    std::vector<std::unique_ptr<Buffer>> _buffers;  // 当前及已替换的缓冲区（仅所属线程修改）
+};
+
+#endif // WORK_STEALING_DEQUE_H
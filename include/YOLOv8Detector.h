@@ -5,6 +5,8 @@
 #include <opencv2/dnn.hpp>
 #include <vector>
 #include <string>
+#include <mutex>
+#include <atomic>
 
 /**
  * @brief YOLOv8目标检测结果结构体
@@ -35,8 +37,10 @@ struct YOLOSegmentation {
 class YOLOv8Detector {
 private:
     cv::dnn::Net yolo_net;                    ///< YOLOv8网络模型
+    std::mutex net_mutex;                     ///< 保护 yolo_net：工作线程共用一个检测器
     std::vector<std::string> class_names;     ///< 类别名称列表
     bool model_loaded;                        ///< 模型是否已加载
+    std::atomic<bool> batch_supported;        ///< 批量推理失败过一次后置 false，之后直接逐张推理
     float confidence_threshold;               ///< 置信度阈值
     float nms_threshold;                      ///< NMS阈值
     int net_width;                           ///< 网络输入宽度
@@ -84,6 +88,22 @@ public:
      * @return 分割结果列表
      */
     std::vector<YOLOSegmentation> detectSegmentation(const cv::Mat& image);
+
+    /**
+     * @brief 批量目标检测：多张图像合成一个 blob，只做一次前向传播
+     *
+     * 模型不支持批量输入（导出时 batch 固定为 1）时逐张检测。
+     * @param images 输入图像列表
+     * @return 每张图像的检测结果，与输入顺序一致
+     */
+    std::vector<std::vector<YOLODetection>> detectBatch(const std::vector<cv::Mat>& images);
+
+    /**
+     * @brief 批量图像分割，规则同 detectBatch
+     * @param images 输入图像列表
+     * @return 每张图像的分割结果，与输入顺序一致
+     */
+    std::vector<std::vector<YOLOSegmentation>> detectSegmentationBatch(const std::vector<cv::Mat>& images);
     
     /**
      * @brief 绘制检测结果
@@ -145,6 +165,22 @@ public:
     cv::Size getInputSize() const;
 
 private:
+    /**
+     * @brief 设置输入并前向传播，同一时间只有一个线程使用网络
+     * @param blob 网络输入
+     * @param outputs 网络输出
+     */
+    void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs);
+
+    /**
+     * @brief 对一批图像做一次前向传播
+     * @param images 输入图像列表
+     * @param outputs 网络输出，第 0 维为 batch
+     * @return 模型未加载、推理失败或输出不是批量形状时返回 false；
+     *         失败一次后记住结果，之后不再尝试批量推理
+     */
+    bool forwardBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs);
+
     /**
      * @brief 解析YOLOv8输出
      * @param outputs 网络输出
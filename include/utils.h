@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <string>
+#include <string_view>
 #include <fcntl.h>
 #include <unistd.h>
 #include <fstream>
@@ -129,6 +130,28 @@ inline std::string url_decode(const std::string& encoded) {
     return result;
 }
 
+/**
+ * 从查询字符串中取出参数值
+ * @param query 查询字符串（'?' 之后的部分，如 "filter=blur&blur_intensity=15"）
+ * @param name 参数名
+ * @return URL 解码后的参数值，不存在时返回空字符串
+ */
+inline std::string get_query_param(std::string_view query, std::string_view name) {
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string() : url_decode(std::string(pair.substr(eq + 1)));
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(amp + 1);
+    }
+    return std::string();
+}
+
 /**
  * 安全的字符串到整数转换
  * @param str 字符串
@@ -0,0 +1,96 @@
+#include "AdmissionController.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t WORK_BYTES_UNIT = 1024 * 1024;
+
+// 各滤镜相对普通滤镜的开销（分割模型远重于检测，检测远重于像素级滤镜）
+size_t filter_weight(const std::string& filter) {
+    if (filter.compare(0, 12, "yolo_segment") == 0) return 16;
+    if (filter == "yolo_detect") return 4;
+    if (filter == "cartoon" || filter == "oil_painting") return 4;
+    return 1;
+}
+
+} // namespace
+
+AdmissionController::Ticket::Ticket(Ticket&& other) noexcept
+    : _owner(other._owner), _bytes(other._bytes), _work(other._work) {
+    other._owner = nullptr;
+}
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        _owner = other._owner;
+        _bytes = other._bytes;
+        _work = other._work;
+        other._owner = nullptr;
+    }
+    return *this;
+}
+
+AdmissionController::Ticket::~Ticket() {
+    release();
+}
+
+void AdmissionController::Ticket::release() {
+    if (_owner) {
+        _owner->release(_bytes, _work);
+        _owner = nullptr;
+    }
+}
+
+AdmissionController::AdmissionController(const Limits& limits, int retry_after_seconds)
+    : _limits(limits), _retry_after_seconds(std::max(1, retry_after_seconds)),
+      _tasks(0), _bytes(0), _work(0),
+      _admitted(0), _rejected_tasks(0), _rejected_bytes(0), _rejected_work(0) {
+}
+
+std::optional<AdmissionController::Ticket> AdmissionController::try_admit(size_t bytes, size_t work) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tasks + 1 > _limits.max_tasks) {
+        ++_rejected_tasks;
+        return std::nullopt;
+    }
+    // 空闲时总是允许一个任务通过，单个超大请求不会被永久拒绝
+    if (_tasks > 0 && _bytes + bytes > _limits.max_bytes) {
+        ++_rejected_bytes;
+        return std::nullopt;
+    }
+    if (_tasks > 0 && _work + work > _limits.max_work) {
+        ++_rejected_work;
+        return std::nullopt;
+    }
+    ++_tasks;
+    _bytes += bytes;
+    _work += work;
+    ++_admitted;
+    return Ticket(this, bytes, work);
+}
+
+void AdmissionController::release(size_t bytes, size_t work) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_tasks;
+    _bytes -= bytes;
+    _work -= work;
+}
+
+size_t AdmissionController::estimate_work(const std::string& filter, size_t bytes) {
+    size_t units = std::max<size_t>(1, (bytes + WORK_BYTES_UNIT - 1) / WORK_BYTES_UNIT);
+    return filter_weight(filter) * units;
+}
+
+AdmissionController::Stats AdmissionController::stats() const {
+    Stats s;
+    s.admitted = _admitted;
+    s.rejected_tasks = _rejected_tasks;
+    s.rejected_bytes = _rejected_bytes;
+    s.rejected_work = _rejected_work;
+    std::lock_guard<std::mutex> lock(_mutex);
+    s.tasks = _tasks;
+    s.bytes = _bytes;
+    s.work = _work;
+    return s;
+}
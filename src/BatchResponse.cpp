@@ -0,0 +1,71 @@
+#include "BatchResponse.h"
+#include "HttpResponse.h"
+#include <random>
+#include <cstdio>
+
+namespace {
+
+// 每个响应使用随机的 boundary；各 part 都带 Content-Length，客户端不必扫描图像数据
+std::string make_boundary() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "imp-batch-%016llx", static_cast<unsigned long long>(rng()));
+    return buffer;
+}
+
+} // namespace
+
+BatchResponse::BatchResponse(Reactor& reactor, uint64_t handle, bool keep_alive, bool chunked, size_t count)
+    : _guard(reactor, handle, keep_alive), _keep_alive(keep_alive), _chunked(chunked),
+      _boundary(make_boundary()), _remaining(count), _first_part(true) {
+    if (_chunked) {
+        // 响应头先发出，之后每完成一张图像发送一个 part
+        HttpResponse head(200, keep_alive);
+        head.set_content_type("multipart/mixed; boundary=" + _boundary);
+        _guard.begin_stream(std::move(head));
+    }
+}
+
+void BatchResponse::complete(size_t index, const std::string& name, const std::string& content_type,
+                             std::vector<char> data) {
+    bool success = !data.empty();
+    if (!success) {
+        std::string_view message = "图像处理失败";
+        data.assign(message.begin(), message.end());
+    }
+
+    std::string head = "\r\nContent-Type: " + (success ? content_type : std::string("text/plain; charset=utf-8"));
+    head += "\r\nContent-Disposition: inline; name=\"" + name + "\"";
+    head += "\r\nX-Index: " + std::to_string(index);
+    head += success ? "\r\nX-Status: 200" : "\r\nX-Status: 500";
+    head += "\r\nContent-Length: " + std::to_string(data.size()) + "\r\n\r\n";
+
+    // 整个 part 在锁内写出，不同线程完成的 part 不会交错
+    std::lock_guard<std::mutex> lock(_mutex);
+    head.insert(0, (_first_part ? "--" : "\r\n--") + _boundary);
+    _first_part = false;
+    write(std::vector<char>(head.begin(), head.end()));
+    write(std::move(data));
+
+    if (--_remaining > 0) {
+        return;
+    }
+    std::string closing = "\r\n--" + _boundary + "--\r\n";
+    write(std::vector<char>(closing.begin(), closing.end()));
+    if (_chunked) {
+        _guard.end_stream();
+    } else {
+        HttpResponse response(200, _keep_alive);
+        response.set_content_type("multipart/mixed; boundary=" + _boundary);
+        response.set_body(std::move(_buffered));
+        _guard.respond(std::move(response));
+    }
+}
+
+void BatchResponse::write(std::vector<char> data) {
+    if (_chunked) {
+        _guard.send_chunk(std::move(data));
+    } else {
+        _buffered.insert(_buffered.end(), data.begin(), data.end());
+    }
+}
@@ -0,0 +1,120 @@
+#include "ChunkedDecoder.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t MAX_SIZE_DIGITS = 15;      // 长度最多 15 位十六进制，不会溢出
+constexpr size_t MAX_LINE_LENGTH = 8 * 1024;  // chunk 扩展和单行 trailer 的上限
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+ChunkedDecoder::ChunkedDecoder() {
+    reset();
+}
+
+void ChunkedDecoder::reset() {
+    _state = State::SIZE;
+    _remaining = 0;
+    _digits = 0;
+    _line_len = 0;
+}
+
+bool ChunkedDecoder::decode(const char* data, size_t len, const Sink& sink) {
+    const char* end = data + len;
+    while (data < end) {
+        if (_state == State::DATA) {
+            // 负载整段交给 sink，不逐字节处理
+            size_t n = static_cast<size_t>(std::min<uint64_t>(_remaining, end - data));
+            sink(data, n);
+            data += n;
+            _remaining -= n;
+            if (_remaining == 0) {
+                _state = State::DATA_CR;
+            }
+            continue;
+        }
+
+        char c = *data++;
+        switch (_state) {
+            case State::SIZE: {
+                int value = hex_value(c);
+                if (value >= 0) {
+                    if (++_digits > MAX_SIZE_DIGITS) {
+                        _state = State::ERROR;
+                        break;
+                    }
+                    _remaining = _remaining * 16 + value;
+                } else if (_digits > 0 && (c == ';' || c == ' ' || c == '\t')) {
+                    _line_len = 0;
+                    _state = State::EXTENSION;
+                } else if (_digits > 0 && c == '\r') {
+                    _state = State::SIZE_LF;
+                } else {
+                    _state = State::ERROR;
+                }
+                break;
+            }
+            case State::EXTENSION:
+                if (c == '\r') {
+                    _state = State::SIZE_LF;
+                } else if (++_line_len > MAX_LINE_LENGTH) {
+                    _state = State::ERROR;
+                }
+                break;
+            case State::SIZE_LF:
+                if (c != '\n') {
+                    _state = State::ERROR;
+                } else if (_remaining == 0) {
+                    _line_len = 0;
+                    _state = State::TRAILER;
+                } else {
+                    _state = State::DATA;
+                }
+                break;
+            case State::DATA_CR:
+                _state = c == '\r' ? State::DATA_LF : State::ERROR;
+                break;
+            case State::DATA_LF:
+                if (c == '\n') {
+                    _digits = 0;
+                    _state = State::SIZE;
+                } else {
+                    _state = State::ERROR;
+                }
+                break;
+            case State::TRAILER:
+                if (c == '\r') {
+                    _state = State::TRAILER_LF;
+                } else if (++_line_len > MAX_LINE_LENGTH) {
+                    _state = State::ERROR;
+                }
+                break;
+            case State::TRAILER_LF:
+                if (c != '\n') {
+                    _state = State::ERROR;
+                } else if (_line_len == 0) {
+                    _state = State::DONE;
+                } else {
+                    _line_len = 0;
+                    _state = State::TRAILER;
+                }
+                break;
+            case State::DONE:
+                return true;
+            case State::ERROR:
+            case State::DATA:
+                break;
+        }
+        if (_state == State::ERROR) {
+            return false;
+        }
+    }
+    return _state != State::ERROR;
+}
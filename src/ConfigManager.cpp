@@ -35,9 +35,12 @@ std::vector<int> ConfigManager::getServerPorts() const {
     if (!config_loaded_) return {8080, 8081, 8082, 8083, 8084};
     
     try {
+        // 列表中的字符串是 Unix 域 socket 地址，见 getServerUnixSockets()
         std::vector<int> ports;
         for (const auto& port : config_["server"]["ports"]) {
-            ports.push_back(port.get<int>());
+            if (!port.is_string()) {
+                ports.push_back(port.get<int>());
+            }
         }
         return ports;
     } catch (const std::exception& e) {
@@ -46,6 +49,51 @@ std::vector<int> ConfigManager::getServerPorts() const {
     }
 }
 
+std::vector<std::string> ConfigManager::getServerUnixSockets() const {
+    if (!config_loaded_) return {};
+    
+    try {
+        std::vector<std::string> addresses;
+        for (const auto& port : config_["server"]["ports"]) {
+            if (!port.is_string()) {
+                continue;
+            }
+            std::string address = port.get<std::string>();
+            if (address.rfind("unix:", 0) == 0) {
+                addresses.push_back(address);
+            } else {
+                std::cerr << "⚠️ 忽略无效的监听地址: " << address << std::endl;
+            }
+        }
+        return addresses;
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 Unix 域 socket 配置失败，不监听 Unix 域 socket: " << e.what() << std::endl;
+        return {};
+    }
+}
+
+int ConfigManager::getUnixSendBufferSize() const {
+    if (!config_loaded_) return 0;
+    
+    try {
+        return config_["server"].value("unix_send_buffer_size", 0);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 Unix 域 socket 发送缓冲区配置失败，使用默认值: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+int ConfigManager::getUnixRecvBufferSize() const {
+    if (!config_loaded_) return 0;
+    
+    try {
+        return config_["server"].value("unix_recv_buffer_size", 0);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 Unix 域 socket 接收缓冲区配置失败，使用默认值: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
 int ConfigManager::getThreadPoolSize() const {
     if (!config_loaded_) return 16;
     
@@ -57,6 +105,17 @@ int ConfigManager::getThreadPoolSize() const {
     }
 }
 
+int ConfigManager::getReactorThreads() const {
+    if (!config_loaded_) return 0;
+    
+    try {
+        return config_["server"].value("reactor_threads", 0);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取Reactor线程数配置失败，使用默认值: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
 int ConfigManager::getMaxConnections() const {
     if (!config_loaded_) return 1000;
     
@@ -68,6 +127,105 @@ int ConfigManager::getMaxConnections() const {
     }
 }
 
+int ConfigManager::getAcceptBatch() const {
+    if (!config_loaded_) return 64;
+    
+    try {
+        return config_["server"].value("accept_batch", 64);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取accept批量大小配置失败，使用默认值: " << e.what() << std::endl;
+        return 64;
+    }
+}
+
+int ConfigManager::getDeferAcceptSeconds() const {
+    if (!config_loaded_) return 0;
+    
+    try {
+        return config_["server"].value("defer_accept_seconds", 0);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取TCP_DEFER_ACCEPT配置失败，使用默认值: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+int ConfigManager::getHeaderTimeoutMs() const {
+    if (!config_loaded_) return 10000;
+    
+    try {
+        return config_["server"].value("header_timeout_ms", 10000);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取请求头超时配置失败，使用默认值: " << e.what() << std::endl;
+        return 10000;
+    }
+}
+
+int ConfigManager::getBodyTimeoutMs() const {
+    if (!config_loaded_) return 10000;
+    
+    try {
+        return config_["server"].value("body_timeout_ms", 10000);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取body超时配置失败，使用默认值: " << e.what() << std::endl;
+        return 10000;
+    }
+}
+
+int ConfigManager::getMinBodyRate() const {
+    if (!config_loaded_) return 1024;
+    
+    try {
+        return config_["server"].value("min_body_rate", 1024);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取body最低速率配置失败，使用默认值: " << e.what() << std::endl;
+        return 1024;
+    }
+}
+
+int ConfigManager::getKeepAliveTimeoutMs() const {
+    if (!config_loaded_) return 60000;
+    
+    try {
+        return config_["server"].value("keep_alive_timeout_ms", 60000);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取keep-alive超时配置失败，使用默认值: " << e.what() << std::endl;
+        return 60000;
+    }
+}
+
+int ConfigManager::getMaxHeaderSize() const {
+    if (!config_loaded_) return 16384;
+    
+    try {
+        return config_["server"].value("max_header_size", 16384);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取请求头大小上限配置失败，使用默认值: " << e.what() << std::endl;
+        return 16384;
+    }
+}
+
+std::string ConfigManager::getIOBackend() const {
+    if (!config_loaded_) return "epoll";
+    
+    try {
+        return config_["server"].value("io_backend", std::string("epoll"));
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取I/O后端配置失败，使用默认值: " << e.what() << std::endl;
+        return "epoll";
+    }
+}
+
+std::string ConfigManager::getHotRestartSocket() const {
+    if (!config_loaded_) return "";
+    
+    try {
+        return config_["server"].value("hot_restart_socket", std::string(""));
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取热重启socket配置失败，使用默认值: " << e.what() << std::endl;
+        return "";
+    }
+}
+
 std::string ConfigManager::getServerIP() const {
     if (!config_loaded_) return "127.0.0.1";
     
@@ -206,6 +364,142 @@ int ConfigManager::getOutputQuality() const {
     }
 }
 
+// 准入控制配置方法
+int ConfigManager::getAdmissionMaxQueuedTasks() const {
+    if (!config_loaded_ || !config_.contains("admission")) return 64;
+    
+    try {
+        return config_["admission"].value("max_queued_tasks", 64);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取最大排队任务数配置失败，使用默认值: " << e.what() << std::endl;
+        return 64;
+    }
+}
+
+long long ConfigManager::getAdmissionMaxInflightBytes() const {
+    if (!config_loaded_ || !config_.contains("admission")) return 268435456LL;
+    
+    try {
+        return config_["admission"].value("max_inflight_bytes", 268435456LL);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取最大在途字节数配置失败，使用默认值: " << e.what() << std::endl;
+        return 268435456LL;
+    }
+}
+
+int ConfigManager::getAdmissionMaxWorkUnits() const {
+    if (!config_loaded_ || !config_.contains("admission")) return 256;
+    
+    try {
+        return config_["admission"].value("max_work_units", 256);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取最大工作量配置失败，使用默认值: " << e.what() << std::endl;
+        return 256;
+    }
+}
+
+int ConfigManager::getAdmissionRetryAfterSeconds() const {
+    if (!config_loaded_ || !config_.contains("admission")) return 1;
+    
+    try {
+        return config_["admission"].value("retry_after_seconds", 1);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取Retry-After配置失败，使用默认值: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+// 流式响应配置方法
+bool ConfigManager::isStreamingEnabled() const {
+    if (!config_loaded_ || !config_.contains("streaming")) return true;
+    
+    try {
+        return config_["streaming"].value("enabled", true);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取流式响应开关配置失败，使用默认值: " << e.what() << std::endl;
+        return true;
+    }
+}
+
+int ConfigManager::getStreamingMinPixels() const {
+    if (!config_loaded_ || !config_.contains("streaming")) return 4000000;
+    
+    try {
+        return config_["streaming"].value("min_pixels", 4000000);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取流式响应像素阈值配置失败，使用默认值: " << e.what() << std::endl;
+        return 4000000;
+    }
+}
+
+int ConfigManager::getStreamingChunkSize() const {
+    if (!config_loaded_ || !config_.contains("streaming")) return 262144;
+    
+    try {
+        return config_["streaming"].value("chunk_size", 262144);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取流式响应分块大小配置失败，使用默认值: " << e.what() << std::endl;
+        return 262144;
+    }
+}
+
+// 批量接口配置方法
+int ConfigManager::getBatchMaxImages() const {
+    if (!config_loaded_ || !config_.contains("batch")) return 64;
+    
+    try {
+        return config_["batch"].value("max_images", 64);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取批量接口图像数上限配置失败，使用默认值: " << e.what() << std::endl;
+        return 64;
+    }
+}
+
+int ConfigManager::getBatchYOLOBatchSize() const {
+    if (!config_loaded_ || !config_.contains("batch")) return 8;
+    
+    try {
+        return config_["batch"].value("yolo_batch_size", 8);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取批量推理大小配置失败，使用默认值: " << e.what() << std::endl;
+        return 8;
+    }
+}
+
+// HTTP/2 (h2c) 配置方法
+bool ConfigManager::isHttp2Enabled() const {
+    if (!config_loaded_ || !config_.contains("http2")) return true;
+    
+    try {
+        return config_["http2"].value("enabled", true);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 HTTP/2 开关配置失败，使用默认值: " << e.what() << std::endl;
+        return true;
+    }
+}
+
+int ConfigManager::getHttp2MaxConcurrentStreams() const {
+    if (!config_loaded_ || !config_.contains("http2")) return 100;
+    
+    try {
+        return config_["http2"].value("max_concurrent_streams", 100);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 HTTP/2 并发流上限配置失败，使用默认值: " << e.what() << std::endl;
+        return 100;
+    }
+}
+
+int ConfigManager::getHttp2InitialWindowSize() const {
+    if (!config_loaded_ || !config_.contains("http2")) return 1048576;
+    
+    try {
+        return config_["http2"].value("initial_window_size", 1048576);
+    } catch (const std::exception& e) {
+        std::cerr << "⚠️ 读取 HTTP/2 流量控制窗口配置失败，使用默认值: " << e.what() << std::endl;
+        return 1048576;
+    }
+}
+
 // 日志配置方法
 std::string ConfigManager::getLogLevel() const {
     if (!config_loaded_) return "INFO";
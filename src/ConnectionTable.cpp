@@ -0,0 +1,43 @@
+#include "ConnectionTable.h"
+
+Connection& ConnectionTable::open(int fd) {
+    if (static_cast<size_t>(fd) >= _slots.size()) {
+        // 按 2 的倍数扩容，避免 fd 逐个增长时反复扩容
+        size_t capacity = _slots.empty() ? 1024 : _slots.size();
+        while (capacity <= static_cast<size_t>(fd)) capacity *= 2;
+        _slots.resize(capacity);
+    }
+
+    std::unique_ptr<Connection>& slot = _slots[fd];
+    if (!slot) {
+        slot = std::make_unique<Connection>();
+    }
+
+    Connection& conn = *slot;
+    conn.fd = fd;
+    conn.generation = (conn.generation + 1) & GENERATION_MASK;
+    conn.active = true;
+    conn.in_flight = false;
+    conn.handler.reset();
+    conn.keep_alive_after_write = true;
+    conn.streaming = false;
+    conn.lingering = false;
+    conn.lingered = 0;
+    conn.timeout = Connection::Timeout::NONE;
+    conn.body_checkpoint = 0;
+    conn.accepted_at = Connection::Clock::now();
+    conn.last_activity = conn.accepted_at;
+    return conn;
+}
+
+void ConnectionTable::release(int fd) {
+    Connection* conn = get(fd);
+    if (!conn) {
+        return;
+    }
+    conn->active = false;
+    conn->out_queue.clear();
+    conn->handler.reset();
+    // 丢弃未处理的数据，但保留解析器缓冲区供下一个连接复用
+    conn->parser.clear();
+}
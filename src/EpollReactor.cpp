@@ -0,0 +1,256 @@
+#include "EpollReactor.h"
+#include "Server.h"
+#include "Connection.h"
+#include "HttpResponse.h"
+#include "ConfigManager.h"
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+#include <Logger.h>
+
+
+// 支持百万级并发的配置
+constexpr int MAX_EVENTS = 10000;  // 增加单次epoll_wait处理的事件数
+constexpr size_t RECV_BUFFER_SIZE = 64 * 1024;  // Reactor 共用的接收缓冲区大小
+constexpr int MAX_IOV = 16;  // 单次 sendmsg 合并的最大 iovec 数
+
+EpollReactor::EpollReactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                           const std::vector<ListenSocket>& inherited)
+    : Reactor(id, server, addr, ports, inherited), _epoll_fd(-1),
+      _accept_batch(std::max(1, ConfigManager::getInstance().getAcceptBatch())),
+      _recv_buffer(RECV_BUFFER_SIZE) {
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Reactor " + std::to_string(_id) + " 无法创建 epoll 实例");
+    }
+
+    // 将所有监听socket添加到epoll
+    for (const ListenSocket& listener : _listeners) {
+        epoll_event event;
+        // Unix 域 socket 由所有 Reactor 共享，有新连接时只唤醒其中一个
+        event.events = listener.unix_address.empty() ? EPOLLIN : (EPOLLIN | EPOLLEXCLUSIVE);
+        event.data.u64 = LISTEN_TAG | static_cast<uint32_t>(listener.fd);
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, listener.fd, &event) == -1) {
+            throw std::runtime_error("无法将监听 socket " + std::to_string(listener.fd) + " 添加到 epoll");
+        }
+    }
+
+    // 线程池任务通过 eventfd 唤醒本 Reactor
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = WAKEUP_TAG;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &event) == -1) {
+        throw std::runtime_error("无法将 eventfd 添加到 epoll");
+    }
+}
+
+EpollReactor::~EpollReactor() {
+    if (_epoll_fd != -1) close(_epoll_fd);
+}
+
+void EpollReactor::run() {
+    std::vector<epoll_event> events(MAX_EVENTS);
+    while (!drained()) {
+        // 没有定时器时无限等待，否则最迟在下一个定时器到期时醒来
+        int timeout = _timers.next_timeout_ms(TimerWheel::Clock::now());
+        int n = epoll_wait(_epoll_fd, events.data(), MAX_EVENTS, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait 出错");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t tag = events[i].data.u64;
+            // 监听socket由最高位标记，无需遍历监听socket列表
+            if (tag & LISTEN_TAG) {
+                // 排空开始后监听socket已关闭，同一批事件中剩余的监听事件直接跳过
+                if (!_draining) {
+                    handle_new_connection(static_cast<int>(static_cast<uint32_t>(tag)));
+                }
+            } else if (tag & WAKEUP_TAG) {
+                uint64_t count;
+                while (read(_wakeup_fd, &count, sizeof(count)) > 0) {
+                }
+                run_pending_tasks();
+            } else {
+                // 客户端事件携带连接句柄，同一批事件中已关闭（或 fd 被复用）的连接直接跳过
+                Connection* conn = _connections.get_by_handle(tag);
+                if (!conn) {
+                    continue;
+                }
+                int fd = conn->fd;
+                // 先发送积压的响应，发送完成后连接可能恢复读取
+                if (events[i].events & EPOLLOUT) {
+                    handle_client_write(fd);
+                }
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                    handle_client_data(fd);
+                }
+            }
+        }
+
+        expire_timers();
+    }
+    LOG_INFO("Reactor " + std::to_string(_id) + " 已停止");
+}
+
+void EpollReactor::handle_new_connection(int listen_fd) {
+    int accepted = 0;
+    int rejected = 0;
+
+    // 监听socket为水平触发：每次最多接受 _accept_batch 个连接，剩余的留给下一轮，
+    // 避免连接风暴时长时间阻塞已有连接的读写
+    while (accepted + rejected < _accept_batch) {
+        // accept4 直接得到非阻塞 fd，省去 fcntl；客户端地址不再需要
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // 队列已取空，或其他 Reactor 已经取走了该连接
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept4 出错");
+            }
+            break;
+        }
+
+        Connection* conn = open_connection(client_fd, listen_fd);
+        if (!conn) {
+            ++rejected;
+            continue;
+        }
+
+        epoll_event event;
+        // 使用边缘触发，一次性注册读写事件，发送队列为空时忽略 EPOLLOUT，避免反复 epoll_ctl
+        event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        event.data.u64 = ConnectionTable::make_handle(*conn);
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client_fd, &event) == -1) {
+            perror("无法将客户端 socket 添加到 epoll");
+            release_connection(client_fd);
+            close(client_fd);
+            continue;
+        }
+        ++accepted;
+    }
+
+    if (rejected > 0) {
+        LOG_ERROR("Reactor " + std::to_string(_id) + " 达到最大连接数限制 (" + std::to_string(_max_connections)
+            + ")，拒绝 " + std::to_string(rejected) + " 个新连接");
+    }
+    if (accepted > 0) {
+        LOG_DEBUG("Reactor " + std::to_string(_id) + " 接受 " + std::to_string(accepted) + " 个新连接 (当前连接数: "
+            + std::to_string(_server.connection_counter().load()) + "/" + std::to_string(_max_connections) + ")");
+    }
+}
+
+void EpollReactor::handle_client_data(int client_fd) {
+    while (true) {
+        // 先分发已完整接收的请求（包括流水线中缓存的请求）
+        Connection* conn = dispatch_requests(client_fd);
+        if (!conn) {
+            return;
+        }
+
+        // 已进入 body 阶段时，readv 直接读入解析器的 body 缓冲区，
+        // 超出 Content-Length 的部分（下一个流水线请求）落入 Reactor 的接收缓冲区
+        std::pair<char*, size_t> window = conn->parser.body_window();
+        struct iovec iov[2];
+        int iov_count = 0;
+        if (window.second > 0) {
+            iov[iov_count].iov_base = window.first;
+            iov[iov_count].iov_len = window.second;
+            ++iov_count;
+        }
+        iov[iov_count].iov_base = _recv_buffer.data();
+        iov[iov_count].iov_len = _recv_buffer.size();
+        ++iov_count;
+
+        ssize_t bytes_read = readv(client_fd, iov, iov_count);
+        if (bytes_read == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // ET 模式下，数据已读完
+                update_timer(*conn);
+                return;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("recv 出错");
+            close_connection(client_fd);
+            return;
+        } else if (bytes_read == 0) {
+            // 客户端关闭连接
+            LOG_INFO("客户端 fd=" + std::to_string(client_fd) + " 断开连接");
+            close_connection(client_fd);
+            return;
+        }
+
+        size_t direct = std::min(static_cast<size_t>(bytes_read), window.second);
+        if (direct > 0) {
+            conn->last_activity = Connection::Clock::now();
+            conn->parser.commit_body(direct);
+        }
+        size_t buffered = static_cast<size_t>(bytes_read) - direct;
+        if (buffered > 0) {
+            receive(*conn, _recv_buffer.data(), buffered);
+        }
+    }
+}
+
+void EpollReactor::flush(Connection& conn) {
+    int fd = conn.fd;
+    while (!conn.out_queue.empty()) {
+        // 将队列中所有待发送的头部和响应体合并为一次 sendmsg
+        struct iovec iov[MAX_IOV];
+        int iov_count = fill_iovecs(conn, iov, MAX_IOV);
+
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 缓冲区满，等待 EPOLLOUT 后继续发送
+                update_timer(conn);
+                return;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "send失败: " << strerror(errno) << " (fd=" << fd << ")" << std::endl;
+            close_connection(fd);
+            return;
+        }
+        consume_sent(conn, static_cast<size_t>(sent));
+    }
+    // 响应已全部发出
+    write_complete(conn);
+}
+
+void EpollReactor::handle_client_write(int client_fd) {
+    Connection* conn = _connections.get(client_fd);
+    if (!conn || conn->out_queue.empty()) {
+        return;
+    }
+    flush(*conn);
+    handle_client_data(client_fd);
+}
+
+void EpollReactor::stop_accepting() {
+    for (const ListenSocket& listener : _listeners) {
+        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, listener.fd, nullptr);
+        close(listener.fd);
+    }
+}
+
+void EpollReactor::close_connection(int fd) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    release_connection(fd);
+    close(fd);
+}
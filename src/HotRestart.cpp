@@ -0,0 +1,288 @@
+#include "HotRestart.h"
+#include "UnixSocket.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <Logger.h>
+
+namespace {
+
+constexpr size_t MAX_FDS_PER_MESSAGE = 64;  // 单条消息携带的 fd 数，远低于内核的 SCM_MAX_FD
+constexpr int POLL_INTERVAL_MS = 500;       // 等待期间检查 stop() 的周期
+constexpr int HANDOFF_TIMEOUT_SEC = 10;     // 新进程等待旧进程回复的超时
+
+// 会话消息（SOCK_SEQPACKET 保留消息边界）
+const std::string MSG_FETCH = "FETCH";
+const std::string MSG_READY = "READY";
+const std::string MSG_DRAINING = "DRAINING";
+
+sockaddr_un make_address(const std::string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("热重启 socket 路径过长: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+bool send_message(int fd, const void* data, size_t len, const int* fds = nullptr, size_t fd_count = 0) {
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(data);
+    iov.iov_len = len;
+
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS_PER_MESSAGE)] = {};
+    if (fd_count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+    }
+    return sendmsg(fd, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(len);
+}
+
+// 接收一条消息及其携带的 fd（自动设置 FD_CLOEXEC）
+ssize_t recv_message(int fd, void* data, size_t len, std::vector<int>& fds) {
+    struct iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = len;
+
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_FDS_PER_MESSAGE)];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    if (n < 0) {
+        return n;
+    }
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* received = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            fds.insert(fds.end(), received, received + count);
+        }
+    }
+    if (msg.msg_flags & (MSG_CTRUNC | MSG_TRUNC)) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return n;
+}
+
+} // namespace
+
+HotRestart::HotRestart(const std::string& socket_path)
+    : _path(socket_path), _client_fd(-1), _listen_fd(-1), _stop(false) {}
+
+HotRestart::~HotRestart() {
+    stop();
+    if (_client_fd != -1) close(_client_fd);
+}
+
+std::vector<ListenSocket> HotRestart::fetch() {
+    sockaddr_un addr = make_address(_path);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        throw std::runtime_error("无法创建热重启 socket: " + std::string(strerror(errno)));
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("无法连接旧进程的热重启 socket " + _path + ": " + strerror(err));
+    }
+    timeval timeout = {HANDOFF_TIMEOUT_SEC, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::vector<ListenSocket> sockets;
+    std::vector<int> fds;
+    auto fail = [&](const std::string& reason) {
+        for (int received : fds) close(received);
+        close(fd);
+        throw std::runtime_error("从旧进程接管监听socket失败: " + reason);
+    };
+
+    if (!send_message(fd, MSG_FETCH.data(), MSG_FETCH.size())) {
+        fail(strerror(errno));
+    }
+
+    // 先收到总数，再按批收到 (端口, fd)：数据部分是端口数组，fd 在控制消息中一一对应
+    uint32_t total = 0;
+    if (recv_message(fd, &total, sizeof(total), fds) != sizeof(total) || !fds.empty()) {
+        fail("无效的应答");
+    }
+    while (sockets.size() < total) {
+        int32_t ports[MAX_FDS_PER_MESSAGE];
+        size_t first = fds.size();
+        ssize_t n = recv_message(fd, ports, sizeof(ports), fds);
+        if (n <= 0) {
+            fail(n == 0 ? "旧进程关闭了连接" : strerror(errno));
+        }
+        size_t count = fds.size() - first;
+        if (count == 0 || static_cast<size_t>(n) != count * sizeof(int32_t)) {
+            fail("端口与 fd 数量不一致");
+        }
+        for (size_t i = 0; i < count; ++i) {
+            // Unix 域 socket 的端口为 0，地址从 socket 本身取得
+            int listen_fd = fds[first + i];
+            sockets.push_back({ports[i], listen_fd, ports[i] == 0 ? unix_socket::local_address(listen_fd) : std::string()});
+        }
+    }
+
+    _client_fd = fd;
+    LOG_INFO("从旧进程接管 " + std::to_string(sockets.size()) + " 个监听socket");
+    return sockets;
+}
+
+void HotRestart::notify_ready() {
+    if (_client_fd == -1) {
+        return;
+    }
+    char reply[16];
+    std::vector<int> fds;
+    ssize_t n = -1;
+    if (send_message(_client_fd, MSG_READY.data(), MSG_READY.size())) {
+        n = recv_message(_client_fd, reply, sizeof(reply), fds);
+    }
+    for (int received : fds) close(received);
+
+    if (n > 0 && std::string(reply, n) == MSG_DRAINING) {
+        LOG_INFO("旧进程已停止接受连接，开始排空");
+    } else {
+        // 旧进程没有确认时两个进程会同时 accept，不影响服务
+        LOG_ERROR("旧进程未确认交接，请检查旧进程是否仍在运行");
+    }
+    close(_client_fd);
+    _client_fd = -1;
+}
+
+void HotRestart::serve(std::function<std::vector<ListenSocket>()> listeners, std::function<void()> on_handoff) {
+    sockaddr_un addr = make_address(_path);
+    _listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (_listen_fd == -1) {
+        throw std::runtime_error("无法创建热重启 socket: " + std::string(strerror(errno)));
+    }
+
+    // 旧进程在交接完成前已删除自己的 socket 文件，这里删除的只会是异常退出残留的文件
+    unlink(_path.c_str());
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(_listen_fd, 1) < 0) {
+        int err = errno;
+        close(_listen_fd);
+        _listen_fd = -1;
+        throw std::runtime_error("无法监听热重启 socket " + _path + ": " + strerror(err));
+    }
+    // 拿到监听 socket 即可冒充服务器，只允许同一用户连接
+    chmod(_path.c_str(), S_IRUSR | S_IWUSR);
+
+    _listeners = std::move(listeners);
+    _on_handoff = std::move(on_handoff);
+    _thread = std::thread([this] { serve_loop(); });
+    LOG_INFO("热重启 socket: " + _path + "，使用 -u 启动新进程即可无中断升级");
+}
+
+void HotRestart::stop() {
+    _stop = true;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (_listen_fd != -1) {
+        close(_listen_fd);
+        unlink(_path.c_str());
+        _listen_fd = -1;
+    }
+}
+
+void HotRestart::serve_loop() {
+    while (!_stop) {
+        pollfd pfd = {_listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+        int conn_fd = accept4(_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn_fd < 0) {
+            continue;
+        }
+        bool handed_off = handle_session(conn_fd);
+        close(conn_fd);
+        if (handed_off) {
+            return;
+        }
+    }
+}
+
+bool HotRestart::handle_session(int conn_fd) {
+    char request[16];
+    ssize_t n = wait_message(conn_fd, request, sizeof(request));
+    if (n <= 0 || std::string(request, n) != MSG_FETCH) {
+        return false;
+    }
+
+    std::vector<ListenSocket> sockets = _listeners();
+    uint32_t total = static_cast<uint32_t>(sockets.size());
+    if (!send_message(conn_fd, &total, sizeof(total))) {
+        LOG_ERROR("热重启: 发送监听socket失败: " + std::string(strerror(errno)));
+        return false;
+    }
+    for (size_t first = 0; first < sockets.size(); first += MAX_FDS_PER_MESSAGE) {
+        size_t count = std::min(MAX_FDS_PER_MESSAGE, sockets.size() - first);
+        int32_t ports[MAX_FDS_PER_MESSAGE];
+        int fds[MAX_FDS_PER_MESSAGE];
+        for (size_t i = 0; i < count; ++i) {
+            ports[i] = sockets[first + i].port;
+            fds[i] = sockets[first + i].fd;
+        }
+        if (!send_message(conn_fd, ports, count * sizeof(int32_t), fds, count)) {
+            LOG_ERROR("热重启: 发送监听socket失败: " + std::string(strerror(errno)));
+            return false;
+        }
+    }
+    LOG_INFO("热重启: 已向新进程发送 " + std::to_string(total) + " 个监听socket，等待其就绪");
+
+    // 新进程加载、预热模型期间本进程照常服务
+    n = wait_message(conn_fd, request, sizeof(request));
+    if (n <= 0 || std::string(request, n) != MSG_READY) {
+        LOG_ERROR("热重启: 新进程在就绪前退出，继续服务");
+        return false;
+    }
+
+    // 先删除 socket 文件再确认，新进程收到确认后才会创建自己的 socket 文件
+    _on_handoff();
+    close(_listen_fd);
+    unlink(_path.c_str());
+    _listen_fd = -1;
+    send_message(conn_fd, MSG_DRAINING.data(), MSG_DRAINING.size());
+    LOG_INFO("热重启: 新进程已就绪，停止接受连接并排空");
+    return true;
+}
+
+ssize_t HotRestart::wait_message(int conn_fd, char* buffer, size_t len) {
+    while (!_stop) {
+        pollfd pfd = {conn_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (ready > 0) {
+            std::vector<int> fds;
+            ssize_t n = recv_message(conn_fd, buffer, len, fds);
+            for (int received : fds) close(received);
+            return n;
+        }
+    }
+    return -1;
+}
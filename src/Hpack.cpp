@@ -0,0 +1,371 @@
+#include "Hpack.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// RFC 7541 附录 A
+const HpackHeader* static_table() {
+    static const HpackHeader table[HpackTable::STATIC_SIZE] = {
+        {":authority", ""}, {":method", "GET"}, {":method", "POST"}, {":path", "/"},
+        {":path", "/index.html"}, {":scheme", "http"}, {":scheme", "https"}, {":status", "200"},
+        {":status", "204"}, {":status", "206"}, {":status", "304"}, {":status", "400"},
+        {":status", "404"}, {":status", "500"}, {"accept-charset", ""}, {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""}, {"accept-ranges", ""}, {"accept", ""}, {"access-control-allow-origin", ""},
+        {"age", ""}, {"allow", ""}, {"authorization", ""}, {"cache-control", ""},
+        {"content-disposition", ""}, {"content-encoding", ""}, {"content-language", ""}, {"content-length", ""},
+        {"content-location", ""}, {"content-range", ""}, {"content-type", ""}, {"cookie", ""},
+        {"date", ""}, {"etag", ""}, {"expect", ""}, {"expires", ""},
+        {"from", ""}, {"host", ""}, {"if-match", ""}, {"if-modified-since", ""},
+        {"if-none-match", ""}, {"if-range", ""}, {"if-unmodified-since", ""}, {"last-modified", ""},
+        {"link", ""}, {"location", ""}, {"max-forwards", ""}, {"proxy-authenticate", ""},
+        {"proxy-authorization", ""}, {"range", ""}, {"referer", ""}, {"refresh", ""},
+        {"retry-after", ""}, {"server", ""}, {"set-cookie", ""}, {"strict-transport-security", ""},
+        {"transfer-encoding", ""}, {"user-agent", ""}, {"vary", ""}, {"via", ""},
+        {"www-authenticate", ""}
+    };
+    return table;
+}
+
+// RFC 7541 附录 B 中各符号（256 为 EOS）的码长；码字按（码长, 符号）顺序依次分配
+constexpr uint8_t HUFFMAN_LENGTHS[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+     6, 10, 10, 12, 13,  6,  8, 11, 10, 10,  8, 11,  8,  6,  6,  6,
+     5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  8, 15,  6, 12, 10,
+    13,  6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+     7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8, 13, 19, 13, 14,  6,
+    15,  5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,
+     6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30
+};
+constexpr int MAX_CODE_LENGTH = 30;
+constexpr uint16_t EOS = 256;
+
+struct HuffmanCode {
+    std::array<uint32_t, 257> codes;                      // 符号 -> 码字
+    std::array<uint16_t, 257> symbols;                    // 按（码长, 符号）排序
+    std::array<uint32_t, MAX_CODE_LENGTH + 1> first_code;  // 各码长的第一个码字
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> first_index; // 该码字在 symbols 中的位置
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> count;
+
+    HuffmanCode() : codes{}, symbols{}, first_code{}, first_index{}, count{} {
+        uint32_t code = 0;
+        uint16_t index = 0;
+        for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+            first_code[len] = code;
+            first_index[len] = index;
+            for (uint16_t sym = 0; sym <= EOS; ++sym) {
+                if (HUFFMAN_LENGTHS[sym] == len) {
+                    codes[sym] = code++;
+                    symbols[index++] = sym;
+                    ++count[len];
+                }
+            }
+            code <<= 1;
+        }
+    }
+};
+
+const HuffmanCode& huffman() {
+    static const HuffmanCode code;
+    return code;
+}
+
+bool decode_integer(const uint8_t*& p, const uint8_t* end, int prefix_bits, uint64_t& value) {
+    if (p == end) {
+        return false;
+    }
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    value = *p++ & max_prefix;
+    if (value < max_prefix) {
+        return true;
+    }
+    // 头部中的整数（索引、长度）不会超过 2^28，更长的编码视为格式错误
+    for (int shift = 0; shift <= 28; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        value += static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool decode_string(const uint8_t*& p, const uint8_t* end, std::string& out) {
+    if (p == end) {
+        return false;
+    }
+    bool huffman_encoded = (*p & 0x80) != 0;
+    uint64_t len;
+    if (!decode_integer(p, end, 7, len) || len > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+    out.clear();
+    bool ok = true;
+    if (huffman_encoded) {
+        ok = hpack::huffman_decode(p, static_cast<size_t>(len), out);
+    } else {
+        out.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(len));
+    }
+    p += len;
+    return ok;
+}
+
+} // namespace
+
+namespace hpack {
+
+void encode_integer(uint64_t value, int prefix_bits, uint8_t first_byte, std::string& out) {
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out.push_back(static_cast<char>(first_byte | value));
+        return;
+    }
+    out.push_back(static_cast<char>(first_byte | max_prefix));
+    value -= max_prefix;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void encode_string(std::string_view text, std::string& out) {
+    const HuffmanCode& code = huffman();
+    size_t bits = 0;
+    for (unsigned char c : text) {
+        bits += HUFFMAN_LENGTHS[c];
+    }
+    size_t huffman_len = (bits + 7) / 8;
+    if (huffman_len >= text.size()) {
+        encode_integer(text.size(), 7, 0x00, out);
+        out.append(text);
+        return;
+    }
+
+    encode_integer(huffman_len, 7, 0x80, out);
+    uint64_t acc = 0;
+    int pending = 0;
+    for (unsigned char c : text) {
+        acc = (acc << HUFFMAN_LENGTHS[c]) | code.codes[c];
+        pending += HUFFMAN_LENGTHS[c];
+        while (pending >= 8) {
+            pending -= 8;
+            out.push_back(static_cast<char>(acc >> pending));
+        }
+    }
+    if (pending > 0) {
+        // 用 EOS 的前缀（全 1）补齐最后一个字节
+        out.push_back(static_cast<char>((acc << (8 - pending)) | ((1u << (8 - pending)) - 1)));
+    }
+}
+
+bool huffman_decode(const uint8_t* data, size_t len, std::string& out) {
+    const HuffmanCode& code = huffman();
+    uint32_t current = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; ++i) {
+        for (int b = 7; b >= 0; --b) {
+            current = (current << 1) | ((data[i] >> b) & 1);
+            ++bits;
+            // 规范码：同一码长的码字连续，落在该码长的区间内即为一个完整符号
+            if (current - code.first_code[bits] < code.count[bits]) {
+                uint16_t sym = code.symbols[code.first_index[bits] + (current - code.first_code[bits])];
+                if (sym == EOS) {
+                    return false;
+                }
+                out.push_back(static_cast<char>(sym));
+                current = 0;
+                bits = 0;
+            } else if (bits == MAX_CODE_LENGTH) {
+                return false;
+            }
+        }
+    }
+    // 末尾的填充不超过 7 位且全为 1
+    return bits < 8 && current == (1u << bits) - 1;
+}
+
+} // namespace hpack
+
+const HpackHeader* HpackTable::get(size_t index) const {
+    if (index == 0) {
+        return nullptr;
+    }
+    if (index <= STATIC_SIZE) {
+        return &static_table()[index - 1];
+    }
+    index -= STATIC_SIZE + 1;
+    return index < _entries.size() ? &_entries[index] : nullptr;
+}
+
+size_t HpackTable::find(std::string_view name, std::string_view value, size_t& name_index) const {
+    name_index = 0;
+    const HpackHeader* table = static_table();
+    for (size_t i = 0; i < STATIC_SIZE; ++i) {
+        if (table[i].name == name) {
+            if (table[i].value == value) {
+                return i + 1;
+            }
+            if (name_index == 0) {
+                name_index = i + 1;
+            }
+        }
+    }
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        if (_entries[i].name == name) {
+            if (_entries[i].value == value) {
+                return STATIC_SIZE + 1 + i;
+            }
+            if (name_index == 0) {
+                name_index = STATIC_SIZE + 1 + i;
+            }
+        }
+    }
+    return 0;
+}
+
+void HpackTable::add(std::string_view name, std::string_view value) {
+    size_t entry_size = name.size() + value.size() + ENTRY_OVERHEAD;
+    if (entry_size > _max_size) {
+        // 比整个表还大的项清空表，自身也不加入
+        _entries.clear();
+        _size = 0;
+        return;
+    }
+    evict(entry_size);
+    _entries.push_front(HpackHeader{std::string(name), std::string(value)});
+    _size += entry_size;
+}
+
+void HpackTable::set_max_size(size_t max_size) {
+    _max_size = max_size;
+    evict(0);
+}
+
+void HpackTable::evict(size_t needed) {
+    while (!_entries.empty() && _size + needed > _max_size) {
+        const HpackHeader& oldest = _entries.back();
+        _size -= oldest.name.size() + oldest.value.size() + ENTRY_OVERHEAD;
+        _entries.pop_back();
+    }
+}
+
+HpackDecoder::HpackDecoder(size_t max_table_size) : _table(max_table_size), _settings_max(max_table_size) {}
+
+bool HpackDecoder::decode(const uint8_t* data, size_t len, size_t max_list_size, std::vector<HpackHeader>& headers,
+                          bool& oversized) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+    size_t list_size = 0;
+    bool field_seen = false;
+    oversized = false;
+    headers.clear();
+
+    while (p < end) {
+        uint8_t first = *p;
+        HpackHeader header;
+        if (first & 0x80) {
+            // 索引的头部
+            uint64_t index;
+            if (!decode_integer(p, end, 7, index)) {
+                return false;
+            }
+            const HpackHeader* entry = _table.get(static_cast<size_t>(index));
+            if (!entry) {
+                return false;
+            }
+            header = *entry;
+        } else if ((first & 0xe0) == 0x20) {
+            // 动态表大小更新，只能出现在头部块开头
+            uint64_t size;
+            if (field_seen || !decode_integer(p, end, 5, size) || size > _settings_max) {
+                return false;
+            }
+            _table.set_max_size(static_cast<size_t>(size));
+            continue;
+        } else {
+            // 字面量：带增量索引（01）、不索引（0000）或永不索引（0001）
+            bool incremental = (first & 0xc0) == 0x40;
+            uint64_t index;
+            if (!decode_integer(p, end, incremental ? 6 : 4, index)) {
+                return false;
+            }
+            if (index != 0) {
+                const HpackHeader* entry = _table.get(static_cast<size_t>(index));
+                if (!entry) {
+                    return false;
+                }
+                header.name = entry->name;
+            } else if (!decode_string(p, end, header.name)) {
+                return false;
+            }
+            if (!decode_string(p, end, header.value)) {
+                return false;
+            }
+            if (incremental) {
+                _table.add(header.name, header.value);
+            }
+        }
+        field_seen = true;
+
+        list_size += header.name.size() + header.value.size() + HpackTable::ENTRY_OVERHEAD;
+        if (list_size > max_list_size) {
+            oversized = true;
+            headers.clear();
+        }
+        if (!oversized) {
+            headers.push_back(std::move(header));
+        }
+    }
+    return true;
+}
+
+void HpackEncoder::set_max_table_size(size_t max_size) {
+    // 对端允许的范围内最多使用 4KB
+    size_t size = std::min<size_t>(max_size, 4096);
+    if (size != _table.max_size()) {
+        _table.set_max_size(size);
+        _pending_update = true;
+    }
+}
+
+bool HpackEncoder::indexable(std::string_view name) {
+    return name != "content-length" && name != "etag" && name != "set-cookie";
+}
+
+void HpackEncoder::encode(const std::vector<HpackHeader>& headers, std::string& out) {
+    if (_pending_update) {
+        hpack::encode_integer(_table.max_size(), 5, 0x20, out);
+        _pending_update = false;
+    }
+    for (const HpackHeader& header : headers) {
+        size_t name_index;
+        size_t index = _table.find(header.name, header.value, name_index);
+        if (index != 0) {
+            hpack::encode_integer(index, 7, 0x80, out);
+            continue;
+        }
+        bool incremental = indexable(header.name);
+        hpack::encode_integer(name_index, incremental ? 6 : 4, incremental ? 0x40 : 0x00, out);
+        if (name_index == 0) {
+            hpack::encode_string(header.name, out);
+        }
+        hpack::encode_string(header.value, out);
+        if (incremental) {
+            _table.add(header.name, header.value);
+        }
+    }
+}
@@ -0,0 +1,1102 @@
+#include "Http2Session.h"
+#include "Reactor.h"
+#include "HttpResponse.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr std::string_view CLIENT_PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr size_t PREFACE_TAIL = 6;  // "SM\r\n\r\n"，prior knowledge 时前面的部分已被当作请求头解析
+
+constexpr size_t FRAME_HEADER_SIZE = 9;
+constexpr uint32_t DEFAULT_WINDOW_SIZE = 65535;
+constexpr uint32_t DEFAULT_MAX_FRAME_SIZE = 16384;  // 本端不提高 SETTINGS_MAX_FRAME_SIZE
+constexpr int64_t MAX_WINDOW_SIZE = 0x7fffffff;
+constexpr size_t MAX_QUEUED_FRAMES = 4;  // 发送队列中最多积压的帧数，其余留在流中等待轮转
+// 对端不读取时发送队列的积压上限：PING/SETTINGS 的 ACK、RST_STREAM、WINDOW_UPDATE 等回复帧
+// 每帧都是一个响应对象，超出时以 ENHANCE_YOUR_CALM 断开
+constexpr size_t MAX_QUEUED_REPLIES = 256;
+// 一个连接上尚未分发的请求 body 合计最多占用 max_body_size 的倍数
+constexpr size_t BUFFERED_BODIES = 2;
+
+// 帧类型
+enum FrameType : uint8_t {
+    DATA = 0x0,
+    HEADERS = 0x1,
+    PRIORITY = 0x2,
+    RST_STREAM = 0x3,
+    SETTINGS = 0x4,
+    PUSH_PROMISE = 0x5,
+    PING = 0x6,
+    GOAWAY = 0x7,
+    WINDOW_UPDATE = 0x8,
+    CONTINUATION = 0x9
+};
+
+// 帧标志
+constexpr uint8_t FLAG_END_STREAM = 0x1;
+constexpr uint8_t FLAG_ACK = 0x1;
+constexpr uint8_t FLAG_END_HEADERS = 0x4;
+constexpr uint8_t FLAG_PADDED = 0x8;
+constexpr uint8_t FLAG_PRIORITY = 0x20;
+
+// 错误码
+enum ErrorCode : uint32_t {
+    NO_ERROR = 0x0,
+    PROTOCOL_ERROR = 0x1,
+    INTERNAL_ERROR = 0x2,
+    FLOW_CONTROL_ERROR = 0x3,
+    STREAM_CLOSED = 0x5,
+    FRAME_SIZE_ERROR = 0x6,
+    REFUSED_STREAM = 0x7,
+    COMPRESSION_ERROR = 0x9,
+    ENHANCE_YOUR_CALM = 0xb
+};
+
+// SETTINGS 参数
+enum SettingId : uint16_t {
+    SETTINGS_HEADER_TABLE_SIZE = 0x1,
+    SETTINGS_ENABLE_PUSH = 0x2,
+    SETTINGS_MAX_CONCURRENT_STREAMS = 0x3,
+    SETTINGS_INITIAL_WINDOW_SIZE = 0x4,
+    SETTINGS_MAX_FRAME_SIZE = 0x5,
+    SETTINGS_MAX_HEADER_LIST_SIZE = 0x6
+};
+
+uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+void append_be32(std::string& out, uint32_t value) {
+    for (int i = 3; i >= 0; --i) {
+        out.push_back(static_cast<char>(value >> (i * 8)));
+    }
+}
+
+void append_setting(std::string& out, uint16_t id, uint32_t value) {
+    out.push_back(static_cast<char>(id >> 8));
+    out.push_back(static_cast<char>(id));
+    append_be32(out, value);
+}
+
+std::string frame_header(size_t len, uint8_t type, uint8_t flags, uint32_t stream_id) {
+    std::string head;
+    head.push_back(static_cast<char>(len >> 16));
+    head.push_back(static_cast<char>(len >> 8));
+    head.push_back(static_cast<char>(len));
+    head.push_back(static_cast<char>(type));
+    head.push_back(static_cast<char>(flags));
+    append_be32(head, stream_id & 0x7fffffff);
+    return head;
+}
+
+// 连接级的头部不能出现在 HTTP/2 请求中（RFC 9113 8.2.2）
+bool is_connection_header(std::string_view name) {
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+        || name == "transfer-encoding" || name == "upgrade";
+}
+
+// 名称必须小写；名称和值都不能包含 CR、LF、NUL，否则转换为 HTTP/1.1 时会被拆成多个头部
+bool valid_field(const HpackHeader& header) {
+    if (header.name.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < header.name.size(); ++i) {
+        char c = header.name[i];
+        if ((c >= 'A' && c <= 'Z') || c == '\r' || c == '\n' || c == '\0' || (c == ':' && i > 0) || c == ' ') {
+            return false;
+        }
+    }
+    for (char c : header.value) {
+        if (c == '\r' || c == '\n' || c == '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// HTTP2-Settings 头部：base64url 编码，不带填充
+bool decode_base64url(std::string_view input, std::string& out) {
+    out.clear();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : input) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-' || c == '+') value = 62;
+        else if (c == '_' || c == '/') value = 63;
+        else if (c == '=') break;
+        else return false;
+        acc = (acc << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>(acc >> bits));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Http2Session::Http2Session(Reactor& reactor, uint64_t handle, const Limits& limits, bool upgraded)
+    : _reactor(reactor), _handle(handle), _fd(ConnectionTable::handle_fd(handle)), _limits(limits),
+      _preface_remaining(upgraded ? CLIENT_PREFACE.size() : PREFACE_TAIL), _settings_received(false),
+      _started(false), _continuation_stream(0), _header_block_end_stream(false), _last_stream_id(0),
+      _peer_initial_window(DEFAULT_WINDOW_SIZE), _peer_max_frame_size(DEFAULT_MAX_FRAME_SIZE),
+      _conn_send_window(DEFAULT_WINDOW_SIZE), _conn_recv_window(DEFAULT_WINDOW_SIZE), _conn_window_target(0),
+      _body_budget(limits.max_body_size * BUFFERED_BODIES), _body_reserved(0), _body_buffered(0),
+      _pumping(false), _going_away(false), _closed(false) {
+    _limits.initial_window_size = static_cast<uint32_t>(
+        std::min<int64_t>(std::max<uint32_t>(_limits.initial_window_size, DEFAULT_WINDOW_SIZE), MAX_WINDOW_SIZE));
+    _limits.max_concurrent_streams = std::max<uint32_t>(_limits.max_concurrent_streams, 1);
+    // 连接窗口足够所有流同时上传，实际补回的窗口还受 body 额度限制（conn_window_limit()）
+    _conn_window_target = std::min<int64_t>(static_cast<int64_t>(_limits.initial_window_size)
+                                            * _limits.max_concurrent_streams, MAX_WINDOW_SIZE);
+}
+
+bool Http2Session::decode_upgrade_settings(std::string_view header, std::string& payload) {
+    return decode_base64url(header, payload) && payload.size() % 6 == 0;
+}
+
+void Http2Session::start(const std::string& upgrade_settings, HttpParser* upgrade_request) {
+    // 服务端前言：SETTINGS，随后扩大连接级接收窗口
+    std::string settings;
+    append_setting(settings, SETTINGS_MAX_CONCURRENT_STREAMS, _limits.max_concurrent_streams);
+    append_setting(settings, SETTINGS_INITIAL_WINDOW_SIZE, _limits.initial_window_size);
+    append_setting(settings, SETTINGS_MAX_HEADER_LIST_SIZE, static_cast<uint32_t>(_limits.max_header_size));
+    send_frame(SETTINGS, 0, 0, settings);
+    int64_t window = conn_window_limit();
+    if (window > DEFAULT_WINDOW_SIZE) {
+        std::string increment;
+        append_be32(increment, static_cast<uint32_t>(window - DEFAULT_WINDOW_SIZE));
+        send_frame(WINDOW_UPDATE, 0, 0, increment);
+        _conn_recv_window = window;
+    }
+    _started = true;
+
+    // 升级请求的 HTTP2-Settings 等同于客户端的第一个 SETTINGS，不需要确认
+    if (!upgrade_settings.empty()
+        && !apply_settings(reinterpret_cast<const uint8_t*>(upgrade_settings.data()), upgrade_settings.size())) {
+        return;
+    }
+    if (upgrade_request) {
+        // 升级请求成为流 1（请求已完整接收，处于半关闭状态）
+        _last_stream_id = 1;
+        Stream* stream = open_stream(1);
+        stream->request_complete = true;
+        dispatch(*stream, *upgrade_request);
+        if (_closed) {
+            return;
+        }
+    }
+
+    // 接管之前已收到的数据（客户端前言和最初的几帧）
+    std::string pending;
+    pending.swap(_buffer);
+    if (!pending.empty()) {
+        process_input(pending.data(), pending.size());
+    }
+}
+
+bool Http2Session::on_data(const char* data, size_t len) {
+    if (_closed) {
+        return true;
+    }
+    if (!_started) {
+        // attach_handler 交来的数据先于 101 和服务端前言到达，start() 时再处理
+        _buffer.append(data, len);
+        return true;
+    }
+    process_input(data, len);
+    return true;
+}
+
+void Http2Session::process_input(const char* data, size_t len) {
+    const char* end = data + len;
+    // 连接前言逐字节比较，可能被任意切分
+    while (_preface_remaining > 0 && data < end) {
+        if (*data != CLIENT_PREFACE[CLIENT_PREFACE.size() - _preface_remaining]) {
+            LOG_INFO("HTTP/2 连接前言错误 fd=" + std::to_string(_fd));
+            connection_error(PROTOCOL_ERROR);
+            return;
+        }
+        ++data;
+        --_preface_remaining;
+    }
+
+    // 没有残留数据时直接在输入上解析，只把不完整的帧复制到 _buffer
+    std::string input;
+    if (!_buffer.empty()) {
+        _buffer.append(data, end - data);
+        input.swap(_buffer);
+        data = input.data();
+        end = data + input.size();
+    }
+    while (!_closed && static_cast<size_t>(end - data) >= FRAME_HEADER_SIZE) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+        size_t frame_len = (size_t(p[0]) << 16) | (size_t(p[1]) << 8) | size_t(p[2]);
+        if (frame_len > DEFAULT_MAX_FRAME_SIZE) {
+            connection_error(FRAME_SIZE_ERROR);
+            return;
+        }
+        if (static_cast<size_t>(end - data) < FRAME_HEADER_SIZE + frame_len) {
+            break;
+        }
+        if (_reactor.queued_responses(_handle) >= MAX_QUEUED_REPLIES) {
+            // 对端不断发送需要回复的帧（PING、SETTINGS、被拒绝的新流等）却不读取回复
+            LOG_INFO("HTTP/2 发送队列积压，断开 fd=" + std::to_string(_fd));
+            connection_error(ENHANCE_YOUR_CALM);
+            return;
+        }
+        uint32_t stream_id = read_be32(p + 5) & 0x7fffffff;
+        if (!process_frame(p[3], p[4], stream_id, p + FRAME_HEADER_SIZE, frame_len)) {
+            return;
+        }
+        data += FRAME_HEADER_SIZE + frame_len;
+    }
+    if (!_closed && data < end) {
+        _buffer.assign(data, end - data);
+    }
+    if (!_closed) {
+        // 流分发、出错或被取消后空出的额度，补回连接窗口
+        replenish(nullptr);
+    }
+}
+
+void Http2Session::on_close() {
+    _closed = true;
+    _streams.clear();
+    _tokens.clear();
+    _cancelled.clear();
+    _ready.clear();
+    _body_reserved = 0;
+    _body_buffered = 0;
+}
+
+bool Http2Session::on_drain() {
+    if (_closed) {
+        return false;
+    }
+    // 告知客户端不要再开新的流，已开始的流完成后关闭连接
+    go_away(NO_ERROR, _streams.empty());
+    return true;
+}
+
+void Http2Session::on_writable() {
+    pump();
+}
+
+bool Http2Session::process_frame(uint8_t type, uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len) {
+    if (!_settings_received && type != SETTINGS) {
+        // 客户端前言之后的第一帧必须是 SETTINGS
+        return connection_error(PROTOCOL_ERROR);
+    }
+    if (_continuation_stream != 0 && (type != CONTINUATION || stream_id != _continuation_stream)) {
+        // 头部块必须连续
+        return connection_error(PROTOCOL_ERROR);
+    }
+
+    switch (type) {
+        case DATA:
+            return on_data_frame(flags, stream_id, payload, len);
+        case HEADERS:
+            return on_headers_frame(flags, stream_id, payload, len);
+        case PRIORITY:
+            // 不支持优先级，只检查格式
+            if (stream_id == 0) {
+                return connection_error(PROTOCOL_ERROR);
+            }
+            if (len != 5) {
+                reset_stream(stream_id, FRAME_SIZE_ERROR);
+            }
+            return true;
+        case RST_STREAM:
+            return on_rst_stream(stream_id, len);
+        case SETTINGS:
+            if (stream_id != 0) {
+                return connection_error(PROTOCOL_ERROR);
+            }
+            return on_settings(flags, payload, len);
+        case PUSH_PROMISE:
+            // 客户端不能推送
+            return connection_error(PROTOCOL_ERROR);
+        case PING:
+            if (stream_id != 0) {
+                return connection_error(PROTOCOL_ERROR);
+            }
+            if (len != 8) {
+                return connection_error(FRAME_SIZE_ERROR);
+            }
+            if (!(flags & FLAG_ACK)) {
+                send_frame(PING, FLAG_ACK, 0, std::string_view(reinterpret_cast<const char*>(payload), len));
+            }
+            return true;
+        case GOAWAY:
+            if (stream_id != 0) {
+                return connection_error(PROTOCOL_ERROR);
+            }
+            // 客户端不再开新的流，已开始的流照常完成
+            _going_away = true;
+            if (_streams.empty()) {
+                go_away(NO_ERROR, true);
+            }
+            return true;
+        case WINDOW_UPDATE:
+            return on_window_update(stream_id, payload, len);
+        case CONTINUATION:
+            if (_continuation_stream == 0) {
+                return connection_error(PROTOCOL_ERROR);
+            }
+            _header_block.append(reinterpret_cast<const char*>(payload), len);
+            if (_header_block.size() > _limits.max_header_size * 2 + DEFAULT_MAX_FRAME_SIZE) {
+                // 头部块已远超上限，不再缓存
+                return connection_error(ENHANCE_YOUR_CALM);
+            }
+            if (flags & FLAG_END_HEADERS) {
+                return on_header_block(_continuation_stream, _header_block_end_stream);
+            }
+            return true;
+        default:
+            // 未知类型的帧忽略
+            return true;
+    }
+}
+
+bool Http2Session::on_headers_frame(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len) {
+    if (stream_id == 0) {
+        return connection_error(PROTOCOL_ERROR);
+    }
+    size_t pad = 0;
+    if (flags & FLAG_PADDED) {
+        if (len < 1) {
+            return connection_error(PROTOCOL_ERROR);
+        }
+        pad = payload[0];
+        ++payload;
+        --len;
+    }
+    if (flags & FLAG_PRIORITY) {
+        if (len < 5) {
+            return connection_error(PROTOCOL_ERROR);
+        }
+        payload += 5;
+        len -= 5;
+    }
+    if (pad > len) {
+        return connection_error(PROTOCOL_ERROR);
+    }
+    _header_block.assign(reinterpret_cast<const char*>(payload), len - pad);
+    _header_block_end_stream = (flags & FLAG_END_STREAM) != 0;
+    if (!(flags & FLAG_END_HEADERS)) {
+        _continuation_stream = stream_id;
+        return true;
+    }
+    return on_header_block(stream_id, _header_block_end_stream);
+}
+
+bool Http2Session::on_header_block(uint32_t stream_id, bool end_stream) {
+    _continuation_stream = 0;
+    std::vector<HpackHeader> headers;
+    bool oversized = false;
+    // 无论流的状态如何都要解码，保持动态表与客户端同步
+    bool decoded = _decoder.decode(reinterpret_cast<const uint8_t*>(_header_block.data()), _header_block.size(),
+                                   _limits.max_header_size, headers, oversized);
+    _header_block.clear();
+    if (!decoded) {
+        return connection_error(COMPRESSION_ERROR);
+    }
+
+    auto it = _streams.find(stream_id);
+    if (it != _streams.end()) {
+        // 已有的流上再次出现头部块：只能是结束请求的 trailer，内容忽略
+        Stream& stream = *it->second;
+        if (stream.request_complete) {
+            reset_stream(stream_id, STREAM_CLOSED);
+        } else if (!end_stream) {
+            reset_stream(stream_id, PROTOCOL_ERROR);
+        } else {
+            stream.request_complete = true;
+            finish_request(stream);
+        }
+        return true;
+    }
+    if (stream_id <= _last_stream_id) {
+        return connection_error(STREAM_CLOSED);
+    }
+    if (stream_id % 2 == 0) {
+        return connection_error(PROTOCOL_ERROR);
+    }
+    if (_going_away) {
+        // GOAWAY 之后的新流直接忽略
+        return true;
+    }
+    _last_stream_id = stream_id;
+    // 已取消但任务仍在执行的流照样占用线程池和准入额度，一并计入，
+    // 反复开流后立即 RST_STREAM 不能绕过并发上限
+    if (_streams.size() + _cancelled.size() >= _limits.max_concurrent_streams) {
+        reset_stream(stream_id, REFUSED_STREAM);
+        return true;
+    }
+
+    Stream* stream = open_stream(stream_id);
+    stream->request_complete = end_stream;
+    if (oversized) {
+        respond_error(*stream, 431);
+        return true;
+    }
+    if (!build_request(*stream, headers, end_stream)) {
+        reset_stream(stream_id, PROTOCOL_ERROR);
+    }
+    return true;
+}
+
+bool Http2Session::build_request(Stream& stream, const std::vector<HpackHeader>& headers, bool end_stream) {
+    std::string_view method, path, scheme, authority;
+    bool has_host = false;
+    bool has_content_length = false;
+    bool regular_seen = false;
+    std::string fields;
+    for (const HpackHeader& header : headers) {
+        if (!valid_field(header)) {
+            return false;
+        }
+        if (header.name[0] == ':') {
+            // 伪头部必须在普通头部之前，且每个只出现一次
+            std::string_view* target = nullptr;
+            if (header.name == ":method") target = &method;
+            else if (header.name == ":path") target = &path;
+            else if (header.name == ":scheme") target = &scheme;
+            else if (header.name == ":authority") target = &authority;
+            if (!target || regular_seen || !target->empty()) {
+                return false;
+            }
+            *target = header.value;
+            continue;
+        }
+        regular_seen = true;
+        if (is_connection_header(header.name) || (header.name == "te" && header.value != "trailers")) {
+            return false;
+        }
+        if (header.name == "expect") {
+            // body 已由流量控制约束，整个请求收齐后才分发，不需要 100 Continue
+            continue;
+        }
+        has_host = has_host || header.name == "host";
+        has_content_length = has_content_length || header.name == "content-length";
+        fields += header.name;
+        fields += ": ";
+        fields += header.value;
+        fields += "\r\n";
+    }
+    if (method.empty() || path.empty() || scheme.empty() || method == "CONNECT") {
+        return false;
+    }
+
+    // 转换为 HTTP/1.1 请求，沿用原有的解析和路由（HTTP/1.1 允许以 chunked 流式返回大图，
+    // 分块在这里转换为 DATA 帧）
+    std::string head;
+    head.reserve(method.size() + path.size() + authority.size() + fields.size() + 64);
+    head.append(method).append(" ").append(path).append(" HTTP/1.1\r\n");
+    if (!has_host && !authority.empty()) {
+        head.append("host: ").append(authority).append("\r\n");
+    }
+    head += fields;
+
+    stream.parser = std::make_unique<HttpParser>();
+    // 头部列表的大小已由 HPACK 解码时检查，这里只需容纳转换后的请求头和随后补上的 Content-Length
+    stream.parser->set_limits(head.size() + 64, _limits.max_body_size);
+    if (has_content_length || end_stream) {
+        // 长度已知：DATA 帧直接交给解析器，multipart 边接收边解析
+        if (!has_content_length) {
+            head += "content-length: 0\r\n";
+        }
+        head += "\r\n";
+        stream.body_known = true;
+        stream.parser->parse(head.data(), head.size());
+        if (stream.parser->has_error()) {
+            respond_error(stream, stream.parser->error_status());
+            return true;
+        }
+        // 按 Content-Length 占用额度，之后收到的 DATA 一定放得下；其他流已占满时拒绝，客户端可以重试
+        size_t content_length = stream.parser->content_length();
+        if (_body_reserved + content_length > _body_budget) {
+            reset_stream(stream.id, REFUSED_STREAM);
+            return true;
+        }
+        stream.body_reserved = content_length;
+        _body_reserved += content_length;
+    } else {
+        // 长度未知：缓存 body，收到 END_STREAM 后补上 Content-Length
+        stream.request_head = std::move(head);
+    }
+    if (end_stream) {
+        finish_request(stream);
+    }
+    return true;
+}
+
+bool Http2Session::on_data_frame(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len) {
+    if (stream_id == 0) {
+        return connection_error(PROTOCOL_ERROR);
+    }
+    // 流量控制按整个负载（包括填充）计算
+    if (static_cast<int64_t>(len) > _conn_recv_window) {
+        return connection_error(FLOW_CONTROL_ERROR);
+    }
+    _conn_recv_window -= static_cast<int64_t>(len);
+
+    const uint8_t* data = payload;
+    size_t data_len = len;
+    if (flags & FLAG_PADDED) {
+        if (len < 1 || payload[0] >= len) {
+            return connection_error(PROTOCOL_ERROR);
+        }
+        data = payload + 1;
+        data_len = len - 1 - payload[0];
+    }
+
+    auto it = _streams.find(stream_id);
+    if (it == _streams.end() || it->second->request_complete) {
+        replenish(nullptr);
+        if (stream_id > _last_stream_id) {
+            return connection_error(PROTOCOL_ERROR);
+        }
+        reset_stream(stream_id, STREAM_CLOSED);
+        return true;
+    }
+    Stream& stream = *it->second;
+    if (static_cast<int64_t>(len) > stream.recv_window) {
+        replenish(nullptr);
+        reset_stream(stream_id, FLOW_CONTROL_ERROR);
+        return true;
+    }
+    stream.recv_window -= static_cast<int64_t>(len);
+    stream.request_complete = (flags & FLAG_END_STREAM) != 0;
+
+    feed_body(stream, reinterpret_cast<const char*>(data), data_len);
+    // 数据已交给解析器（或被丢弃），窗口在额度允许的范围内补回；回复错误时流可能已被关闭
+    auto current = _streams.find(stream_id);
+    Stream* alive = current != _streams.end() ? current->second.get() : nullptr;
+    replenish(alive);
+    if (alive && alive->request_complete && !_closed) {
+        finish_request(*alive);
+    }
+    return true;
+}
+
+void Http2Session::feed_body(Stream& stream, const char* data, size_t len) {
+    if (!stream.parser || stream.dispatched) {
+        // 已回复错误，剩余的 body 丢弃
+        return;
+    }
+    if (stream.body_known) {
+        if (stream.body_received + len > stream.body_reserved) {
+            // DATA 的总长度超出 Content-Length（RFC 9113 8.1.1）
+            reset_stream(stream.id, PROTOCOL_ERROR);
+            return;
+        }
+        stream.body_received += len;
+        _body_buffered += len;
+        stream.parser->parse(data, len);
+        if (stream.parser->has_error()) {
+            respond_error(stream, stream.parser->error_status());
+        }
+        return;
+    }
+    if (stream.body.size() + len > _limits.max_body_size) {
+        respond_error(stream, 413);
+        return;
+    }
+    if (_body_reserved + len > _body_budget) {
+        // 其他流已占满额度，该流还没有交给 Server：拒绝，客户端可以重试
+        reset_stream(stream.id, REFUSED_STREAM);
+        return;
+    }
+    stream.body.insert(stream.body.end(), data, data + len);
+    stream.body_reserved += len;
+    stream.body_received += len;
+    _body_reserved += len;
+    _body_buffered += len;
+}
+
+void Http2Session::finish_request(Stream& stream) {
+    if (!stream.parser || stream.dispatched) {
+        // 已回复错误：响应发送完毕的流在这里关闭
+        if (stream.end_sent) {
+            close_stream(stream.id);
+        }
+        return;
+    }
+    HttpParser& parser = *stream.parser;
+    if (!stream.body_known) {
+        std::string& head = stream.request_head;
+        head += "content-length: " + std::to_string(stream.body.size()) + "\r\n\r\n";
+        parser.parse(head.data(), head.size());
+        if (!parser.has_error() && !stream.body.empty()) {
+            parser.parse(stream.body.data(), stream.body.size());
+        }
+        std::string().swap(head);
+        std::vector<char>().swap(stream.body);
+    }
+    if (parser.has_error()) {
+        respond_error(stream, parser.error_status());
+        return;
+    }
+    if (!parser.is_request_ready() || !parser.take_pipelined().empty()) {
+        // DATA 的总长度与 Content-Length 不符（RFC 9113 8.1.1）
+        reset_stream(stream.id, PROTOCOL_ERROR);
+        return;
+    }
+
+    // 解析器移出流：同步给出的响应可能在分发过程中就关闭了流
+    std::unique_ptr<HttpParser> owned = std::move(stream.parser);
+    dispatch(stream, *owned);
+}
+
+void Http2Session::dispatch(Stream& stream, HttpParser& parser) {
+    stream.dispatched = true;
+    // body 交给处理任务，之后由线程池的准入控制约束
+    release_body(stream);
+    _reactor.dispatch_stream(ConnectionTable::make_stream_handle(_fd, stream.token), parser);
+}
+
+void Http2Session::respond_error(Stream& stream, int status) {
+    stream.parser.reset();
+    stream.dispatched = true;
+    release_body(stream);
+    HttpResponse response(status, true);
+    response.set_content_type("text/plain");
+    response.set_body(std::string_view(status == 413 ? "Payload Too Large"
+                                       : status == 431 ? "Request Header Fields Too Large" : "Bad Request"));
+    handle_response(stream, std::move(response));
+}
+
+void Http2Session::release_body(Stream& stream) {
+    // 只记账，空出的连接窗口在本批输入处理完后由 process_input() 补回
+    _body_reserved -= stream.body_reserved;
+    _body_buffered -= stream.body_received;
+    stream.body_reserved = 0;
+    stream.body_received = 0;
+}
+
+int64_t Http2Session::conn_window_limit() const {
+    // 已持有的 body 加上对端还能发送的数据不超过额度，流量控制真正限制内存
+    int64_t free_budget = static_cast<int64_t>(_body_budget - std::min(_body_buffered, _body_budget));
+    return std::min(_conn_window_target, free_budget);
+}
+
+void Http2Session::replenish(Stream* stream) {
+    // 消耗超过一半时补回，避免每帧都发送 WINDOW_UPDATE
+    int64_t limit = conn_window_limit();
+    if (limit > _conn_recv_window && limit - _conn_recv_window >= limit / 2) {
+        std::string increment;
+        append_be32(increment, static_cast<uint32_t>(limit - _conn_recv_window));
+        send_frame(WINDOW_UPDATE, 0, 0, increment);
+        _conn_recv_window = limit;
+    }
+    int64_t initial = _limits.initial_window_size;
+    if (stream && !stream->request_complete && initial - stream->recv_window >= initial / 2) {
+        std::string increment;
+        append_be32(increment, static_cast<uint32_t>(initial - stream->recv_window));
+        send_frame(WINDOW_UPDATE, 0, stream->id, increment);
+        stream->recv_window = initial;
+    }
+}
+
+bool Http2Session::on_settings(uint8_t flags, const uint8_t* payload, size_t len) {
+    if (flags & FLAG_ACK) {
+        if (len != 0) {
+            return connection_error(FRAME_SIZE_ERROR);
+        }
+        return true;
+    }
+    if (len % 6 != 0) {
+        return connection_error(FRAME_SIZE_ERROR);
+    }
+    if (!apply_settings(payload, len)) {
+        return false;
+    }
+    _settings_received = true;
+    send_frame(SETTINGS, FLAG_ACK, 0, std::string_view());
+    pump();
+    return !_closed;
+}
+
+bool Http2Session::apply_settings(const uint8_t* payload, size_t len) {
+    for (size_t offset = 0; offset + 6 <= len; offset += 6) {
+        uint16_t id = static_cast<uint16_t>((payload[offset] << 8) | payload[offset + 1]);
+        uint32_t value = read_be32(payload + offset + 2);
+        switch (id) {
+            case SETTINGS_HEADER_TABLE_SIZE:
+                _encoder.set_max_table_size(value);
+                break;
+            case SETTINGS_ENABLE_PUSH:
+                if (value > 1) {
+                    return connection_error(PROTOCOL_ERROR);
+                }
+                break;
+            case SETTINGS_INITIAL_WINDOW_SIZE: {
+                if (value > MAX_WINDOW_SIZE) {
+                    return connection_error(FLOW_CONTROL_ERROR);
+                }
+                // 已打开的流按差值调整发送窗口（可能变为负数）
+                int64_t delta = static_cast<int64_t>(value) - _peer_initial_window;
+                for (auto& entry : _streams) {
+                    Stream& stream = *entry.second;
+                    stream.send_window += delta;
+                    if (stream.send_window > MAX_WINDOW_SIZE) {
+                        return connection_error(FLOW_CONTROL_ERROR);
+                    }
+                    if (delta > 0) {
+                        schedule(stream);
+                    }
+                }
+                _peer_initial_window = value;
+                break;
+            }
+            case SETTINGS_MAX_FRAME_SIZE:
+                if (value < DEFAULT_MAX_FRAME_SIZE || value > 0xffffff) {
+                    return connection_error(PROTOCOL_ERROR);
+                }
+                _peer_max_frame_size = value;
+                break;
+            default:
+                // MAX_CONCURRENT_STREAMS 只约束推送；MAX_HEADER_LIST_SIZE 与未知参数忽略
+                break;
+        }
+    }
+    return true;
+}
+
+bool Http2Session::on_window_update(uint32_t stream_id, const uint8_t* payload, size_t len) {
+    if (len != 4) {
+        return connection_error(FRAME_SIZE_ERROR);
+    }
+    uint32_t increment = read_be32(payload) & 0x7fffffff;
+    if (stream_id == 0) {
+        if (increment == 0) {
+            return connection_error(PROTOCOL_ERROR);
+        }
+        _conn_send_window += increment;
+        if (_conn_send_window > MAX_WINDOW_SIZE) {
+            return connection_error(FLOW_CONTROL_ERROR);
+        }
+        pump();
+        return !_closed;
+    }
+
+    auto it = _streams.find(stream_id);
+    if (it == _streams.end()) {
+        // 已关闭的流可能还会收到 WINDOW_UPDATE
+        return true;
+    }
+    Stream& stream = *it->second;
+    if (increment == 0) {
+        reset_stream(stream_id, PROTOCOL_ERROR);
+        return true;
+    }
+    stream.send_window += increment;
+    if (stream.send_window > MAX_WINDOW_SIZE) {
+        reset_stream(stream_id, FLOW_CONTROL_ERROR);
+        return true;
+    }
+    schedule(stream);
+    pump();
+    return !_closed;
+}
+
+bool Http2Session::on_rst_stream(uint32_t stream_id, size_t len) {
+    if (stream_id == 0 || stream_id > _last_stream_id) {
+        return connection_error(PROTOCOL_ERROR);
+    }
+    if (len != 4) {
+        return connection_error(FRAME_SIZE_ERROR);
+    }
+    // 客户端取消：流立即关闭，线程池任务完成后交来的响应因令牌失效而丢弃
+    close_stream(stream_id);
+    return true;
+}
+
+Http2Session::Stream* Http2Session::open_stream(uint32_t stream_id) {
+    auto stream = std::make_unique<Stream>();
+    stream->id = stream_id;
+    stream->token = _reactor.next_stream_token();
+    stream->recv_window = _limits.initial_window_size;
+    stream->send_window = _peer_initial_window;
+    Stream* raw = stream.get();
+    _tokens[stream->token] = stream_id;
+    _streams[stream_id] = std::move(stream);
+    return raw;
+}
+
+void Http2Session::on_response(uint32_t token, HttpResponse&& response) {
+    if (_closed) {
+        return;
+    }
+    auto token_it = _tokens.find(token);
+    if (token_it == _tokens.end()) {
+        // 流已被客户端取消或已重置；最后的响应交来说明任务已结束，不再占用并发数
+        bool finished = response.status() >= 200 ? !response.starts_stream() : response.ends_stream();
+        if (finished) {
+            _cancelled.erase(token);
+        }
+        return;
+    }
+    auto it = _streams.find(token_it->second);
+    if (it == _streams.end()) {
+        return;
+    }
+    handle_response(*it->second, std::move(response));
+}
+
+void Http2Session::handle_response(Stream& stream, HttpResponse response) {
+    if (stream.response_complete || (response.status() >= 100 && response.status() < 200)) {
+        // 临时响应不转发（请求收齐后才分发，不会有 100 Continue）
+        return;
+    }
+
+    if (response.status() != 0) {
+        // 响应头：普通响应的响应体随后按流量控制分帧；chunked 响应的分块陆续交来
+        response.finish();
+        auto owner = std::make_shared<const HttpResponse>(std::move(response));
+        bool streaming = owner->starts_stream();
+        std::string_view body = owner->body();
+        if (!streaming) {
+            stream.response_complete = true;
+            if (!body.empty()) {
+                stream.pending.push_back(Segment{owner, body});
+            }
+        }
+        bool end_stream = !streaming && body.empty();
+        send_headers(stream, *owner, end_stream);
+        if (end_stream) {
+            finish_stream(stream);
+            return;
+        }
+    } else if (response.ends_stream()) {
+        stream.response_complete = true;
+    } else {
+        auto owner = std::make_shared<const HttpResponse>(std::move(response));
+        std::string_view data = owner->chunk_data();
+        if (!data.empty()) {
+            stream.pending.push_back(Segment{owner, data});
+        }
+    }
+    schedule(stream);
+    pump();
+}
+
+void Http2Session::on_abort(uint32_t token) {
+    auto it = _tokens.find(token);
+    if (it != _tokens.end() && !_closed) {
+        reset_stream(it->second, INTERNAL_ERROR);
+    }
+    // 任务已结束
+    _cancelled.erase(token);
+}
+
+void Http2Session::send_headers(Stream& stream, const HttpResponse& response, bool end_stream) {
+    std::vector<HpackHeader> headers;
+    headers.push_back({":status", std::to_string(response.status())});
+
+    // 响应头按 HTTP/1.1 格式生成，逐行转换：名称改为小写，去掉连接级的头部
+    std::string_view head = response.header();
+    size_t pos = head.find("\r\n");
+    while (pos != std::string_view::npos) {
+        size_t line_start = pos + 2;
+        pos = head.find("\r\n", line_start);
+        if (pos == std::string_view::npos || pos == line_start) {
+            break;
+        }
+        std::string_view line = head.substr(line_start, pos - line_start);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string name(line.substr(0, colon));
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (is_connection_header(name)) {
+            continue;
+        }
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+        headers.push_back({std::move(name), std::string(value)});
+    }
+
+    std::string block;
+    _encoder.encode(headers, block);
+    stream.headers_sent = true;
+    stream.end_sent = end_stream;
+
+    // 响应头不超过 1KB，通常一帧即可；超过对端的帧大小时拆成 CONTINUATION
+    uint8_t end_flag = end_stream ? FLAG_END_STREAM : 0;
+    size_t offset = 0;
+    bool first = true;
+    do {
+        size_t n = std::min<size_t>(block.size() - offset, _peer_max_frame_size);
+        bool last = offset + n == block.size();
+        send_frame(first ? HEADERS : CONTINUATION,
+                   static_cast<uint8_t>((first ? end_flag : 0) | (last ? FLAG_END_HEADERS : 0)),
+                   stream.id, std::string_view(block).substr(offset, n));
+        offset += n;
+        first = false;
+    } while (offset < block.size());
+}
+
+void Http2Session::schedule(Stream& stream) {
+    bool has_work = !stream.pending.empty() || (stream.response_complete && stream.headers_sent && !stream.end_sent);
+    if (!stream.scheduled && has_work) {
+        stream.scheduled = true;
+        _ready.push_back(stream.id);
+    }
+}
+
+void Http2Session::pump() {
+    if (_pumping || _closed) {
+        return;
+    }
+    _pumping = true;
+    // 每次从队头取一个流写出一帧，还有数据的流排到队尾：各流的响应体交错发送，
+    // 先完成的小图不必等前面的大图发完
+    while (!_ready.empty() && !_closed) {
+        size_t queued = _reactor.queued_responses(_handle);
+        if (queued == SIZE_MAX || queued >= MAX_QUEUED_FRAMES) {
+            // 发送队列清空后 on_writable() 继续
+            break;
+        }
+        auto it = _streams.find(_ready.front());
+        if (it == _streams.end()) {
+            _ready.pop_front();
+            continue;
+        }
+        Stream& stream = *it->second;
+
+        if (stream.pending.empty()) {
+            // 所有数据已发出，chunked 响应的结束分块转换为空的 END_STREAM 帧
+            _ready.pop_front();
+            stream.scheduled = false;
+            if (stream.response_complete && stream.headers_sent && !stream.end_sent) {
+                stream.end_sent = true;
+                send_frame(DATA, FLAG_END_STREAM, stream.id, std::string_view());
+                if (!_closed) {
+                    finish_stream(stream);
+                }
+            }
+            continue;
+        }
+
+        if (_conn_send_window <= 0) {
+            // 连接窗口耗尽，等待 WINDOW_UPDATE；流保留在队头
+            break;
+        }
+        _ready.pop_front();
+        stream.scheduled = false;
+        if (stream.send_window <= 0) {
+            // 流的窗口耗尽，收到该流的 WINDOW_UPDATE 时重新排队
+            continue;
+        }
+
+        Segment& segment = stream.pending.front();
+        size_t n = static_cast<size_t>(std::min<int64_t>({static_cast<int64_t>(segment.data.size()), stream.send_window,
+                                                          _conn_send_window, _peer_max_frame_size}));
+        bool last = n == segment.data.size() && stream.pending.size() == 1 && stream.response_complete;
+        HttpResponse frame = HttpResponse::raw(frame_header(n, DATA, last ? FLAG_END_STREAM : 0, stream.id),
+                                               std::vector<char>(), true);
+        // 帧直接引用响应体，共享所有权保证发送完成前数据有效
+        frame.set_body_view(segment.data.data(), n, segment.owner);
+        segment.data.remove_prefix(n);
+        if (segment.data.empty()) {
+            stream.pending.pop_front();
+        }
+        stream.send_window -= static_cast<int64_t>(n);
+        _conn_send_window -= static_cast<int64_t>(n);
+        if (last) {
+            stream.end_sent = true;
+        }
+
+        uint32_t stream_id = stream.id;
+        _reactor.send_response(_fd, std::move(frame));
+        if (_closed) {
+            break;
+        }
+        auto current = _streams.find(stream_id);
+        if (current == _streams.end()) {
+            continue;
+        }
+        if (last) {
+            finish_stream(*current->second);
+        } else {
+            schedule(*current->second);
+        }
+    }
+    _pumping = false;
+}
+
+void Http2Session::finish_stream(Stream& stream) {
+    if (stream.request_complete) {
+        close_stream(stream.id);
+    } else {
+        // 请求还没收完就已回复（413 等）：告知客户端不必再发送
+        reset_stream(stream.id, NO_ERROR);
+    }
+}
+
+void Http2Session::reset_stream(uint32_t stream_id, uint32_t error) {
+    std::string payload;
+    append_be32(payload, error);
+    send_frame(RST_STREAM, 0, stream_id, payload);
+    close_stream(stream_id);
+}
+
+void Http2Session::close_stream(uint32_t stream_id) {
+    auto it = _streams.find(stream_id);
+    if (it == _streams.end()) {
+        return;
+    }
+    Stream& stream = *it->second;
+    release_body(stream);
+    if (stream.dispatched && !stream.response_complete) {
+        // 请求已交给 Server 但响应还没给完（客户端取消、协议错误等），任务结束前仍计入并发数
+        _cancelled.insert(stream.token);
+    }
+    _tokens.erase(stream.token);
+    _streams.erase(it);
+    if (_going_away && _streams.empty() && !_closed) {
+        // 排空或客户端 GOAWAY 之后最后一个流已完成
+        go_away(NO_ERROR, true);
+    }
+}
+
+void Http2Session::send_frame(uint8_t type, uint8_t flags, uint32_t stream_id, std::string_view payload,
+                              bool keep_alive) {
+    if (_closed || _reactor.queued_responses(_handle) == SIZE_MAX) {
+        return;
+    }
+    HttpResponse frame = HttpResponse::raw(frame_header(payload.size(), type, flags, stream_id),
+                                           std::vector<char>(payload.begin(), payload.end()), keep_alive);
+    _reactor.send_response(_fd, std::move(frame));
+}
+
+bool Http2Session::connection_error(uint32_t error) {
+    LOG_INFO("HTTP/2 连接错误 fd=" + std::to_string(_fd) + "，错误码 " + std::to_string(error));
+    go_away(error, true);
+    // 之后的数据和线程池交来的响应都丢弃，GOAWAY 发送完毕后关闭连接
+    on_close();
+    return false;
+}
+
+void Http2Session::go_away(uint32_t error, bool close_after) {
+    std::string payload;
+    append_be32(payload, _last_stream_id);
+    append_be32(payload, error);
+    _going_away = true;
+    send_frame(GOAWAY, 0, 0, payload, !close_after);
+}
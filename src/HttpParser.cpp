@@ -1,49 +1,124 @@
 #include "HttpParser.h"
+#include "Common.h"
 #include <iostream>
 #include <algorithm>
+#include <charconv>
 #include <cstring>
 
-HttpParser::HttpParser() : _state(ParseState::METHOD), _content_length(0) {}
+// 连接复用时保留的缓冲区容量上限，超过则释放（例如大图上传之后）
+constexpr size_t MAX_RETAINED_CAPACITY = 1 << 20;
+// body 中已初始化但尚未收到数据的部分：从 64KB 开始随已收数据翻倍，最多 1MB
+constexpr size_t MIN_BODY_WINDOW = 64 * 1024;
+constexpr size_t MAX_BODY_WINDOW = 1 << 20;
+
+HttpParser::HttpParser()
+    : _state(ParseState::METHOD), _body_received(0), _content_length(0),
+      _max_header_size(ImageServerDEF::MAX_HEADER_SIZE), _max_body_size(ImageServerDEF::MAX_IMAGE_SIZE),
+      _error_status(0), _expect_continue(false), _transfer_encoded(false) {}
+
+void HttpParser::set_limits(size_t max_header_size, size_t max_body_size) {
+    _max_header_size = max_header_size;
+    _max_body_size = max_body_size;
+}
+
+void HttpParser::clear() {
+    _pipelined.clear();
+    reset();
+    if (_body.capacity() > MAX_RETAINED_CAPACITY) {
+        std::vector<char>().swap(_body);
+    }
+    _multipart.release();
+}
 
 void HttpParser::reset() {
+    // 带 Transfer-Encoding 的请求之后的数据是未解码的 body，不能当作下一个请求解析
+    if (_transfer_encoded) {
+        _pipelined.clear();
+    }
     _state = ParseState::METHOD;
     _buffer.clear();
-    _method.clear();
-    _path.clear();
-    _headers.clear();
+    _head.clear();
     _body.clear();
+    _body_received = 0;
     _content_length = 0;
+    _error_status = 0;
+    _expect_continue = false;
+    _transfer_encoded = false;
     _boundary.clear();
-    _image_data.clear();
-    _filter_type.clear();
-    _image_uuid.clear();
-    _blur_intensity.clear();
-    _sharpen_intensity.clear();
+    _multipart.clear();
+
+    // 继续解析流水线中已收到的下一个请求
+    if (!_pipelined.empty()) {
+        std::string pending;
+        pending.swap(_pipelined);
+        parse(pending.data(), pending.size());
+    }
 }
 
 void HttpParser::parse(const char* data, size_t len) {
+    // 当前请求尚未处理完，后续数据属于下一个（流水线）请求，暂存到 reset() 时解析
+    if (_state == ParseState::COMPLETE) {
+        _pipelined.append(data, len);
+        return;
+    }
+    // 已决定拒绝的请求，连接即将关闭
+    if (_state == ParseState::ERROR) {
+        return;
+    }
+
     // 状态机：只要请求还未完成，就持续解析
     // 步骤1: 解析请求行和头部
-    if (_state != ParseState::BODY && _state != ParseState::COMPLETE) {
-        // 将新数据追加到内部缓冲区
+    if (_state != ParseState::BODY) {
+        // 将新数据追加到内部缓冲区，只需从上次结尾附近继续查找
+        size_t search_from = _buffer.size() > 3 ? _buffer.size() - 3 : 0;
         _buffer.append(data, len);
         
         // 查找头部结束标记 "\r\n\r\n"
-        size_t header_end_pos = _buffer.find("\r\n\r\n");
+        size_t header_end_pos = _buffer.find("\r\n\r\n", search_from);
+        if (header_end_pos == std::string::npos ? _buffer.size() > _max_header_size
+                                                : header_end_pos + 4 > _max_header_size) {
+            fail(431);
+            return;
+        }
         if (header_end_pos != std::string::npos) {
             // 解析所有头部信息
-            parse_headers();
+            if (!parse_headers(header_end_pos + 4)) {
+                fail(400);
+                return;
+            }
+
+            // 头部解析完即可拒绝过大的 body，不必等客户端发完
+            if (_content_length > _max_body_size) {
+                fail(413);
+                return;
+            }
             
-            // 将头部之后的数据移入 _body
-            std::string body_part = _buffer.substr(header_end_pos + 4);
-            if (!body_part.empty()) {
-                _body.assign(body_part.begin(), body_part.end());
+            // 头部之后的数据：前 Content-Length 字节属于 body，其余属于下一个请求
+            const char* rest = _buffer.data() + header_end_pos + 4;
+            size_t rest_len = _buffer.size() - header_end_pos - 4;
+            size_t body_len = std::min(rest_len, _content_length);
+            _body_received = 0;
+            if (!_boundary.empty()) {
+                // multipart 由解析器按 part 分配缓冲区
+                _multipart.reset(_boundary, _content_length);
+            } else {
+                // 按 Content-Length 预留容量（已受 max_body_size 限制），之后不再重新分配；
+                // 只预留地址空间，数据到达前不会占用物理内存
+                _body.reserve(_content_length);
             }
-            _buffer.clear(); // 清空缓冲区，因为它只用于暂存头部
+            append_body(rest, body_len);
+            if (rest_len > body_len) {
+                _pipelined.append(rest + body_len, rest_len - body_len);
+            }
+            // 只保留头部（缩小不会重新分配，_head 中的视图仍然有效）
+            _buffer.resize(header_end_pos + 4);
             
             // 检查是否需要进入BODY状态
             if (_content_length > 0) {
                 _state = ParseState::BODY;
+                // 客户端等待 100 Continue 后才发送 body（HTTP/1.0 不支持）
+                _expect_continue = _body_received < _content_length && _head.version == "HTTP/1.1"
+                    && HttpScanner::equals_ci(_head.header(HeaderId::EXPECT), "100-continue");
             } else {
                 // GET请求或没有body的请求，直接标记完成
                 _state = ParseState::COMPLETE;
@@ -51,163 +126,182 @@ void HttpParser::parse(const char* data, size_t len) {
         }
     } 
     // 步骤2: 如果已进入BODY状态，继续接收数据
-    else if (_state == ParseState::BODY) {
-        _body.insert(_body.end(), data, data + len);
+    else {
+        size_t body_len = std::min(len, _content_length - _body_received);
+        append_body(data, body_len);
+        if (len > body_len) {
+            _pipelined.append(data + body_len, len - body_len);
+        }
     }
 
     // 步骤3: 检查body是否接收完整
-    if (_state == ParseState::BODY && _content_length > 0 && _body.size() >= _content_length) {
-       // 确保body不多不少，丢弃可能存在的多余数据 (如流水线请求的下一部分)
-       _body.resize(_content_length); 
-       // 解析 multipart 格式的 body
-       parse_multipart_body();
-       _state = ParseState::COMPLETE; // 标记整个请求解析完成
-    }
+    check_body_complete();
 }
 
-
-void HttpParser::parse_headers() {
-    size_t line_end = 0;
-    size_t line_start = 0;
-
-    // 解析请求行 (例如 "POST /upload HTTP/1.1")
-    line_end = _buffer.find("\r\n");
-    if (line_end != std::string::npos) {
-        std::string request_line = _buffer.substr(0, line_end);
-        size_t method_end = request_line.find(' ');
-        if(method_end != std::string::npos) {
-            _method = request_line.substr(0, method_end);
-            size_t path_start = method_end + 1;
-            size_t path_end = request_line.find(' ', path_start);
-            if(path_end != std::string::npos) {
-                _path = request_line.substr(path_start, path_end - path_start);
-            }
-        }
-        line_start = line_end + 2;
+void HttpParser::grow_body(size_t min_size) {
+    if (_body.size() >= min_size) {
+        return;
     }
+    // 每次只初始化有限的一段，只发送请求头的连接不会让服务器按 Content-Length 提交内存
+    size_t window = std::clamp(_body_received, MIN_BODY_WINDOW, MAX_BODY_WINDOW);
+    size_t new_size = std::max(min_size, std::min(_content_length, _body_received + window));
+    _body.resize(new_size);
+}
 
-    // 循环解析每一个头部字段
-    while((line_end = _buffer.find("\r\n", line_start)) != std::string::npos) {
-        // 遇到空行，表示头部区域结束
-        if (line_end == line_start) { 
-            break;
-        }
-        std::string header_line = _buffer.substr(line_start, line_end - line_start);
-        size_t colon_pos = header_line.find(':');
-        if (colon_pos != std::string::npos) {
-            std::string key = header_line.substr(0, colon_pos);
-            // 跳过冒号和空格
-            std::string value = header_line.substr(colon_pos + 2); 
-            _headers[key] = value;
-        }
-        line_start = line_end + 2;
+void HttpParser::append_body(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    if (!_boundary.empty()) {
+        _multipart.feed(data, len);
+        _body_received += len;
+        return;
     }
+    grow_body(_body_received + len);
+    std::memcpy(_body.data() + _body_received, data, len);
+    _body_received += len;
+}
 
-    // 从头部中提取关键信息
-    if (_headers.count("Content-Length")) {
-        try {
-            _content_length = std::stoul(_headers["Content-Length"]);
-        } catch(const std::exception& e) {
-            _content_length = 0;
-        }
+std::pair<char*, size_t> HttpParser::body_window() {
+    if (_state != ParseState::BODY) {
+        return {nullptr, 0};
     }
-    if (_headers.count("Content-Type")) {
-        std::string content_type = _headers["Content-Type"];
-        size_t boundary_pos = content_type.find("boundary=");
-        if (boundary_pos != std::string::npos) {
-            // multipart 的边界字符串
-            _boundary = "--" + content_type.substr(boundary_pos + 9);
-        }
+    if (!_boundary.empty()) {
+        // 接收图片时直接指向图片缓冲区
+        return _multipart.window(_content_length - _body_received);
     }
+    if (_body_received == _body.size()) {
+        grow_body(_body_received + 1);
+    }
+    return {_body.data() + _body_received, _body.size() - _body_received};
 }
 
-void HttpParser::parse_multipart_body() {
-    if (_boundary.empty() || _body.empty()) return;
+void HttpParser::commit_body(size_t len) {
+    if (!_boundary.empty()) {
+        _multipart.commit(len);
+    }
+    _body_received += len;
+    check_body_complete();
+}
 
-    // 使用 char* 和 memmem 进行高效的二进制查找
-    const char* body_data = _body.data();
-    size_t body_size = _body.size();
-    const char* boundary_cstr = _boundary.c_str();
-    size_t boundary_len = _boundary.length();
+void HttpParser::fail(int status) {
+    _state = ParseState::ERROR;
+    _error_status = status;
+    _buffer.clear();
+    _pipelined.clear();
+}
 
-    const char* current_pos = body_data;
-    
-    // 循环查找每个 part
-    while(current_pos < body_data + body_size) {
-        const char* boundary_start = static_cast<const char*>(memmem(current_pos, (body_data + body_size) - current_pos, boundary_cstr, boundary_len));
-        
-        if (!boundary_start) break;
-        
-        // 查找下一个边界
-        const char* next_boundary_start = static_cast<const char*>(memmem(boundary_start + boundary_len, (body_data + body_size) - (boundary_start + boundary_len), boundary_cstr, boundary_len));
-        
-        if(!next_boundary_start) break;
+bool HttpParser::take_expect_continue() {
+    bool expect = _expect_continue && _state == ParseState::BODY;
+    _expect_continue = false;
+    return expect;
+}
 
-        // 提取一个 part 的内容 (不包括边界字符串)
-        const char* part_start = boundary_start + boundary_len;
-        // 跳过 boundary 后的 \r\n
-        if(part_start + 2 <= body_data + body_size && part_start[0] == '\r' && part_start[1] == '\n') {
-            part_start += 2;
-        }
-        
-        size_t part_len = next_boundary_start - part_start;
-        
-        // 查找 part 的头部和内容的分隔符 "\r\n\r\n"
-        const char* part_header_end = static_cast<const char*>(memmem(part_start, part_len, "\r\n\r\n", 4));
+void HttpParser::check_body_complete() {
+    if (_state == ParseState::BODY && _body_received >= _content_length) {
+       if (_boundary.empty()) {
+           _body.resize(_body_received);
+       }
+       _state = ParseState::COMPLETE; // 标记整个请求解析完成
+    }
+}
 
-        if (part_header_end) {
-            std::string part_header(part_start, part_header_end - part_start);
-            
-            const char* part_body_start = part_header_end + 4;
-            // part body 的长度要去掉结尾的 \r\n
-            size_t part_body_len = next_boundary_start - part_body_start - 2;
-
-            // 根据 part header 判断是图片还是滤镜类型
-            if (part_header.find("name=\"image\"") != std::string::npos) {
-                _image_data.assign(part_body_start, part_body_start + part_body_len);
-            } else if (part_header.find("name=\"filter\"") != std::string::npos) {
-                _filter_type.assign(part_body_start, part_body_len);
-            } else if (part_header.find("name=\"uuid\"") != std::string::npos) {
-                _image_uuid.assign(part_body_start, part_body_len);
-            } else if (part_header.find("name=\"blur_intensity\"") != std::string::npos) {
-                _blur_intensity.assign(part_body_start, part_body_len);
-            } else if (part_header.find("name=\"sharpen_intensity\"") != std::string::npos) {
-                _sharpen_intensity.assign(part_body_start, part_body_len);
-            }
+
+bool HttpParser::parse_headers(size_t head_len) {
+    // 请求行和请求头原地切分，字段都是指向 _buffer 的视图
+    if (!HttpScanner::parse(_buffer.data(), head_len, _head)) {
+        return false;
+    }
+
+    // 从头部中提取关键信息
+    std::string_view length = _head.header(HeaderId::CONTENT_LENGTH);
+    if (length.data() != nullptr) {
+        auto result = std::from_chars(length.data(), length.data() + length.size(), _content_length);
+        if (length.empty() || result.ec != std::errc() || result.ptr != length.data() + length.size()) {
+            return false;
+        }
+    }
+    // 同时带 Content-Length 和 Transfer-Encoding 时前后端可能按不同方式确定 body 边界（请求走私）
+    if (_head.find("Transfer-Encoding").data() != nullptr) {
+        if (length.data() != nullptr) {
+            return false;
+        }
+        _transfer_encoded = true;
+    }
+    std::string_view content_type = _head.header(HeaderId::CONTENT_TYPE);
+    size_t boundary_pos = content_type.find("boundary=");
+    if (boundary_pos != std::string_view::npos) {
+        // multipart 的边界字符串（可以带引号）
+        std::string_view boundary = content_type.substr(boundary_pos + 9);
+        boundary = boundary.substr(0, boundary.find(';'));
+        if (boundary.size() >= 2 && boundary.front() == '"' && boundary.back() == '"') {
+            boundary = boundary.substr(1, boundary.size() - 2);
         }
-        current_pos = next_boundary_start;
+        _boundary.assign(boundary.data(), boundary.size());
     }
+    return true;
 }
 
 bool HttpParser::is_request_ready() const {
     return _state == ParseState::COMPLETE;
 }
 
-std::string HttpParser::get_method() const {
-    return _method;
+bool HttpParser::keep_alive() const {
+    std::string_view connection = _head.header(HeaderId::CONNECTION);
+    if (HttpScanner::contains_ci(connection, "close")) {
+        return false;
+    }
+    if (HttpScanner::contains_ci(connection, "keep-alive")) {
+        return true;
+    }
+    // HTTP/1.1 默认持久连接，HTTP/1.0 默认关闭
+    return _head.version == "HTTP/1.1";
 }
 
-std::string HttpParser::get_path() const {
-    return _path;
+bool HttpParser::is_websocket_upgrade() const {
+    return _head.method == "GET" && _head.version == "HTTP/1.1"
+        && HttpScanner::contains_ci(_head.find("Upgrade"), "websocket")
+        && HttpScanner::contains_ci(_head.header(HeaderId::CONNECTION), "upgrade")
+        && !_head.find("Sec-WebSocket-Key").empty();
 }
 
-std::vector<char> HttpParser::get_image_data() const {
-    return _image_data;
+ImageServerDEF::ByteView HttpParser::get_image_data() const {
+    if (!_multipart.image_complete()) {
+        return ImageServerDEF::ByteView();
+    }
+    return ImageServerDEF::ByteView(_multipart.image());
 }
 
-std::string HttpParser::get_filter_type() const {
-    return _filter_type;
+std::vector<char> HttpParser::take_image() {
+    return _multipart.take_image();
 }
 
-std::string HttpParser::get_image_uuid() const {
-    return _image_uuid;
+std::string HttpParser::take_pipelined() {
+    std::string data;
+    data.swap(_pipelined);
+    return data;
 }
 
-std::string HttpParser::get_blur_intensity() const {
-    return _blur_intensity;
+std::string_view HttpParser::get_query() const {
+    size_t query_pos = _head.path.find('?');
+    if (query_pos == std::string_view::npos) {
+        return std::string_view();
+    }
+    return _head.path.substr(query_pos + 1);
 }
 
-std::string HttpParser::get_sharpen_intensity() const {
-    return _sharpen_intensity;
+ImageServerDEF::ByteView HttpParser::get_body() const {
+    if (_state != ParseState::COMPLETE || !_boundary.empty()) {
+        return ImageServerDEF::ByteView();
+    }
+    return ImageServerDEF::ByteView(_body);
 }
 
+std::vector<char> HttpParser::take_body() {
+    if (_state != ParseState::COMPLETE || !_boundary.empty()) {
+        return std::vector<char>();
+    }
+    std::vector<char> body = std::move(_body);
+    _body.clear();
+    return body;
+}
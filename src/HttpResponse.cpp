@@ -0,0 +1,216 @@
+#include "HttpResponse.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// 预先格式化的状态行和头部片段
+constexpr std::string_view STATUS_100 = "HTTP/1.1 100 Continue\r\n";
+constexpr std::string_view STATUS_101 = "HTTP/1.1 101 Switching Protocols\r\n";
+constexpr std::string_view STATUS_200 = "HTTP/1.1 200 OK\r\n";
+constexpr std::string_view STATUS_304 = "HTTP/1.1 304 Not Modified\r\n";
+constexpr std::string_view STATUS_400 = "HTTP/1.1 400 Bad Request\r\n";
+constexpr std::string_view STATUS_404 = "HTTP/1.1 404 Not Found\r\n";
+constexpr std::string_view STATUS_408 = "HTTP/1.1 408 Request Timeout\r\n";
+constexpr std::string_view STATUS_413 = "HTTP/1.1 413 Payload Too Large\r\n";
+constexpr std::string_view STATUS_415 = "HTTP/1.1 415 Unsupported Media Type\r\n";
+constexpr std::string_view STATUS_426 = "HTTP/1.1 426 Upgrade Required\r\n";
+constexpr std::string_view STATUS_431 = "HTTP/1.1 431 Request Header Fields Too Large\r\n";
+constexpr std::string_view STATUS_500 = "HTTP/1.1 500 Internal Server Error\r\n";
+constexpr std::string_view STATUS_501 = "HTTP/1.1 501 Not Implemented\r\n";
+constexpr std::string_view STATUS_503 = "HTTP/1.1 503 Service Unavailable\r\n";
+
+constexpr std::string_view CONTENT_TYPE = "Content-Type: ";
+constexpr std::string_view CONTENT_LENGTH = "Content-Length: ";
+constexpr std::string_view TRANSFER_ENCODING_CHUNKED = "Transfer-Encoding: chunked\r\n";
+constexpr std::string_view LAST_CHUNK = "0\r\n\r\n";
+constexpr std::string_view CONNECTION_KEEP_ALIVE = "Connection: keep-alive\r\n";
+constexpr std::string_view CONNECTION_CLOSE = "Connection: close\r\n";
+constexpr std::string_view CRLF = "\r\n";
+
+std::string_view status_line(int status) {
+    switch (status) {
+        case 100: return STATUS_100;
+        case 101: return STATUS_101;
+        case 200: return STATUS_200;
+        case 304: return STATUS_304;
+        case 400: return STATUS_400;
+        case 404: return STATUS_404;
+        case 408: return STATUS_408;
+        case 413: return STATUS_413;
+        case 415: return STATUS_415;
+        case 426: return STATUS_426;
+        case 431: return STATUS_431;
+        case 500: return STATUS_500;
+        case 501: return STATUS_501;
+        case 503: return STATUS_503;
+        default:  return {};
+    }
+}
+
+} // namespace
+
+HttpResponse::HttpResponse(int status, bool keep_alive)
+    : _status(status), _keep_alive(keep_alive), _finished(false), _chunked(false), _last_chunk(false),
+      _header_len(0), _body_data(nullptr), _body_len(0), _trailer(), _sent(0) {
+    std::string_view line = status_line(status);
+    if (!line.empty()) {
+        append(line);
+    } else {
+        // 不常用的状态码，按格式现场生成
+        char code[8];
+        auto result = std::to_chars(code, code + sizeof(code), status);
+        append("HTTP/1.1 ");
+        append(std::string_view(code, result.ptr - code));
+        append(" \r\n");
+    }
+}
+
+HttpResponse::HttpResponse(ChunkTag, bool keep_alive)
+    : _status(0), _keep_alive(keep_alive), _finished(true), _chunked(false), _last_chunk(false),
+      _header_len(0), _body_data(nullptr), _body_len(0), _trailer(), _sent(0) {}
+
+HttpResponse HttpResponse::chunk(std::vector<char> data) {
+    HttpResponse piece(ChunkTag{}, true);
+    char size[24];
+    auto result = std::to_chars(size, size + sizeof(size), data.size(), 16);
+    piece.append(std::string_view(size, result.ptr - size));
+    piece.append(CRLF);
+    piece._body = std::move(data);
+    piece._body_data = piece._body.data();
+    piece._body_len = piece._body.size();
+    // 结尾的 CRLF 引用静态数据作为第三个 iovec，不改动接管的数据
+    piece._trailer = CRLF;
+    return piece;
+}
+
+HttpResponse HttpResponse::last_chunk(bool keep_alive) {
+    HttpResponse piece(ChunkTag{}, keep_alive);
+    piece.append(LAST_CHUNK);
+    piece._last_chunk = true;
+    return piece;
+}
+
+HttpResponse HttpResponse::raw(std::string_view head, std::vector<char> data, bool keep_alive) {
+    HttpResponse piece(ChunkTag{}, keep_alive);
+    piece.append(head);
+    piece._body = std::move(data);
+    piece._body_data = piece._body.data();
+    piece._body_len = piece._body.size();
+    return piece;
+}
+
+void HttpResponse::append(std::string_view text) {
+    if (_header_len + text.size() > HEADER_CAPACITY) {
+        throw std::runtime_error("HTTP响应头超出缓冲区大小");
+    }
+    std::memcpy(_header + _header_len, text.data(), text.size());
+    _header_len += text.size();
+}
+
+HttpResponse& HttpResponse::set_content_type(std::string_view content_type) {
+    append(CONTENT_TYPE);
+    append(content_type);
+    append(CRLF);
+    return *this;
+}
+
+HttpResponse& HttpResponse::add_header(std::string_view name, std::string_view value) {
+    append(name);
+    append(": ");
+    append(value);
+    append(CRLF);
+    return *this;
+}
+
+HttpResponse& HttpResponse::set_body(std::vector<char> body) {
+    _body = std::move(body);
+    _body_owner.reset();
+    _body_data = _body.data();
+    _body_len = _body.size();
+    return *this;
+}
+
+HttpResponse& HttpResponse::set_body(std::string_view text) {
+    return set_body(std::vector<char>(text.begin(), text.end()));
+}
+
+HttpResponse& HttpResponse::set_body_view(const char* data, size_t len, std::shared_ptr<const void> owner) {
+    _body.clear();
+    _body_owner = std::move(owner);
+    _body_data = data;
+    _body_len = len;
+    return *this;
+}
+
+HttpResponse& HttpResponse::set_keep_alive(bool keep_alive) {
+    if (!_finished) {
+        _keep_alive = keep_alive;
+    }
+    return *this;
+}
+
+HttpResponse& HttpResponse::set_chunked() {
+    _chunked = true;
+    return *this;
+}
+
+void HttpResponse::finish() {
+    if (_finished) {
+        return;
+    }
+    if (_status >= 100 && _status < 200) {
+        // 临时响应只有状态行，之后还会发送最终响应
+        append(CRLF);
+        _finished = true;
+        return;
+    }
+    if (_chunked) {
+        append(TRANSFER_ENCODING_CHUNKED);
+    } else if (_status != 304) {
+        // 304 不携带响应体，也不发送 Content-Length
+        char length[24];
+        auto result = std::to_chars(length, length + sizeof(length), _body_len);
+        append(CONTENT_LENGTH);
+        append(std::string_view(length, result.ptr - length));
+        append(CRLF);
+    }
+    append(_keep_alive ? CONNECTION_KEEP_ALIVE : CONNECTION_CLOSE);
+    append(CRLF);
+    _finished = true;
+}
+
+int HttpResponse::fill_iovec(struct iovec* iov, int max_iov) const {
+    int count = 0;
+    if (count < max_iov && _sent < _header_len) {
+        iov[count].iov_base = const_cast<char*>(_header + _sent);
+        iov[count].iov_len = _header_len - _sent;
+        ++count;
+    }
+    if (count < max_iov && _body_len > 0) {
+        size_t body_sent = _sent > _header_len ? _sent - _header_len : 0;
+        if (body_sent < _body_len) {
+            iov[count].iov_base = const_cast<char*>(_body_data + body_sent);
+            iov[count].iov_len = _body_len - body_sent;
+            ++count;
+        }
+    }
+    if (count < max_iov && !_trailer.empty()) {
+        size_t trailer_start = _header_len + _body_len;
+        size_t trailer_sent = _sent > trailer_start ? _sent - trailer_start : 0;
+        if (trailer_sent < _trailer.size()) {
+            iov[count].iov_base = const_cast<char*>(_trailer.data() + trailer_sent);
+            iov[count].iov_len = _trailer.size() - trailer_sent;
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t HttpResponse::consume(size_t bytes) {
+    size_t used = std::min(bytes, total_size() - _sent);
+    _sent += used;
+    return used;
+}
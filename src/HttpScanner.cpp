@@ -0,0 +1,308 @@
+#include "HttpScanner.h"
+#include <cstring>
+#include <initializer_list>
+#include <strings.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HTTP_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 字段结束字节的集合：
+// - 成对的闭区间 [lo, hi]，补齐到 16 字节供 pcmpestri 直接加载
+// - 同一集合的另一种表示供 AVX2 使用：不大于 max_ctl 的字节（例外 except_byte），外加至多两个单独的字节
+// - 逐字节比较时查表
+struct Ranges {
+    alignas(16) char bytes[16];
+    int len;
+    bool stop[256];
+    char max_ctl;
+    int except_byte;  // -1 表示没有例外
+    char extra[2];    // 不足两个时重复填写
+};
+
+Ranges make_ranges(std::initializer_list<char> pairs, char max_ctl, int except_byte, char extra0, char extra1) {
+    Ranges ranges = {};
+    ranges.len = 0;
+    for (char c : pairs) {
+        ranges.bytes[ranges.len++] = c;
+    }
+    for (int i = 0; i < ranges.len; i += 2) {
+        for (int c = static_cast<unsigned char>(ranges.bytes[i]); c <= static_cast<unsigned char>(ranges.bytes[i + 1]); ++c) {
+            ranges.stop[c] = true;
+        }
+    }
+    ranges.max_ctl = max_ctl;
+    ranges.except_byte = except_byte;
+    ranges.extra[0] = extra0;
+    ranges.extra[1] = extra1;
+    return ranges;
+}
+
+// 请求行中的 token 和路径：遇到空格、控制字符或 DEL 结束
+const Ranges TOKEN_END = make_ranges({'\x00', ' ', '\x7f', '\x7f'}, ' ', -1, '\x7f', '\x7f');
+// 头部名称：遇到冒号、空格或控制字符结束
+const Ranges NAME_END = make_ranges({'\x00', ' ', ':', ':', '\x7f', '\x7f'}, ' ', -1, ':', '\x7f');
+// 头部值：遇到除 HTAB 以外的控制字符结束（正常情况下是 '\r'），允许 obs-text
+const Ranges VALUE_END = make_ranges({'\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'}, '\x1f', '\t', '\x7f', '\x7f');
+
+const char* find_scalar(const char* p, const char* end, const Ranges& ranges) {
+    while (p < end && !ranges.stop[static_cast<unsigned char>(*p)]) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef HTTP_SCANNER_X86
+__attribute__((target("sse4.2")))
+const char* find_sse42(const char* p, const char* end, const Ranges& ranges) {
+    __m128i table = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges.bytes));
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int index = _mm_cmpestri(table, ranges.len, block, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index != 16) {
+            return p + index;
+        }
+        p += 16;
+    }
+    return find_scalar(p, end, ranges);
+}
+
+__attribute__((target("avx2")))
+const char* find_avx2(const char* p, const char* end, const Ranges& ranges) {
+    // x <= max_ctl 等价于 min(x, max_ctl) == x（无符号）
+    const __m256i max_ctl = _mm256_set1_epi8(ranges.max_ctl);
+    const __m256i extra0 = _mm256_set1_epi8(ranges.extra[0]);
+    const __m256i extra1 = _mm256_set1_epi8(ranges.extra[1]);
+    const __m256i except_byte = _mm256_set1_epi8(static_cast<char>(ranges.except_byte));
+    const bool has_except = ranges.except_byte >= 0;
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(block, max_ctl), block);
+        if (has_except) {
+            ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(block, except_byte), ctl);
+        }
+        __m256i hit = _mm256_or_si256(ctl, _mm256_or_si256(_mm256_cmpeq_epi8(block, extra0),
+                                                           _mm256_cmpeq_epi8(block, extra1)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    // 剩余部分按 16 字节比较
+    return find_sse42(p, end, ranges);
+}
+#endif
+
+using FindFn = const char* (*)(const char*, const char*, const Ranges&);
+
+struct Implementation {
+    HttpScanner::Backend backend;
+    FindFn find;
+};
+
+bool cpu_supports(HttpScanner::Backend backend) {
+#ifdef HTTP_SCANNER_X86
+    __builtin_cpu_init();
+    switch (backend) {
+        case HttpScanner::Backend::AVX2:  return __builtin_cpu_supports("avx2");
+        case HttpScanner::Backend::SSE42: return __builtin_cpu_supports("sse4.2");
+        case HttpScanner::Backend::SCALAR: return true;
+    }
+    return false;
+#else
+    return backend == HttpScanner::Backend::SCALAR;
+#endif
+}
+
+Implementation make_implementation(HttpScanner::Backend backend) {
+    switch (backend) {
+#ifdef HTTP_SCANNER_X86
+        case HttpScanner::Backend::AVX2:  return {backend, find_avx2};
+        case HttpScanner::Backend::SSE42: return {backend, find_sse42};
+#endif
+        default: return {HttpScanner::Backend::SCALAR, find_scalar};
+    }
+}
+
+Implementation detect() {
+    for (HttpScanner::Backend backend : {HttpScanner::Backend::AVX2, HttpScanner::Backend::SSE42}) {
+        if (cpu_supports(backend)) {
+            return make_implementation(backend);
+        }
+    }
+    return make_implementation(HttpScanner::Backend::SCALAR);
+}
+
+Implementation g_impl = detect();
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+} // namespace
+
+void RequestHead::clear() {
+    method = std::string_view();
+    path = std::string_view();
+    version = std::string_view();
+    known.fill(std::string_view());
+    headers.clear();
+}
+
+std::string_view RequestHead::find(std::string_view name) const {
+    HeaderId id = HttpScanner::lookup(name);
+    if (id != HeaderId::COUNT) {
+        return header(id);
+    }
+    for (const HttpHeader& field : headers) {
+        if (HttpScanner::equals_ci(field.name, name)) {
+            return field.value;
+        }
+    }
+    return std::string_view();
+}
+
+bool HttpScanner::parse(const char* data, size_t len, RequestHead& head) {
+    head.clear();
+    const char* p = data;
+    const char* end = data + len;
+    FindFn find = g_impl.find;
+
+    // 请求行: METHOD SP PATH SP VERSION CRLF
+    const char* method_end = find(p, end, TOKEN_END);
+    if (method_end == p || method_end == end || *method_end != ' ') {
+        return false;
+    }
+    head.method = std::string_view(p, method_end - p);
+
+    p = method_end + 1;
+    const char* path_end = find(p, end, TOKEN_END);
+    if (path_end == p || path_end == end || *path_end != ' ') {
+        return false;
+    }
+    head.path = std::string_view(p, path_end - p);
+
+    p = path_end + 1;
+    const char* version_end = find(p, end, TOKEN_END);
+    if (end - version_end < 2 || version_end[0] != '\r' || version_end[1] != '\n') {
+        return false;
+    }
+    head.version = std::string_view(p, version_end - p);
+    if (head.version.substr(0, 5) != "HTTP/") {
+        return false;
+    }
+    p = version_end + 2;
+
+    // 请求头: NAME ":" OWS VALUE OWS CRLF，直到空行
+    while (true) {
+        if (end - p < 2) {
+            return false;
+        }
+        if (p[0] == '\r' && p[1] == '\n') {
+            return p + 2 == end;
+        }
+
+        // 名称中不能有空白（包括以空白开头的折叠行）
+        const char* name_end = find(p, end, NAME_END);
+        if (name_end == p || name_end == end || *name_end != ':') {
+            return false;
+        }
+        std::string_view name(p, name_end - p);
+
+        const char* value = name_end + 1;
+        while (value < end && is_space(*value)) {
+            ++value;
+        }
+        const char* value_end = find(value, end, VALUE_END);
+        if (end - value_end < 2 || value_end[0] != '\r' || value_end[1] != '\n') {
+            return false;
+        }
+        const char* trimmed = value_end;
+        while (trimmed > value && is_space(trimmed[-1])) {
+            --trimmed;
+        }
+        // 值为空时 data() 仍指向原始数据，可以区分"存在但为空"和"不存在"
+        std::string_view field_value(value, trimmed - value);
+
+        HeaderId id = lookup(name);
+        if (id != HeaderId::COUNT) {
+            std::string_view& slot = head.known[static_cast<size_t>(id)];
+            // 重复且不一致的 Content-Length 无法确定 body 边界（请求走私）
+            if (id == HeaderId::CONTENT_LENGTH && slot.data() != nullptr && slot != field_value) {
+                return false;
+            }
+            slot = field_value;
+        }
+        head.headers.push_back({name, field_value});
+        p = value_end + 2;
+    }
+}
+
+HeaderId HttpScanner::lookup(std::string_view name) {
+    // 先按长度分派，每个长度最多比较两次
+    switch (name.size()) {
+        case 6:
+            if (equals_ci(name, "Expect")) return HeaderId::EXPECT;
+            if (equals_ci(name, "Accept")) return HeaderId::ACCEPT;
+            break;
+        case 10:
+            if (equals_ci(name, "Connection")) return HeaderId::CONNECTION;
+            break;
+        case 12:
+            if (equals_ci(name, "Content-Type")) return HeaderId::CONTENT_TYPE;
+            break;
+        case 13:
+            if (equals_ci(name, "If-None-Match")) return HeaderId::IF_NONE_MATCH;
+            break;
+        case 14:
+            if (equals_ci(name, "Content-Length")) return HeaderId::CONTENT_LENGTH;
+            break;
+        case 15:
+            if (equals_ci(name, "Accept-Encoding")) return HeaderId::ACCEPT_ENCODING;
+            break;
+        default:
+            break;
+    }
+    return HeaderId::COUNT;
+}
+
+bool HttpScanner::equals_ci(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool HttpScanner::contains_ci(std::string_view text, std::string_view token) {
+    if (token.size() > text.size()) {
+        return false;
+    }
+    for (size_t i = 0; i + token.size() <= text.size(); ++i) {
+        if (strncasecmp(text.data() + i, token.data(), token.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HttpScanner::Backend HttpScanner::backend() {
+    return g_impl.backend;
+}
+
+const char* HttpScanner::backend_name(Backend backend) {
+    switch (backend) {
+        case Backend::AVX2:  return "avx2";
+        case Backend::SSE42: return "sse4.2";
+        default:             return "scalar";
+    }
+}
+
+bool HttpScanner::select_backend(Backend backend) {
+    if (!cpu_supports(backend)) {
+        return false;
+    }
+    g_impl = make_implementation(backend);
+    return true;
+}
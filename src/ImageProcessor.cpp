@@ -1,56 +1,220 @@
 #include "ImageProcessor.h"
 #include "ConfigManager.h"
+#include "Logger.h"
 #include <opencv2/opencv.hpp>
 #include <fstream>
+#include <climits>
 #include <iostream>
+#ifdef HAVE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace {
+
+constexpr int JPEG_QUALITY = 95;  // 与 cv::imencode 的默认质量一致
+
+#ifdef HAVE_LIBJPEG
+// libjpeg 的输出目标：缓冲区写满时把整块交给 sink，再换一块新缓冲区
+struct ChunkDestination {
+    jpeg_destination_mgr pub;
+    std::vector<char> buffer;
+    size_t chunk_size;
+    const std::function<void(std::vector<char>)>* sink;
+};
+
+void chunk_init(j_compress_ptr cinfo) {
+    ChunkDestination* dest = reinterpret_cast<ChunkDestination*>(cinfo->dest);
+    dest->buffer.resize(dest->chunk_size);
+    dest->pub.next_output_byte = reinterpret_cast<JOCTET*>(dest->buffer.data());
+    dest->pub.free_in_buffer = dest->buffer.size();
+}
+
+boolean chunk_empty(j_compress_ptr cinfo) {
+    // 按 libjpeg 的约定，调用时整个缓冲区都已写满
+    ChunkDestination* dest = reinterpret_cast<ChunkDestination*>(cinfo->dest);
+    (*dest->sink)(std::move(dest->buffer));
+    dest->buffer = std::vector<char>();
+    chunk_init(cinfo);
+    return TRUE;
+}
+
+void chunk_term(j_compress_ptr cinfo) {
+    ChunkDestination* dest = reinterpret_cast<ChunkDestination*>(cinfo->dest);
+    dest->buffer.resize(dest->buffer.size() - dest->pub.free_in_buffer);
+    (*dest->sink)(std::move(dest->buffer));
+}
+
+// 默认的错误处理会直接 exit()，这里跳回编码函数
+struct JpegError {
+    jpeg_error_mgr pub;
+    std::jmp_buf jump;
+};
+
+void jpeg_error_exit(j_common_ptr cinfo) {
+    JpegError* error = reinterpret_cast<JpegError*>(cinfo->err);
+    char message[JMSG_LENGTH_MAX];
+    cinfo->err->format_message(cinfo, message);
+    std::cerr << "❌ JPEG 编码失败: " << message << std::endl;
+    std::longjmp(error->jump, 1);
+}
+
+// 逐行编码：每写出一批扫描行，已压缩的数据可能已经交给 sink 发送
+bool encode_jpeg_rows(const cv::Mat& bgr, size_t chunk_size, const std::function<void(std::vector<char>)>& sink) {
+#ifdef JCS_EXTENSIONS
+    // libjpeg-turbo 直接接受 OpenCV 的 BGR 行，无需转换
+    const cv::Mat& image = bgr;
+    J_COLOR_SPACE color_space = bgr.channels() == 1 ? JCS_GRAYSCALE : JCS_EXT_BGR;
+#else
+    cv::Mat image = bgr;
+    J_COLOR_SPACE color_space = JCS_GRAYSCALE;
+    if (bgr.channels() == 3) {
+        cv::cvtColor(bgr, image, cv::COLOR_BGR2RGB);
+        color_space = JCS_RGB;
+    }
+#endif
+
+    jpeg_compress_struct cinfo;
+    JpegError error;
+    ChunkDestination dest;
+    dest.chunk_size = chunk_size;
+    dest.sink = &sink;
+
+    cinfo.err = jpeg_std_error(&error.pub);
+    error.pub.error_exit = jpeg_error_exit;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    dest.pub.init_destination = chunk_init;
+    dest.pub.empty_output_buffer = chunk_empty;
+    dest.pub.term_destination = chunk_term;
+    cinfo.dest = &dest.pub;
+
+    cinfo.image_width = image.cols;
+    cinfo.image_height = image.rows;
+    cinfo.input_components = image.channels();
+    cinfo.in_color_space = color_space;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, JPEG_QUALITY, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(image.ptr<JSAMPLE>(cinfo.next_scanline));
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return true;
+}
+#endif
+
+} // namespace
 
 // 静态成员变量定义
 // YOLOv8Detector ImageProcessor::yolo_detector = YOLOv8Detector();
-// 静态成员变量定义 - 使用指针进行延迟初始化
-YOLOv8Detector* ImageProcessor::yolo_detector = nullptr;
+// 静态成员变量定义 - 每个模型文件一个检测器，延迟初始化
+std::unordered_map<std::string, std::unique_ptr<YOLOv8Detector>> ImageProcessor::yolo_detectors;
+std::mutex ImageProcessor::detectors_mutex;
+std::mutex ImageProcessor::load_mutex;
+
+YOLOv8Detector* ImageProcessor::detectorFor(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(detectors_mutex);
+    std::unique_ptr<YOLOv8Detector>& detector = yolo_detectors[model_path];
+    if (!detector) {
+        detector = std::make_unique<YOLOv8Detector>();
+        std::cout << "[ImageProcessor] 创建新的YOLOv8Detector实例: " << model_path << std::endl;
+    }
+    return detector.get();
+}
+
 // 获取检测器实例，确保延迟初始化
 YOLOv8Detector* ImageProcessor::getDetector() {
-    if (yolo_detector == nullptr) {
-        yolo_detector = new YOLOv8Detector();
-        std::cout << "[ImageProcessor] 创建新的YOLOv8Detector实例" << std::endl;
-    }
-    return yolo_detector;
+    return detectorFor(ConfigManager::getInstance().getYOLOModelPath());
 }
 
+YOLOv8Detector* ImageProcessor::getSegmentationDetector() {
+    return detectorFor(ConfigManager::getInstance().getYOLOSegmentationModelPath());
+}
 
-bool ImageProcessor::process(const std::vector<char>& input_data,
+
+bool ImageProcessor::process(ImageServerDEF::ByteView input_data,
                            std::vector<char>& output_data,
                            const std::string& filter_type,
                            std::string& output_content_type,
                            const std::string& blur_intensity,
                            const std::string& sharpen_intensity) {
-    if (input_data.empty()) {
+    cv::Mat processed_image;
+    if (!render(input_data, processed_image, filter_type, output_content_type, blur_intensity, sharpen_intensity)) {
         return false;
     }
+    return encode(processed_image, output_content_type, output_data);
+}
 
+bool ImageProcessor::encode(const cv::Mat& image, const std::string& content_type, std::vector<char>& output_data) {
+    std::string ext = content_type == "image/png" ? ".png" : ".jpg";
+    return cv::imencode(ext, image, reinterpret_cast<std::vector<uchar>&>(output_data));
+}
 
-    // 检查是否是YOLO目标检测请求
-    if (filter_type == "yolo_detect") {
-        return processWithYOLO(input_data, output_data, output_content_type);
-    }    
-    // 检查是否是YOLO图像分割请求
-    if (filter_type == "yolo_segment") {
-        return processWithYOLOSegmentation(input_data, output_data, output_content_type);
+bool ImageProcessor::encodeChunked(const cv::Mat& image,
+                                 const std::string& content_type,
+                                 size_t chunk_size,
+                                 const std::function<void(std::vector<char>)>& sink) {
+    if (image.empty() || chunk_size == 0) {
+        return false;
     }
-    
-    // 检查是否是YOLO目标检测+分割请求
-    if (filter_type == "yolo_segment_with_boxes") {
-        return processWithYOLOSegmentationWithBoxes(input_data, output_data, output_content_type);
+
+#ifdef HAVE_LIBJPEG
+    if (content_type == "image/jpeg" && image.depth() == CV_8U && (image.channels() == 1 || image.channels() == 3)) {
+        return encode_jpeg_rows(image, chunk_size, sink);
     }
+#endif
 
+    std::vector<char> encoded;
+    if (!encode(image, content_type, encoded)) {
+        return false;
+    }
+    for (size_t offset = 0; offset < encoded.size(); offset += chunk_size) {
+        size_t len = std::min(chunk_size, encoded.size() - offset);
+        sink(std::vector<char>(encoded.begin() + offset, encoded.begin() + offset + len));
+    }
+    return true;
+}
+
+bool ImageProcessor::render(ImageServerDEF::ByteView input_data,
+                          cv::Mat& processed_image,
+                          const std::string& filter_type,
+                          std::string& output_content_type,
+                          const std::string& blur_intensity,
+                          const std::string& sharpen_intensity) {
     // 1. 解码图像数据
-    cv::Mat image = cv::imdecode(cv::Mat(input_data), cv::IMREAD_COLOR);
-    if (image.empty()) {
+    cv::Mat image;
+    if (!decode(input_data, image)) {
         return false;
     }
+    output_content_type = "image/jpeg";
+
+    // YOLO 目标检测 / 图像分割（可选显示边界框）
+    if (filter_type == "yolo_detect") {
+        if (!ensureModelLoaded(ConfigManager::getInstance().getYOLOModelPath())) {
+            return false;
+        }
+        processed_image = drawDetections(image, detectObjects(image));
+        return true;
+    }
+    if (filter_type == "yolo_segment" || filter_type == "yolo_segment_with_boxes") {
+        if (!ensureModelLoaded(ConfigManager::getInstance().getYOLOSegmentationModelPath())) {
+            return false;
+        }
+        processed_image = drawSegmentations(image, detectSegmentations(image), filter_type == "yolo_segment_with_boxes");
+        return true;
+    }
 
     // 2. 应用滤镜
-    cv::Mat processed_image;
     if (filter_type == "grayscale") {
         cv::cvtColor(image, processed_image, cv::COLOR_BGR2GRAY);
     } else if (filter_type == "blur") {
@@ -107,16 +271,125 @@ bool ImageProcessor::process(const std::vector<char>& input_data,
         processed_image = image;
     }
     
-    // 3. 编码图像为目标格式
+    // 3. 目标格式
     // 注意：Canny 边缘检测后是单通道灰度图，
-    std::string ext = ".jpg";
-    output_content_type = "image/jpeg";
     if (filter_type == "canny") {
-        ext = ".png";
         output_content_type = "image/png";
     }
+    return true;
+}
+
+bool ImageProcessor::decode(ImageServerDEF::ByteView input_data, cv::Mat& image) {
+    if (input_data.empty() || input_data.size > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+    // CV_8U 矩阵头直接指向上传缓冲区，不拷贝
+    cv::Mat encoded(1, static_cast<int>(input_data.size), CV_8UC1, const_cast<char*>(input_data.data));
+    image = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    return !image.empty();
+}
+
+bool ImageProcessor::detectImage(ImageServerDEF::ByteView input_data, cv::Size& image_size,
+                                 std::vector<YOLODetection>& detections) {
+    cv::Mat image;
+    if (!decode(input_data, image)
+        || !ensureModelLoaded(ConfigManager::getInstance().getYOLOModelPath())) {
+        return false;
+    }
+    image_size = cv::Size(image.cols, image.rows);
+    detections = detectObjects(image);
+    return true;
+}
+
+bool ImageProcessor::detectFrame(const cv::Mat& image, std::vector<YOLODetection>& detections) {
+    if (!ensureModelLoaded(ConfigManager::getInstance().getYOLOModelPath())) {
+        return false;
+    }
+    detections = getDetector()->detect(image);
+    return true;
+}
+
+bool ImageProcessor::segmentImage(ImageServerDEF::ByteView input_data, cv::Size& image_size,
+                                  std::vector<YOLOSegmentation>& segmentations) {
+    cv::Mat image;
+    if (!decode(input_data, image)
+        || !ensureModelLoaded(ConfigManager::getInstance().getYOLOSegmentationModelPath())) {
+        return false;
+    }
+    image_size = cv::Size(image.cols, image.rows);
+    segmentations = detectSegmentations(image);
+    return true;
+}
+
+bool ImageProcessor::isYOLOFilter(const std::string& filter_type) {
+    return filter_type == "yolo_detect" || filter_type == "yolo_segment" || filter_type == "yolo_segment_with_boxes";
+}
+
+void ImageProcessor::renderYOLOBatch(const std::vector<ImageServerDEF::ByteView>& inputs,
+                                   const std::string& filter_type,
+                                   std::vector<cv::Mat>& outputs) {
+    outputs.assign(inputs.size(), cv::Mat());
+    bool detect = filter_type == "yolo_detect";
+    ConfigManager& config = ConfigManager::getInstance();
+    if (!ensureModelLoaded(detect ? config.getYOLOModelPath() : config.getYOLOSegmentationModelPath())) {
+        return;
+    }
+
+    // 只有解码成功的图像参与推理
+    std::vector<cv::Mat> images;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        cv::Mat image;
+        if (decode(inputs[i], image)) {
+            images.push_back(image);
+            positions.push_back(i);
+        }
+    }
+    if (images.empty()) {
+        return;
+    }
 
-    return cv::imencode(ext, processed_image, reinterpret_cast<std::vector<uchar>&>(output_data));
+    YOLOv8Detector* detector = detect ? getDetector() : getSegmentationDetector();
+    LOG_INFO("批量推理 " + std::to_string(images.size()) + " 张图像 (" + filter_type + ")");
+    if (detect) {
+        std::vector<std::vector<YOLODetection>> detections = detector->detectBatch(images);
+        for (size_t i = 0; i < images.size(); ++i) {
+            outputs[positions[i]] = drawDetections(images[i], detections[i]);
+        }
+    } else {
+        std::vector<std::vector<YOLOSegmentation>> segmentations = detector->detectSegmentationBatch(images);
+        for (size_t i = 0; i < images.size(); ++i) {
+            outputs[positions[i]] = drawSegmentations(images[i], segmentations[i], filter_type == "yolo_segment_with_boxes");
+        }
+    }
+}
+
+bool ImageProcessor::warmup() {
+    ConfigManager& config = ConfigManager::getInstance();
+    // 首次推理会初始化 DNN 后端并分配中间缓冲区；用两张图走批量接口，
+    // 顺带探测模型是否支持批量输入，不支持的检测器此后直接逐张推理
+    cv::Mat blank(config.getYOLOInputHeight(), config.getYOLOInputWidth(), CV_8UC3, cv::Scalar(114, 114, 114));
+    const std::vector<cv::Mat> probe = {blank, blank};
+    bool ok = true;
+
+    std::string detect_model = config.getYOLOModelPath();
+    if (ensureModelLoaded(detect_model)) {
+        getDetector()->detectBatch(probe);
+        LOG_INFO("检测模型预热完成: " + detect_model);
+    } else {
+        LOG_ERROR("检测模型预热失败: " + detect_model);
+        ok = false;
+    }
+
+    std::string segment_model = config.getYOLOSegmentationModelPath();
+    if (ensureModelLoaded(segment_model)) {
+        getSegmentationDetector()->detectSegmentationBatch(probe);
+        LOG_INFO("分割模型预热完成: " + segment_model);
+    } else {
+        LOG_ERROR("分割模型预热失败: " + segment_model);
+        ok = false;
+    }
+    return ok;
 }
 
 bool ImageProcessor::loadYOLOModel(const std::string& model_path, const std::string& config_path) {
@@ -128,21 +401,19 @@ bool ImageProcessor::loadYOLOModel(const std::string& model_path, const std::str
     // 如果未指定模型路径，从配置文件获取
     std::string actual_model_path = model_path.empty() ? config.getYOLOModelPath() : model_path;
     
-    YOLOv8Detector* detector = getDetector();
-    
     // 从配置文件获取YOLO参数
     float conf_threshold = config.getYOLOConfidenceThreshold();
     float nms_threshold = config.getYOLONMSThreshold();
     int input_width = config.getYOLOInputWidth();
     int input_height = config.getYOLOInputHeight();
     
-    // 重新创建检测器实例以应用新配置
-    if (yolo_detector != nullptr) {
-        delete yolo_detector;
+    // 重新创建该模型的检测器实例以应用新配置
+    auto detector = std::make_unique<YOLOv8Detector>(conf_threshold, nms_threshold, input_width, input_height);
+    bool result = detector->loadModel(actual_model_path, config_path);
+    {
+        std::lock_guard<std::mutex> lock(detectors_mutex);
+        yolo_detectors[actual_model_path] = std::move(detector);
     }
-    yolo_detector = new YOLOv8Detector(conf_threshold, nms_threshold, input_width, input_height);
-    
-    bool result = yolo_detector->loadModel(actual_model_path, config_path);
     std::cout << "[ImageProcessor] 模型加载结果: " << (result ? "成功" : "失败") << std::endl;
     return result;
 }
@@ -176,48 +447,28 @@ cv::Mat ImageProcessor::drawDetections(const cv::Mat& image, const std::vector<Y
 bool ImageProcessor::processWithYOLO(const std::vector<char>& input_data,
                                    std::vector<char>& output_data,
                                    std::string& output_content_type) {
-    if (input_data.empty()) {
-        return false;
+    return process(input_data, output_data, "yolo_detect", output_content_type);
+}
+
+bool ImageProcessor::ensureModelLoaded(const std::string& model_path) {
+    // 每个模型文件有自己的检测器：检测和分割不会共用同一个网络
+    YOLOv8Detector* detector = detectorFor(model_path);
+    // 加载期间持有锁，同时到达的请求不会重复加载
+    std::lock_guard<std::mutex> lock(load_mutex);
+    if (detector->isModelLoaded()) {
+        return true;
     }
-    
-    // 解码图像
-    cv::Mat image = cv::imdecode(cv::Mat(input_data), cv::IMREAD_COLOR);
-    if (image.empty()) {
+    std::cout << "[ImageProcessor] 模型未加载，尝试加载: " << model_path << std::endl;
+    if (!detector->loadModel(model_path)) {
+        std::cerr << "❌ 无法加载YOLOv8模型: " << model_path << std::endl;
         return false;
     }
-
-    std::cout << "[ImageProcessor] processWithYOLO - 图像解码成功: " << image.cols << "x" << image.rows << std::endl;
-    
-    // 获取检测器实例
-    YOLOv8Detector* detector = getDetector();
-    // 如果模型未加载，尝试加载默认模型
-    if (!detector->isModelLoaded()) {
-        std::cout << "[ImageProcessor] 模型未加载，尝试加载默认模型" << std::endl;
-        // 使用配置管理器获取模型路径
-        ConfigManager& config = ConfigManager::getInstance();
-        std::string model_path = config.getYOLOModelPath();
-        if (!detector->loadModel(model_path)) {
-            std::cerr << "❌ 无法加载YOLOv8模型: " << model_path << std::endl;
-            return false;
-        }
-    } else {
-        std::cout << "[ImageProcessor] 模型已加载" << std::endl;
-    }
-    
-    // 执行目标检测
-    std::vector<YOLODetection> detections = detectObjects(image);
-    
-    // 绘制检测结果
-    cv::Mat result_image = drawDetections(image, detections);
-    
-    // 编码结果图像
-    output_content_type = "image/jpeg";
-    return cv::imencode(".jpg", result_image, reinterpret_cast<std::vector<uchar>&>(output_data));
+    return true;
 }
 
 std::vector<YOLOSegmentation> ImageProcessor::detectSegmentations(const cv::Mat& image) {
     std::cout << "[ImageProcessor] 开始图像分割，图像尺寸: " << image.cols << "x" << image.rows << std::endl;
-    YOLOv8Detector* detector = getDetector();
+    YOLOv8Detector* detector = getSegmentationDetector();
     std::cout << "[ImageProcessor] 模型加载状态: " << (detector->isModelLoaded() ? "已加载" : "未加载") << std::endl;
     
     auto segmentations = detector->detectSegmentation(image);
@@ -226,92 +477,22 @@ std::vector<YOLOSegmentation> ImageProcessor::detectSegmentations(const cv::Mat&
 }
 
 cv::Mat ImageProcessor::drawSegmentations(const cv::Mat& image, const std::vector<YOLOSegmentation>& segmentations, bool draw_boxes) {
-    YOLOv8Detector* detector = getDetector();
+    YOLOv8Detector* detector = getSegmentationDetector();
     return detector->drawSegmentations(image, segmentations, draw_boxes);
 }
 
 bool ImageProcessor::processWithYOLOSegmentation(const std::vector<char>& input_data,
                                                std::vector<char>& output_data,
                                                std::string& output_content_type) {
-    if (input_data.empty()) {
-        return false;
-    }
-    
-    // 解码图像
-    cv::Mat image = cv::imdecode(cv::Mat(input_data), cv::IMREAD_COLOR);
-    if (image.empty()) {
-        return false;
-    }
-    
-    std::cout << "[ImageProcessor] processWithYOLOSegmentation - 图像解码成功: " << image.cols << "x" << image.rows << std::endl;
-    
-    // 获取检测器实例
-    YOLOv8Detector* detector = getDetector();
-    // 如果模型未加载，尝试加载默认模型
-    if (!detector->isModelLoaded()) {
-        std::cout << "[ImageProcessor] 模型未加载，尝试加载默认模型" << std::endl;
-        // 使用配置管理器获取分割模型路径
-        ConfigManager& config = ConfigManager::getInstance();
-        std::string model_path = config.getYOLOSegmentationModelPath();
-        if (!detector->loadModel(model_path)) {
-            std::cerr << "❌ 无法加载YOLOv8分割模型: " << model_path << std::endl;
-            return false;
-        }
-    } else {
-        std::cout << "[ImageProcessor] 模型已加载" << std::endl;
-    }
-    
-    // 执行图像分割
-    std::vector<YOLOSegmentation> segmentations = detectSegmentations(image);
-    
     // 绘制分割掩码（默认不显示边界框）
-    cv::Mat result_image = drawSegmentations(image, segmentations, false);
-    
-    // 编码结果图像
-    output_content_type = "image/jpeg";
-    return cv::imencode(".jpg", result_image, reinterpret_cast<std::vector<uchar>&>(output_data));
+    return process(input_data, output_data, "yolo_segment", output_content_type);
 }
 
 bool ImageProcessor::processWithYOLOSegmentationWithBoxes(const std::vector<char>& input_data,
                                                         std::vector<char>& output_data,
                                                         std::string& output_content_type) {
-    if (input_data.empty()) {
-        return false;
-    }
-    
-    // 解码图像
-    cv::Mat image = cv::imdecode(cv::Mat(input_data), cv::IMREAD_COLOR);
-    if (image.empty()) {
-        return false;
-    }
-    
-    std::cout << "[ImageProcessor] processWithYOLOSegmentationWithBoxes - 图像解码成功: " << image.cols << "x" << image.rows << std::endl;
-    
-    // 获取检测器实例
-    YOLOv8Detector* detector = getDetector();
-    // 如果模型未加载，尝试加载默认模型
-    if (!detector->isModelLoaded()) {
-        std::cout << "[ImageProcessor] 模型未加载，尝试加载默认模型" << std::endl;
-        // 使用配置管理器获取分割模型路径
-        ConfigManager& config = ConfigManager::getInstance();
-        std::string model_path = config.getYOLOSegmentationModelPath();
-        if (!detector->loadModel(model_path)) {
-            std::cerr << "❌ 无法加载YOLOv8分割模型: " << model_path << std::endl;
-            return false;
-        }
-    } else {
-        std::cout << "[ImageProcessor] 模型已加载" << std::endl;
-    }
-    
-    // 执行图像分割
-    std::vector<YOLOSegmentation> segmentations = detectSegmentations(image);
-    
     // 绘制分割结果（显示边界框和标签）
-    cv::Mat result_image = drawSegmentations(image, segmentations, true);
-    
-    // 编码结果图像
-    output_content_type = "image/jpeg";
-    return cv::imencode(".jpg", result_image, reinterpret_cast<std::vector<uchar>&>(output_data));
+    return process(input_data, output_data, "yolo_segment_with_boxes", output_content_type);
 }
 
 // OpenCV滤镜效果实现
@@ -0,0 +1,228 @@
+#include "MjpegStream.h"
+#include "Reactor.h"
+#include "ThreadPool.h"
+#include "HttpResponse.h"
+#include "ImageProcessor.h"
+#include "Logger.h"
+#include <random>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+std::string make_boundary() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "imp-frame-%016llx", static_cast<unsigned long long>(rng()));
+    return buffer;
+}
+
+} // namespace
+
+MjpegStream::MjpegStream(Reactor& reactor, uint64_t handle, ThreadPool& pool, const std::string& boundary,
+                         bool chunked_input, size_t max_frame_size, AdmissionController::Ticket ticket)
+    : _reactor(reactor), _handle(handle), _pool(pool), _ticket(std::move(ticket)),
+      _chunked_input(chunked_input), _boundary(make_boundary()), _first_part(true),
+      _input_done(false), _ended(false), _closed(false), _received(0), _sent(0), _dropped(0) {
+    _running.fill(false);
+    // 每个 part 都是一帧，单帧上限复用图片缓冲区的 Content-Length 上限
+    _frames.reset(boundary, max_frame_size, true);
+}
+
+HttpResponse MjpegStream::response_head() const {
+    // 流没有自然的结束点，结束后关闭连接
+    HttpResponse head(200, false);
+    head.set_content_type("multipart/x-mixed-replace; boundary=" + _boundary);
+    head.add_header("Cache-Control", "no-store");
+    head.set_chunked();
+    return head;
+}
+
+bool MjpegStream::on_data(const char* data, size_t len) {
+    if (_frames.complete() || _dechunk.done()) {
+        // 输入已结束，之后的数据忽略
+        return true;
+    }
+    if (_chunked_input) {
+        if (!_dechunk.decode(data, len, [this](const char* payload, size_t n) { feed(payload, n); })) {
+            return false;
+        }
+        if (_dechunk.done()) {
+            end_of_input();
+        }
+    } else {
+        feed(data, len);
+    }
+    return !_frames.failed();
+}
+
+void MjpegStream::feed(const char* data, size_t len) {
+    if (_frames.complete() || _frames.failed()) {
+        return;
+    }
+    _frames.feed(data, len);
+    for (MultipartParser::FilePart& part : _frames.take_files()) {
+        ++_received;
+        Frame frame;
+        frame.jpeg = std::move(part.data);
+        push(DECODE, std::move(frame));
+    }
+    if (_frames.complete()) {
+        end_of_input();
+    }
+}
+
+void MjpegStream::end_of_input() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _input_done = true;
+    }
+    finish_if_idle();
+}
+
+void MjpegStream::push(int stage, Frame frame) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_closed) {
+            return;
+        }
+        if (_slots[stage]) {
+            // 下游跟不上：新帧替换等待中的旧帧
+            ++_dropped;
+        }
+        _slots[stage] = std::move(frame);
+        if (_running[stage]) {
+            return;
+        }
+        _running[stage] = true;
+    }
+    try {
+        std::shared_ptr<MjpegStream> self = shared_from_this();
+        _pool.enqueue([self, stage] { self->run(stage); });
+    } catch (const std::runtime_error&) {
+        // 线程池已停止（进程退出中）
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running[stage] = false;
+        _slots[stage].reset();
+    }
+}
+
+void MjpegStream::run(int stage) {
+    // 本阶段的槽位一直有帧就继续处理，处理完一帧交给下一阶段
+    while (true) {
+        Frame frame;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed || !_slots[stage]) {
+                _running[stage] = false;
+                break;
+            }
+            frame = std::move(*_slots[stage]);
+            _slots[stage].reset();
+        }
+
+        bool ok;
+        try {
+            ok = process(stage, frame);
+        } catch (const std::exception& e) {
+            LOG_ERROR(std::string("推流帧处理异常: ") + e.what());
+            ok = false;
+        }
+        if (!ok) {
+            ++_dropped;
+            continue;
+        }
+
+        if (stage + 1 < STAGE_COUNT) {
+            push(stage + 1, std::move(frame));
+        } else {
+            std::shared_ptr<MjpegStream> self = shared_from_this();
+            _reactor.post([self, jpeg = std::move(frame.jpeg)]() mutable { self->send_frame(std::move(jpeg)); });
+        }
+    }
+    finish_if_idle();
+}
+
+bool MjpegStream::process(int stage, Frame& frame) {
+    switch (stage) {
+        case DECODE:
+            return ImageProcessor::decode(frame.jpeg, frame.image);
+        case DETECT:
+            // 模型加载失败时原样输出，不中断推流
+            if (!ImageProcessor::detectFrame(frame.image, frame.detections)) {
+                frame.detections.clear();
+            }
+            return true;
+        case ENCODE:
+            // 编码结果写回输入缓冲区，复用其容量
+            return ImageProcessor::encode(ImageProcessor::drawDetections(frame.image, frame.detections),
+                                          "image/jpeg", frame.jpeg);
+    }
+    return false;
+}
+
+void MjpegStream::finish_if_idle() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_input_done || _ended || _closed) {
+            return;
+        }
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            if (_running[stage] || _slots[stage]) {
+                return;
+            }
+        }
+        _ended = true;
+    }
+    // 排在最后一帧之后执行
+    std::shared_ptr<MjpegStream> self = shared_from_this();
+    _reactor.post([self] { self->send_end(); });
+}
+
+void MjpegStream::send_frame(std::vector<char> jpeg) {
+    size_t queued = _reactor.queued_responses(_handle);
+    if (queued == SIZE_MAX) {
+        return;  // 连接已关闭
+    }
+    if (queued > 0) {
+        // 上一帧还没发完，客户端或网络跟不上
+        ++_dropped;
+        return;
+    }
+
+    std::string head = (_first_part ? "--" : "\r\n--") + _boundary;
+    head += "\r\nContent-Type: image/jpeg\r\nContent-Length: " + std::to_string(jpeg.size()) + "\r\n\r\n";
+    _first_part = false;
+
+    int fd = ConnectionTable::handle_fd(_handle);
+    _reactor.send_response(fd, HttpResponse::chunk(std::vector<char>(head.begin(), head.end())));
+    if (_reactor.queued_responses(_handle) != SIZE_MAX) {
+        _reactor.send_response(fd, HttpResponse::chunk(std::move(jpeg)));
+        ++_sent;
+    }
+}
+
+void MjpegStream::send_end() {
+    if (_reactor.queued_responses(_handle) == SIZE_MAX) {
+        return;
+    }
+    int fd = ConnectionTable::handle_fd(_handle);
+    std::string closing = (_first_part ? "--" : "\r\n--") + _boundary + "--\r\n";
+    _reactor.send_response(fd, HttpResponse::chunk(std::vector<char>(closing.begin(), closing.end())));
+    if (_reactor.queued_responses(_handle) != SIZE_MAX) {
+        // Connection: close，发送完毕后关闭连接
+        _reactor.send_response(fd, HttpResponse::last_chunk(false));
+    }
+}
+
+void MjpegStream::on_close() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        for (auto& slot : _slots) {
+            slot.reset();
+        }
+    }
+    LOG_INFO("推流结束: 收到 " + std::to_string(_received.load()) + " 帧，发送 " + std::to_string(_sent.load())
+        + " 帧，丢弃 " + std::to_string(_dropped.load()) + " 帧");
+}
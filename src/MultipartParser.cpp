@@ -0,0 +1,373 @@
+#include "MultipartParser.h"
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+
+namespace {
+
+constexpr size_t MAX_PART_HEADER_SIZE = 8 * 1024;  // 单个 part 头部上限
+constexpr size_t MAX_FIELD_SIZE = 64 * 1024;       // 单个文本字段上限
+constexpr size_t MAX_FIELDS = 32;                  // 文本字段个数上限，超出的字段被丢弃
+constexpr size_t MAX_FILES = 1024;                 // 文件 part 个数上限，超出时 body 视为格式错误
+constexpr size_t SCRATCH_SIZE = 16 * 1024;         // 非图片阶段 window() 的大小
+constexpr size_t MIN_FILE_WINDOW = 64 * 1024;      // 文件 part 收到这么多数据后 window() 才指向其缓冲区，
+constexpr size_t MAX_FILE_WINDOW = 1 << 20;        // 大小随已收数据翻倍，最多 1MB
+constexpr size_t MAX_RETAINED_CAPACITY = 1 << 20;  // 连接复用时保留的缓冲区容量上限
+constexpr size_t NPOS = static_cast<size_t>(-1);
+
+// 取出 Content-Disposition 的 name 参数（跳过 filename= 中的 name=）
+std::string part_name(const std::string& header) {
+    size_t pos = 0;
+    while ((pos = header.find("name=\"", pos)) != std::string::npos) {
+        if (pos == 0 || header[pos - 1] == ' ' || header[pos - 1] == ';') {
+            size_t start = pos + 6;
+            size_t end = header.find('"', start);
+            return end == std::string::npos ? std::string() : header.substr(start, end - start);
+        }
+        pos += 6;
+    }
+    return std::string();
+}
+
+template <class T>
+void release_buffer(T& buffer) {
+    if (buffer.capacity() > MAX_RETAINED_CAPACITY) {
+        T().swap(buffer);
+    }
+}
+
+} // namespace
+
+MultipartParser::MultipartParser()
+    : _state(State::DONE), _content_length(0), _every_part_is_file(false), _received(0), _sink(Sink::DISCARD), _sink_len(0),
+      _scan_from(0), _image_limit(0), _window_is_scratch(false) {
+    _skip.fill(0);
+}
+
+void MultipartParser::reset(const std::string& boundary, size_t content_length, bool every_part_is_file) {
+    clear();
+    _delimiter = "\r\n--" + boundary;
+    _content_length = content_length;
+    _every_part_is_file = every_part_is_file;
+
+    // Horspool 跳转表：按窗口最后一个字节决定右移距离
+    size_t m = _delimiter.size();
+    _skip.fill(m);
+    for (size_t i = 0; i + 1 < m; ++i) {
+        _skip[static_cast<unsigned char>(_delimiter[i])] = m - 1 - i;
+    }
+
+    // 第一个分隔符前面没有 "\r\n"，预先放入两个字节，所有分隔符按同一形式查找
+    _state = State::PREAMBLE;
+    std::memcpy(reserve(2), "\r\n", 2);
+    _sink_len = 2;
+}
+
+void MultipartParser::clear() {
+    _state = State::DONE;
+    _received = 0;
+    _sink = Sink::DISCARD;
+    _sink_len = 0;
+    _scan_from = 0;
+    _image.clear();
+    _files.clear();
+    _text.clear();
+    _discard.clear();
+    _window_is_scratch = false;
+    _suffix.clear();
+    _part_header.clear();
+    _part_name.clear();
+    _fields.clear();
+}
+
+void MultipartParser::release() {
+    clear();
+    release_buffer(_image);
+    release_buffer(_text);
+    release_buffer(_discard);
+    release_buffer(_part_header);
+}
+
+std::vector<char>& MultipartParser::sink_buffer() {
+    switch (_sink) {
+        case Sink::IMAGE: return _image;
+        case Sink::FIELD: return _text;
+        default:          return _discard;
+    }
+}
+
+char* MultipartParser::reserve(size_t len) {
+    std::vector<char>& buffer = sink_buffer();
+    size_t need = _sink_len + len;
+    if (_sink == Sink::IMAGE && buffer.capacity() < need) {
+        // 文件 part 的容量随自身数据翻倍增长，不超过该 part 可能的最大长度（_image_limit）
+        buffer.reserve(std::max(need, std::min(buffer.capacity() * 2, _image_limit)));
+    }
+    // 只初始化本次要写入的部分
+    if (buffer.size() < need) {
+        buffer.resize(need);
+    }
+    return buffer.data() + _sink_len;
+}
+
+size_t MultipartParser::find_delimiter(const char* data, size_t len) const {
+    size_t m = _delimiter.size();
+    if (len < m) {
+        return NPOS;
+    }
+    const char* pattern = _delimiter.data();
+    unsigned char tail = static_cast<unsigned char>(pattern[m - 1]);
+    size_t i = 0;
+    while (i <= len - m) {
+        unsigned char last = static_cast<unsigned char>(data[i + m - 1]);
+        if (last == tail && std::memcmp(data + i, pattern, m - 1) == 0) {
+            return i;
+        }
+        i += _skip[last];
+    }
+    return NPOS;
+}
+
+void MultipartParser::feed(const char* data, size_t len) {
+    _received += len;
+    parse(data, len);
+}
+
+void MultipartParser::parse(const char* data, size_t len) {
+    std::string pending;   // 分隔符之后、尚未解析的数据
+    std::string leftover;
+    while (len > 0) {
+        switch (_state) {
+            case State::PREAMBLE:
+            case State::PART_DATA:
+                std::memcpy(reserve(len), data, len);
+                _sink_len += len;
+                scan(leftover);
+                // 继续解析分隔符之后的数据
+                pending.swap(leftover);
+                leftover.clear();
+                data = pending.data();
+                len = pending.size();
+                break;
+
+            case State::DELIMITER_SUFFIX: {
+                // 分隔符之后允许有空白，然后 "\r\n" 开始下一个 part，"--" 表示 body 结束
+                char c = *data++;
+                --len;
+                if (_suffix.empty() && (c == ' ' || c == '\t')) {
+                    break;
+                }
+                _suffix.push_back(c);
+                if (_suffix.size() == 2) {
+                    if (_suffix == "--") {
+                        _state = State::DONE;
+                    } else if (_suffix == "\r\n") {
+                        // 保留这个 "\r\n"，没有头部的 part 也能以 "\r\n\r\n" 结束
+                        _part_header = "\r\n";
+                        _state = State::PART_HEADER;
+                    } else {
+                        _state = State::ERROR;
+                    }
+                }
+                break;
+            }
+
+            case State::PART_HEADER: {
+                size_t search_from = _part_header.size() >= 3 ? _part_header.size() - 3 : 0;
+                size_t old_size = _part_header.size();
+                _part_header.append(data, len);
+                size_t end = _part_header.find("\r\n\r\n", search_from);
+                if (end == std::string::npos) {
+                    if (_part_header.size() > MAX_PART_HEADER_SIZE) {
+                        _state = State::ERROR;
+                    }
+                    len = 0;
+                    break;
+                }
+                // 头部之后的数据属于 part 内容
+                size_t consumed = end + 4 - old_size;
+                data += consumed;
+                len -= consumed;
+                _part_header.resize(end);
+                start_part(len);
+                break;
+            }
+
+            case State::DONE:
+            case State::ERROR:
+                // 结束分隔符之后的数据（epilogue）忽略
+                return;
+        }
+    }
+}
+
+void MultipartParser::scan(std::string& leftover) {
+    std::vector<char>& buffer = sink_buffer();
+    size_t pos = find_delimiter(buffer.data() + _scan_from, _sink_len - _scan_from);
+    if (pos != NPOS) {
+        size_t start = _scan_from + pos;
+        size_t after = start + _delimiter.size();
+        leftover.assign(buffer.data() + after, _sink_len - after);
+        finish_part(start);
+        _sink = Sink::DISCARD;
+        _sink_len = 0;
+        _scan_from = 0;
+        _suffix.clear();
+        _state = State::DELIMITER_SUFFIX;
+        return;
+    }
+
+    // 末尾不足一个分隔符长度的数据可能是分隔符的前缀，下次从这里继续查找
+    size_t keep = _delimiter.size() - 1;
+    _scan_from = _sink_len > keep ? _sink_len - keep : 0;
+    if (_sink == Sink::DISCARD && _scan_from > 0) {
+        std::memmove(buffer.data(), buffer.data() + _scan_from, _sink_len - _scan_from);
+        _sink_len -= _scan_from;
+        _scan_from = 0;
+    } else if (_sink == Sink::FIELD && _sink_len > MAX_FIELD_SIZE + keep) {
+        _state = State::ERROR;
+    } else if (_sink == Sink::IMAGE && _sink_len > _content_length + keep) {
+        // 整个 body 不会超过 Content-Length，只有推流（长度未知）时会走到这里
+        _state = State::ERROR;
+    }
+}
+
+void MultipartParser::start_part(size_t unparsed) {
+    _part_name = part_name(_part_header);
+    _sink_len = 0;
+    _scan_from = 0;
+    bool is_file = _every_part_is_file || _part_header.find("filename=") != std::string::npos;
+    if (_part_name == "image" || is_file) {
+        if (_files.size() >= MAX_FILES) {
+            _state = State::ERROR;
+            return;
+        }
+        _sink = Sink::IMAGE;
+        _image.clear();
+        // 该 part 可能的最大长度：body 中剩余的字节（推流时为单帧上限加一个分隔符），容量增长以此为上限
+        size_t parsed = _received - unparsed;
+        _image_limit = _every_part_is_file ? _content_length + _delimiter.size()
+                                           : _content_length - std::min(parsed, _content_length);
+    } else if (!_part_name.empty() && _fields.size() < MAX_FIELDS) {
+        _sink = Sink::FIELD;
+    } else {
+        _sink = Sink::DISCARD;
+    }
+    _state = State::PART_DATA;
+}
+
+void MultipartParser::finish_part(size_t len) {
+    switch (_sink) {
+        case Sink::IMAGE:
+            // 容量翻倍增长，小文件还可能连带收下了后面几个 part 的数据；多余容量超过数据的
+            // 四分之一时拷贝一次收缩，保存的文件（包括批量上传中的每一张）不带着大块空闲容量
+            _image.resize(len);
+            if (_image.capacity() - len > len / 4) {
+                _image.shrink_to_fit();
+            }
+            _files.push_back({_part_name, _part_header, std::move(_image)});
+            _image = std::vector<char>();
+            break;
+        case Sink::FIELD:
+            _fields[_part_name].assign(_text.data(), len);
+            break;
+        case Sink::DISCARD:
+            break;
+    }
+}
+
+std::pair<char*, size_t> MultipartParser::window(size_t max_len) {
+    _window_is_scratch = false;
+    if (max_len == 0 || _state == State::DONE || _state == State::ERROR) {
+        return {nullptr, 0};
+    }
+    if (_state == State::PART_DATA && _sink == Sink::IMAGE && _sink_len >= MIN_FILE_WINDOW) {
+        // 只初始化有限的一段：只发送 part 头部的客户端不会让服务器提交大块内存，
+        // 批量上传中的小文件也不会各自占用一整块窗口
+        size_t len = std::min(max_len, std::min(_sink_len, MAX_FILE_WINDOW));
+        return {reserve(len), len};
+    }
+    _window_is_scratch = true;
+    if (_scratch.size() < SCRATCH_SIZE) {
+        _scratch.resize(SCRATCH_SIZE);
+    }
+    return {_scratch.data(), std::min(max_len, SCRATCH_SIZE)};
+}
+
+void MultipartParser::commit(size_t len) {
+    if (_window_is_scratch) {
+        _window_is_scratch = false;
+        feed(_scratch.data(), len);
+        return;
+    }
+    // 数据已在图片缓冲区中，只需查找分隔符
+    _received += len;
+    _sink_len += len;
+    std::string leftover;
+    scan(leftover);
+    if (!leftover.empty()) {
+        parse(leftover.data(), leftover.size());
+    }
+}
+
+const MultipartParser::FilePart* MultipartParser::find_image() const {
+    for (const FilePart& file : _files) {
+        if (file.name == "image") {
+            return &file;
+        }
+    }
+    return nullptr;
+}
+
+const std::vector<char>& MultipartParser::image() const {
+    static const std::vector<char> empty;
+    const FilePart* image = find_image();
+    return image == nullptr ? empty : image->data;
+}
+
+std::vector<char> MultipartParser::take_image() {
+    std::vector<char> image;
+    const FilePart* found = find_image();
+    if (found != nullptr) {
+        FilePart& file = _files[found - _files.data()];
+        image.swap(file.data);
+        file.name.clear();  // 已移出，不再作为 image 字段
+    }
+    return image;
+}
+
+std::vector<MultipartParser::FilePart> MultipartParser::take_files() {
+    std::vector<FilePart> files;
+    files.swap(_files);
+    return files;
+}
+
+std::string_view MultipartParser::FilePart::header_value(std::string_view field) const {
+    // 头部以 "\r\n" 开头，每行 "Name: value"
+    std::string_view rest = header;
+    while (!rest.empty()) {
+        size_t line_end = rest.find("\r\n");
+        std::string_view line = rest.substr(0, line_end);
+        rest = line_end == std::string_view::npos ? std::string_view() : rest.substr(line_end + 2);
+
+        size_t colon = line.find(':');
+        if (colon != field.size() || strncasecmp(line.data(), field.data(), colon) != 0) {
+            continue;
+        }
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+    return std::string_view();
+}
+
+const std::string& MultipartParser::field(const std::string& name) const {
+    static const std::string empty;
+    auto it = _fields.find(name);
+    return it == _fields.end() ? empty : it->second;
+}
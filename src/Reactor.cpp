@@ -0,0 +1,720 @@
+#include "Reactor.h"
+#include "Server.h"
+#include "Connection.h"
+#include "HttpResponse.h"
+#include "utils.h"
+#include "ConfigManager.h"
+#include "UnixSocket.h"
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/tcp.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+#include <arpa/inet.h>
+#include <Logger.h>
+
+// TCP 监听队列大小，支持更多待处理连接
+constexpr int LISTEN_BACKLOG = 10000;
+// 拒绝请求（413/431/400）后继续接收并丢弃数据的时间和字节上限
+constexpr auto LINGER_TIME = std::chrono::seconds(5);
+constexpr size_t LINGER_MAX_BYTES = 16 * 1024 * 1024;
+// 被接管的连接发送队列积压到此数量时暂停读取：对端只发不收时不再为它生成回复帧
+constexpr size_t MAX_HANDLER_QUEUE = 16;
+
+#if DEBUG_OUTPUT
+#define TERMINAL_OUTPUT 0
+
+// 调试工具函数
+static void debug_print_data(const char* data, size_t len, const std::string& prefix = "")
+{
+    #if TERMINAL_OUTPUT
+        if (!prefix.empty()) {
+            std::cout << prefix << std::endl;
+        }
+
+        std::cout << "数据长度: " << len << " 字节" << std::endl;
+
+        // 字符串输出
+        std::cout << "String: " << std::string(data, std::min(len, size_t(100))) << std::endl;
+        std::cout << "---" << std::endl;
+    # else
+        if (!prefix.empty()) {
+            LOG_INFO(prefix);
+        }
+
+        // 字符串输出
+        LOG_INFO( "First 100 Bytes: \n" + std::string(data, std::min(len, size_t(100)))+
+        "\n-----100 Bytes end-----");
+    #endif
+}
+#endif
+
+
+Reactor::Reactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                 const std::vector<ListenSocket>& inherited)
+    : _id(id), _server(server), _addr(addr), _ports(ports), _wakeup_fd(-1),
+      _draining(false), _open_connections(0), _dispatching(0), _next_stream_token(0) {
+
+    ConfigManager& config = ConfigManager::getInstance();
+    _max_connections = std::max(1, config.getMaxConnections());
+    _defer_accept_seconds = std::max(0, config.getDeferAcceptSeconds());
+    _unix_send_buffer = std::max(0, config.getUnixSendBufferSize());
+    _unix_recv_buffer = std::max(0, config.getUnixRecvBufferSize());
+    _header_timeout = std::chrono::milliseconds(std::max(1, config.getHeaderTimeoutMs()));
+    _body_timeout = std::chrono::milliseconds(std::max(1, config.getBodyTimeoutMs()));
+    _min_body_rate = static_cast<size_t>(std::max(0, config.getMinBodyRate()));
+    _keep_alive_timeout = std::chrono::milliseconds(std::max(1, config.getKeepAliveTimeoutMs()));
+    _max_header_size = static_cast<size_t>(std::max(1024, config.getMaxHeaderSize()));
+    _max_body_size = std::min(static_cast<size_t>(std::max(0, config.getMaxImageSize())), ImageServerDEF::MAX_IMAGE_SIZE);
+
+    // 绑定，监听,, ip + port（热重启时优先使用旧进程交来的 socket）
+    setup_listening_sockets(inherited);
+
+    // 线程池任务通过 eventfd 唤醒本 Reactor
+    _wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeup_fd == -1) {
+        for (const ListenSocket& listener : _listeners) close(listener.fd);
+        throw std::runtime_error("Reactor " + std::to_string(_id) + " 无法创建 eventfd");
+    }
+}
+
+Reactor::~Reactor() {
+    // 关闭本 Reactor 的所有客户端连接和监听socket
+    _connections.for_each([](Connection& conn) { close(conn.fd); });
+    for (const ListenSocket& listener : _listeners) {
+        if (listener.fd != -1) close(listener.fd);
+    }
+    if (_wakeup_fd != -1) close(_wakeup_fd);
+}
+
+void Reactor::setup_listening_sockets(const std::vector<ListenSocket>& inherited) {
+    // 接管的 socket 已绑定并处于监听状态，旧进程积压在监听队列中的连接也一并接管
+    // Unix 域 socket 由 Server 创建（或接管）后复制给每个 Reactor，同样作为已监听的 socket 加入
+    for (const ListenSocket& listener : inherited) {
+        set_non_blocking(listener.fd);
+        _listeners.push_back(listener);
+        std::string name = listener.unix_address.empty() ? "端口 " + std::to_string(listener.port) : listener.unix_address;
+        LOG_INFO("Reactor " + std::to_string(_id) + " 接管 " + name + " 的监听socket fd=" + std::to_string(listener.fd));
+    }
+
+    // 多个端口，每个端口一个 SO_REUSEPORT socket，由内核在各 Reactor 之间做负载均衡
+    for (int port : _ports) {
+        bool taken_over = false;
+        for (const ListenSocket& listener : inherited) {
+            if (listener.port == port) taken_over = true;
+        }
+        if (taken_over) {
+            continue;
+        }
+
+        int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd == -1) {
+            throw std::runtime_error("无法创建 socket 用于端口 " + std::to_string(port));
+        }
+
+        // 允许地址重用
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        // 允许多个 Reactor 绑定同一端口
+        if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+            close(listen_fd);
+            throw std::runtime_error("无法为端口 " + std::to_string(port) + " 设置 SO_REUSEPORT");
+        }
+
+        // 设置TCP_NODELAY，减少延迟（响应头和响应体已合并为一次写入，不再产生小包）
+        // 接受的连接会继承监听socket的该选项
+        int tcp_nodelay = 1;
+        setsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &tcp_nodelay, sizeof(tcp_nodelay));
+
+        // 客户端发来数据后才唤醒 accept，空连接不会占用一次事件循环
+        if (_defer_accept_seconds > 0) {
+            setsockopt(listen_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &_defer_accept_seconds, sizeof(_defer_accept_seconds));
+        }
+
+        sockaddr_in server_addr;
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_addr.s_addr = inet_addr(this->_addr);
+        server_addr.sin_port = htons(port);
+
+        // 端口冲突等错误在启动时立即报告；listen() 推迟到 start_listening()
+        if (bind(listen_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            close(listen_fd);
+            throw std::runtime_error("无法绑定到端口 " + std::to_string(port));
+        }
+
+        set_non_blocking(listen_fd);
+
+        _listeners.push_back({port, listen_fd, std::string()});
+        _unlistened.push_back(listen_fd);
+
+        // 发送/接收缓冲区交由内核自动调整，大图响应不再被 4KB 缓冲区拖慢
+        LOG_INFO( "Reactor " + std::to_string(_id) + " 端口 " + std::to_string(port)
+            + " 监听socket配置: 监听队列=" + std::to_string(LISTEN_BACKLOG)
+            + ", TCP_DEFER_ACCEPT=" + std::to_string(_defer_accept_seconds) + "s" );
+    }
+
+    LOG_INFO("Reactor " + std::to_string(_id) + " 共创建 " + std::to_string(_listeners.size()) + " 个监听socket");
+}
+
+void Reactor::start_listening() {
+    for (int listen_fd : _unlistened) {
+        if (listen(listen_fd, LISTEN_BACKLOG) < 0) {
+            int port = 0;
+            for (const ListenSocket& listener : _listeners) {
+                if (listener.fd == listen_fd) port = listener.port;
+            }
+            throw std::runtime_error("无法监听端口 " + std::to_string(port));
+        }
+    }
+    _unlistened.clear();
+}
+
+Connection* Reactor::open_connection(int client_fd, int listen_fd) {
+    std::atomic<int>& current_connections = _server.connection_counter();
+
+    // 检查连接数限制（所有 Reactor 共享计数），超出时立即关闭，而不是让连接在监听队列中等待
+    if (current_connections.fetch_add(1) >= _max_connections) {
+        current_connections--;
+        close(client_fd);
+        return nullptr;
+    }
+
+    // Unix 域 socket 的连接不继承监听 socket 的缓冲区大小
+    if (_unix_send_buffer > 0 || _unix_recv_buffer > 0) {
+        for (const ListenSocket& listener : _listeners) {
+            if (listener.fd == listen_fd && !listener.unix_address.empty()) {
+                unix_socket::set_buffer_sizes(client_fd, _unix_send_buffer, _unix_recv_buffer);
+                break;
+            }
+        }
+    }
+
+    // 从连接池中取出（或复用）该 fd 的连接对象
+    Connection& conn = _connections.open(client_fd);
+    conn.parser.set_limits(_max_header_size, _max_body_size);
+    ++_open_connections;
+
+    // 新连接须在请求头超时内发来完整的请求头
+    conn.timer.data = ConnectionTable::make_handle(conn);
+    conn.timeout = Connection::Timeout::HEADER;
+    _timers.schedule(conn.timer, conn.accepted_at + _header_timeout);
+    return &conn;
+}
+
+void Reactor::release_connection(int fd) {
+    if (Connection* conn = _connections.get(fd)) {
+        _timers.cancel(conn->timer);
+        conn->timeout = Connection::Timeout::NONE;
+        if (conn->handler) {
+            std::shared_ptr<StreamHandler> handler = std::move(conn->handler);
+            handler->on_close();
+        }
+    }
+    _connections.release(fd);
+    int connections = --_server.connection_counter();
+    --_open_connections;
+    LOG_INFO("关闭连接 fd=" + std::to_string(fd) + " (当前连接数: " + std::to_string(connections) + "/" + std::to_string(_max_connections) + ")");
+}
+
+void Reactor::receive(Connection& conn, const char* data, size_t len) {
+    conn.last_activity = Connection::Clock::now();
+
+    if (conn.lingering) {
+        // 被拒绝的请求剩余的数据，直接丢弃
+        conn.lingered += len;
+        if (conn.lingered > LINGER_MAX_BYTES) {
+            close_connection(conn.fd);
+        }
+        return;
+    }
+    if (conn.handler) {
+        // 连接已被接管，数据不再按 HTTP 请求解析；
+        // 处理器可能在回调中发送数据时因出错关闭连接，先持有引用并记下句柄
+        std::shared_ptr<StreamHandler> handler = conn.handler;
+        uint64_t handle = ConnectionTable::make_handle(conn);
+        if (!handler->on_data(data, len) && _connections.get_by_handle(handle)) {
+            LOG_INFO("连接 fd=" + std::to_string(conn.fd) + " 的数据格式错误，关闭连接");
+            close_connection(conn.fd);
+        }
+        return;
+    }
+    conn.parser.parse(data, len);
+}
+
+Connection* Reactor::dispatch_requests(int client_fd) {
+    Connection* conn = _connections.get(client_fd);
+    if (conn && conn->lingering) {
+        // 只读取并丢弃，直到客户端关闭或超出上限
+        return conn;
+    }
+    if (!conn || conn->in_flight) {
+        // 连接已关闭，或上一个请求仍在处理中（完成后由 resume_connection 继续读取）
+        return nullptr;
+    }
+
+    // 处理已完整接收的请求（包括流水线中缓存的请求）
+    while (true) {
+        if (conn->handler) {
+            // 已被接管的连接一直读取；发送队列积压时暂停，发送完成后再继续读取
+            return conn->out_queue.size() < MAX_HANDLER_QUEUE ? conn : nullptr;
+        }
+        if (conn->parser.has_error()) {
+            reject_request(*conn);
+            // 响应已立即发出时开始 lingering，继续读取
+            conn = _connections.get(client_fd);
+            return conn && conn->lingering ? conn : nullptr;
+        }
+        if (conn->parser.take_expect_continue()) {
+            // 请求头已通过检查，通知客户端发送 body
+            send_response(client_fd, HttpResponse(100, true));
+            conn = _connections.get(client_fd);
+            if (!conn) {
+                return nullptr;
+            }
+        }
+        if (!conn->parser.is_request_ready()) {
+            break;
+        }
+
+        HttpParser* parser = &conn->parser;
+#if DEBUG_OUTPUT
+        std::cout << "=== HTTP请求解析完成 ===" << std::endl;
+        std::cout << "方法: " << parser->get_method() << std::endl;
+        std::cout << "路径: " << parser->get_path() << std::endl;
+
+        ImageServerDEF::ByteView image_data = parser->get_image_data();
+        std::string_view filter = parser->get_filter_type();
+
+        std::cout << "滤镜类型: " << filter << std::endl;
+        std::cout << "图像数据大小: " << image_data.size << " 字节" << std::endl;
+
+        if (!image_data.empty()) {
+            debug_print_data(image_data.data, std::min(image_data.size, size_t(100)), "图像数据预览:");
+        }
+        std::cout << "================================" << std::endl;
+#endif
+        conn->in_flight = true;
+        _server.handle_request(*this, client_fd, *parser);
+
+        // 请求可能已同步完成（连接被复用或关闭），也可能已交给线程池
+        conn = _connections.get(client_fd);
+        if (!conn) {
+            return nullptr;
+        }
+        if (conn->in_flight) {
+            update_timer(*conn);
+            return nullptr;
+        }
+    }
+    return conn;
+}
+
+void Reactor::complete_request(int fd, bool keep_alive) {
+    Connection* conn = _connections.get(fd);
+    if (!conn) {
+        return;
+    }
+    if (!keep_alive || _draining) {
+        if (conn->parser.has_error() && !conn->lingering) {
+            start_lingering(*conn);
+            return;
+        }
+        close_connection(fd);
+        return;
+    }
+    // 复用解析器，已缓存的流水线数据会被立即解析
+    conn->in_flight = false;
+    conn->parser.reset();
+}
+
+void Reactor::start_lingering(Connection& conn) {
+    // 客户端可能仍在发送被拒绝的 body，此时直接关闭会因接收缓冲区中有未读数据而发出 RST，
+    // 客户端往往来不及读到响应。先半关闭（响应之后发出 FIN），丢弃之后收到的数据，
+    // 客户端关闭或超出时间、字节上限时再关闭
+    if (shutdown(conn.fd, SHUT_WR) < 0) {
+        close_connection(conn.fd);
+        return;
+    }
+    conn.lingering = true;
+    conn.lingered = 0;
+    update_timer(conn);
+}
+
+void Reactor::resume_connection(uint64_t handle, bool keep_alive) {
+    if (ConnectionTable::is_stream_handle(handle)) {
+        // 流上的请求没有给出响应就结束，由处理器重置该流，连接不受影响
+        Connection* conn = _connections.get(ConnectionTable::handle_fd(handle));
+        if (conn && conn->handler && !keep_alive) {
+            std::shared_ptr<StreamHandler> handler = conn->handler;
+            handler->on_abort(ConnectionTable::handle_token(handle));
+        }
+        return;
+    }
+    Connection* conn = _connections.get_by_handle(handle);
+    if (!conn) {
+        return;
+    }
+    int fd = conn->fd;
+    complete_request(fd, keep_alive);
+    // 处理期间到达的数据在 ET 模式下不会再次通知，这里主动读取
+    handle_client_data(fd);
+}
+
+void Reactor::attach_handler(int fd, std::shared_ptr<StreamHandler> handler) {
+    Connection* conn = _connections.get(fd);
+    if (!conn) {
+        return;
+    }
+    conn->handler = handler;
+    conn->in_flight = false;
+    update_timer(*conn);
+
+    // 与请求头一起收到的数据已缓存在解析器中
+    std::string pending = conn->parser.take_pipelined();
+    uint64_t handle = ConnectionTable::make_handle(*conn);
+    if (!pending.empty() && !handler->on_data(pending.data(), pending.size()) && _connections.get_by_handle(handle)) {
+        close_connection(fd);
+    }
+}
+
+void Reactor::dispatch_stream(uint64_t stream_handle, HttpParser& parser) {
+    // 可能嵌套：h2c 升级请求在分发过程中接管连接，随即作为流 1 再次分发
+    uint64_t outer = _dispatching;
+    _dispatching = stream_handle;
+    _server.handle_request(*this, ConnectionTable::handle_fd(stream_handle), parser);
+    _dispatching = outer;
+}
+
+uint32_t Reactor::next_stream_token() {
+    _next_stream_token = (_next_stream_token + 1) & ConnectionTable::STREAM_TOKEN_MASK;
+    if (_next_stream_token == 0) {
+        _next_stream_token = 1;
+    }
+    return _next_stream_token;
+}
+
+size_t Reactor::queued_responses(uint64_t handle) const {
+    Connection* conn = ConnectionTable::is_stream_handle(handle)
+        ? _connections.get(ConnectionTable::handle_fd(handle)) : _connections.get_by_handle(handle);
+    return conn ? conn->out_queue.size() : SIZE_MAX;
+}
+
+uint64_t Reactor::handle_of(int fd) const {
+    if (_dispatching != 0 && ConnectionTable::handle_fd(_dispatching) == fd) {
+        return _dispatching;
+    }
+    Connection* conn = _connections.get(fd);
+    return conn ? ConnectionTable::make_handle(*conn) : 0;
+}
+
+void Reactor::deliver_to_stream(uint64_t stream_handle, HttpResponse response) {
+    Connection* conn = _connections.get(ConnectionTable::handle_fd(stream_handle));
+    if (!conn || !conn->handler) {
+        return;
+    }
+    // 处理器把响应转换为帧后经 send_response() 写出，此时不能再被当作流的响应
+    std::shared_ptr<StreamHandler> handler = conn->handler;
+    uint64_t outer = _dispatching;
+    _dispatching = 0;
+    handler->on_response(ConnectionTable::handle_token(stream_handle), std::move(response));
+    _dispatching = outer;
+}
+
+void Reactor::send_response(int fd, HttpResponse response) {
+    if (_dispatching != 0 && ConnectionTable::handle_fd(_dispatching) == fd) {
+        // Server 同步处理流上的请求时直接给出的响应
+        deliver_to_stream(_dispatching, std::move(response));
+        return;
+    }
+    Connection* conn_ptr = _connections.get(fd);
+    if (!conn_ptr) {
+        return;
+    }
+    Connection& conn = *conn_ptr;
+    if (_draining) {
+        // 排空期间告知客户端不再复用连接
+        response.set_keep_alive(false);
+    }
+    response.finish();
+    if (response.starts_stream()) {
+        conn.streaming = true;
+    } else if (response.ends_stream()) {
+        conn.streaming = false;
+    }
+    conn.out_queue.push_back(std::move(response));
+    flush(conn);
+}
+
+void Reactor::write_complete(Connection& conn) {
+    if (conn.handler) {
+        // 被接管的连接只在处理器发出 Connection: close 的响应后关闭
+        if (!conn.keep_alive_after_write) {
+            close_connection(conn.fd);
+            return;
+        }
+        update_timer(conn);
+        std::shared_ptr<StreamHandler> handler = conn.handler;
+        handler->on_writable();
+        return;
+    }
+    if (conn.streaming || !conn.in_flight) {
+        // 分块由线程池任务陆续交来，期间不计时；
+        // 请求尚未分发时发出的只能是 100 Continue，继续接收 body
+        update_timer(conn);
+        return;
+    }
+    complete_request(conn.fd, conn.keep_alive_after_write);
+}
+
+void Reactor::post_response(uint64_t handle, HttpResponse response) {
+    // std::function 要求可拷贝，响应通过 shared_ptr 传递
+    auto shared = std::make_shared<HttpResponse>(std::move(response));
+    post([this, handle, shared]() {
+        if (ConnectionTable::is_stream_handle(handle)) {
+            deliver_to_stream(handle, std::move(*shared));
+            return;
+        }
+        Connection* conn = _connections.get_by_handle(handle);
+        if (!conn) {
+            return;
+        }
+        int fd = conn->fd;
+        send_response(fd, std::move(*shared));
+        // 若响应已全部发出，继续处理该连接上的后续请求
+        handle_client_data(fd);
+    });
+}
+
+int Reactor::fill_iovecs(const Connection& conn, struct iovec* iov, int max_iov) {
+    // 将队列中所有待发送的头部和响应体合并为一次写出
+    int iov_count = 0;
+    for (const HttpResponse& response : conn.out_queue) {
+        if (iov_count == max_iov) break;
+        iov_count += response.fill_iovec(iov + iov_count, max_iov - iov_count);
+    }
+    return iov_count;
+}
+
+bool Reactor::consume_sent(Connection& conn, size_t sent) {
+    // 处理部分写入：依次记录各响应已发送的字节
+    size_t remaining = sent;
+    while (!conn.out_queue.empty()) {
+        HttpResponse& front = conn.out_queue.front();
+        remaining -= front.consume(remaining);
+        if (!front.done()) break;
+        conn.keep_alive_after_write = front.keep_alive();
+        conn.out_queue.pop_front();
+    }
+    conn.last_activity = Connection::Clock::now();
+    return conn.out_queue.empty();
+}
+
+void Reactor::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        _pending_tasks.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    if (write(_wakeup_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        perror("eventfd write 出错");
+    }
+}
+
+void Reactor::begin_drain() {
+    if (_draining) {
+        return;
+    }
+    _draining = true;
+
+    // 新连接由接管监听 socket 的新进程接受
+    stop_accepting();
+    _listeners.clear();
+
+    // 空闲的 keep-alive 连接直接关闭；正在接收、处理或发送的请求完成后再关闭，
+    // 刚建立还未发来请求的连接由请求头超时兜底
+    // 被接管的长连接（推流等）没有自然的结束点，同样直接关闭，由客户端重连到新进程；
+    // HTTP/2 连接发出 GOAWAY，已开始的流完成后自行关闭
+    std::vector<int> idle;
+    std::vector<int> taken_over;
+    _connections.for_each([&idle, &taken_over](Connection& conn) {
+        if (conn.handler) {
+            taken_over.push_back(conn.fd);
+        } else if (conn.timeout == Connection::Timeout::IDLE) {
+            idle.push_back(conn.fd);
+        }
+    });
+    for (int fd : taken_over) {
+        Connection* conn = _connections.get(fd);
+        if (!conn || !conn->handler) {
+            continue;
+        }
+        std::shared_ptr<StreamHandler> handler = conn->handler;
+        if (!handler->on_drain() && _connections.get(fd)) {
+            idle.push_back(fd);
+        }
+    }
+    for (int fd : idle) {
+        if (_connections.get(fd)) {
+            close_connection(fd);
+        }
+    }
+
+    LOG_INFO("Reactor " + std::to_string(_id) + " 开始排空，剩余连接数: " + std::to_string(_open_connections));
+}
+
+void Reactor::run_pending_tasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        tasks.swap(_pending_tasks);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+void Reactor::update_timer(Connection& conn) {
+    Connection::Timeout next;
+    if (conn.lingering) {
+        next = Connection::Timeout::LINGER;
+    } else if (!conn.out_queue.empty()) {
+        next = Connection::Timeout::WRITE;
+    } else if (conn.handler) {
+        next = Connection::Timeout::STREAM;
+    } else if (conn.in_flight) {
+        next = Connection::Timeout::NONE;
+    } else if (conn.parser.is_receiving_body()) {
+        next = Connection::Timeout::BODY;
+    } else if (conn.parser.has_partial_headers() || conn.timeout == Connection::Timeout::HEADER) {
+        next = Connection::Timeout::HEADER;
+    } else {
+        next = Connection::Timeout::IDLE;
+    }
+
+    // 请求头和 body 的期限从进入该阶段时开始计算，不因收到数据而延长；
+    // 发送受阻时每次有进展都重新计时
+    if (next == conn.timeout && next != Connection::Timeout::WRITE) {
+        return;
+    }
+    conn.timeout = next;
+
+    auto now = TimerWheel::Clock::now();
+    switch (next) {
+        case Connection::Timeout::NONE:
+            _timers.cancel(conn.timer);
+            break;
+        case Connection::Timeout::HEADER:
+            _timers.schedule(conn.timer, now + _header_timeout);
+            break;
+        case Connection::Timeout::BODY:
+            conn.body_checkpoint = conn.parser.body_received();
+            _timers.schedule(conn.timer, now + _body_timeout);
+            break;
+        case Connection::Timeout::IDLE:
+            _timers.schedule(conn.timer, now + _keep_alive_timeout);
+            break;
+        case Connection::Timeout::WRITE:
+            _timers.schedule(conn.timer, now + _body_timeout);
+            break;
+        case Connection::Timeout::LINGER:
+            _timers.schedule(conn.timer, now + LINGER_TIME);
+            break;
+        case Connection::Timeout::STREAM:
+            _timers.schedule(conn.timer, conn.last_activity + _keep_alive_timeout);
+            break;
+    }
+}
+
+void Reactor::expire_timers() {
+    _timers.advance(TimerWheel::Clock::now(), [this](TimerNode& node) { handle_timeout(node); });
+}
+
+void Reactor::handle_timeout(TimerNode& node) {
+    Connection* conn = _connections.get_by_handle(node.data);
+    if (!conn) {
+        return;
+    }
+    int fd = conn->fd;
+    bool reply = false;
+
+    switch (conn->timeout) {
+        case Connection::Timeout::NONE:
+            return;
+        case Connection::Timeout::BODY: {
+            // 按周期检查速率：本周期内收到的数据达到最低速率则继续等待
+            size_t received = conn->parser.body_received();
+            size_t required = _min_body_rate * static_cast<size_t>(_body_timeout.count()) / 1000;
+            if (received - conn->body_checkpoint >= std::max<size_t>(required, 1)) {
+                conn->body_checkpoint = received;
+                _timers.schedule(conn->timer, TimerWheel::Clock::now() + _body_timeout);
+                return;
+            }
+            LOG_INFO("连接 fd=" + std::to_string(fd) + " body 接收过慢 (" + std::to_string(received) + " 字节)，关闭连接");
+            reply = true;
+            break;
+        }
+        case Connection::Timeout::HEADER:
+            LOG_INFO("连接 fd=" + std::to_string(fd) + " 请求头接收超时，关闭连接");
+            // 一个字节都没有收到时直接关闭
+            reply = conn->parser.has_partial_headers();
+            break;
+        case Connection::Timeout::IDLE:
+            LOG_DEBUG("连接 fd=" + std::to_string(fd) + " keep-alive 空闲超时");
+            break;
+        case Connection::Timeout::WRITE:
+            LOG_INFO("连接 fd=" + std::to_string(fd) + " 响应发送超时，关闭连接");
+            break;
+        case Connection::Timeout::LINGER:
+            LOG_DEBUG("连接 fd=" + std::to_string(fd) + " lingering 结束 (丢弃 " + std::to_string(conn->lingered) + " 字节)");
+            break;
+        case Connection::Timeout::STREAM: {
+            // 收到数据时不重新计时，到期时按最近一次活动时间判断；处理器仍有工作时继续等待
+            auto deadline = conn->last_activity + _keep_alive_timeout;
+            if (!conn->handler->idle()) {
+                deadline = TimerWheel::Clock::now() + _keep_alive_timeout;
+            }
+            if (deadline > TimerWheel::Clock::now()) {
+                _timers.schedule(conn->timer, deadline);
+                return;
+            }
+            LOG_INFO("连接 fd=" + std::to_string(fd) + " 长时间没有数据，关闭连接");
+            break;
+        }
+    }
+
+    if (!reply) {
+        close_connection(fd);
+        return;
+    }
+    // 回复 408 后关闭；停止读取，客户端不读取时由发送超时关闭
+    conn->in_flight = true;
+    conn->timeout = Connection::Timeout::NONE;
+    HttpResponse response(408, false);
+    response.set_content_type("text/plain");
+    response.set_body("Request Timeout");
+    send_response(fd, std::move(response));
+}
+
+void Reactor::reject_request(Connection& conn) {
+    int status = conn.parser.error_status();
+    int fd = conn.fd;
+    const char* reason = "Bad Request";
+    if (status == 413) {
+        reason = "Payload Too Large";
+    } else if (status == 431) {
+        reason = "Request Header Fields Too Large";
+    }
+    LOG_INFO("连接 fd=" + std::to_string(fd) + " 请求被拒绝 (" + std::to_string(status) + " " + reason + ")，关闭连接");
+
+    // 停止解析，响应发送完毕后半关闭并丢弃剩余的 body（start_lingering），之后关闭
+    conn.in_flight = true;
+    conn.timeout = Connection::Timeout::NONE;
+    HttpResponse response(status, false);
+    response.set_content_type("text/plain");
+    response.set_body(reason);
+    send_response(fd, std::move(response));
+}
@@ -3,492 +3,821 @@
 #include "utils.h"
 #include "HttpParser.h"
 #include "ImageProcessor.h"
+#include "EpollReactor.h"
+#ifdef HAVE_IO_URING
+#include "UringReactor.h"
+#endif
+#include "HttpResponse.h"
+#include "BatchResponse.h"
+#include "MjpegStream.h"
+#include "WebSocketSession.h"
+#include "Http2Session.h"
+#include "ConfigManager.h"
+#include "UnixSocket.h"
+#include <nlohmann/json.hpp>
 #include <iostream>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdexcept>
 #include <vector>
+#include <thread>
 #include <cstring>
+#include <cstdint>
+#include <cmath>
 #include <arpa/inet.h>
+#include <map>
 #include <Logger.h>
 
 using namespace std;
 
+namespace {
 
+constexpr int UNIX_LISTEN_BACKLOG = 10000;  // 与 TCP 监听队列一致
 
-#define TERMINAL_OUTPUT 0
+AdmissionController::Limits admission_limits() {
+    ConfigManager& config = ConfigManager::getInstance();
+    AdmissionController::Limits limits;
+    limits.max_tasks = static_cast<size_t>(std::max(1, config.getAdmissionMaxQueuedTasks()));
+    limits.max_bytes = static_cast<size_t>(std::max(1LL, config.getAdmissionMaxInflightBytes()));
+    limits.max_work = static_cast<size_t>(std::max(1, config.getAdmissionMaxWorkUnits()));
+    return limits;
+}
 
-// 调试工具函数
-void debug_print_data(const char* data, size_t len, const std::string& prefix = "") 
-{
-    #if TERMINAL_OUTPUT
-        if (!prefix.empty()) {
-            std::cout << prefix << std::endl;
+// 按 server.io_backend 创建 Reactor；io_uring 不可用（未编译或内核不支持）时回退到 epoll
+std::unique_ptr<Reactor> make_reactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                                      const std::vector<ListenSocket>& inherited) {
+    std::string backend = ConfigManager::getInstance().getIOBackend();
+    if (backend == "io_uring") {
+#ifdef HAVE_IO_URING
+        // 构造失败时基类会关闭监听 socket，接管的 socket 先复制一份，原件留给 epoll 回退使用
+        std::vector<ListenSocket> copies;
+        for (const ListenSocket& listener : inherited) {
+            copies.push_back({listener.port, fcntl(listener.fd, F_DUPFD_CLOEXEC, 0), listener.unix_address});
         }
-        
-        std::cout << "数据长度: " << len << " 字节" << std::endl;
-        
-        // 十六进制输出
-        // std::cout << "Hex: ";
-        // for (size_t i = 0; i < std::min(len, size_t(50)); ++i) {
-        //     printf("%02x ", (unsigned char)data[i]);
-        // }
-        // if (len > 50) std::cout << "...";
-        // std::cout << std::endl;
-        
-        // 字符串输出
-        std::cout << "String: " << std::string(data, std::min(len, size_t(100))) << std::endl;
-        std::cout << "---" << std::endl;
-    # else
-        if (!prefix.empty()) {
-            LOG_INFO(prefix);
+        try {
+            auto reactor = std::make_unique<UringReactor>(id, server, addr, ports, copies);
+            for (const ListenSocket& listener : inherited) close(listener.fd);
+            return reactor;
+        } catch (const std::runtime_error& e) {
+            LOG_ERROR("Reactor " + std::to_string(id) + " 无法使用 io_uring，回退到 epoll: " + e.what());
         }
-        
-        // LOG_INFO("<<< 数据长度: " + std::to_string(len) + " 字节") ;
-        
-        // // 十六进制输出
-        // std::cout << "Hex: ";
-        // for (size_t i = 0; i < std::min(len, size_t(50)); ++i) {
-        //     printf("%02x ", (unsigned char)data[i]);
-        // }
-        // if (len > 50) std::cout << "...";
-        // std::cout << std::endl;
-        
-        // 字符串输出
-        LOG_INFO( "First 100 Bytes: \n" + std::string(data, std::min(len, size_t(100)))+
-        "\n-----100 Bytes end-----");
-    #endif
+#else
+        LOG_ERROR("编译时未启用 io_uring (未找到 liburing)，使用 epoll");
+#endif
+    } else if (backend != "epoll") {
+        LOG_ERROR("未知的 io_backend: " + backend + "，使用 epoll");
+    }
+    return std::make_unique<EpollReactor>(id, server, addr, ports, inherited);
 }
 
+// 原始 body 上传（/process、/detect、/segment）接受的 Content-Type，未指定时也接受
+bool is_raw_image_type(std::string_view content_type) {
+    return content_type.empty() || content_type.substr(0, 6) == "image/"
+        || content_type.substr(0, 24) == "application/octet-stream";
+}
 
+void reject_media_type(Reactor& reactor, int client_fd, bool keep_alive) {
+    HttpResponse response(415, keep_alive);
+    response.set_content_type("text/plain");
+    response.set_body(std::string_view("Content-Type 须为 image/* 或 application/octet-stream"));
+    reactor.send_response(client_fd, std::move(response));
+}
 
-// 安全发送函数，检查send是否成功
-bool safe_send(int fd, const void* data, size_t len) {
-    if (fd < 0 || !data || len == 0) {
-        std::cerr << "safe_send: 无效参数" << std::endl;
-        return false;
-    }
-    
-    const char* buffer = static_cast<const char*>(data);
-    size_t total_sent = 0;
-    
-    while (total_sent < len) {
-        ssize_t sent = send(fd, buffer + total_sent, len - total_sent, MSG_NOSIGNAL);
-        
-        if (sent < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // 缓冲区满，等待一下再试
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
-            } else {
-                std::cerr << "send失败: " << strerror(errno) << " (fd=" << fd << ")" << std::endl;
-                return false;
+// 二值掩码的行优先游程编码：交替记录 0 和非 0 的长度，第一个总是 0 的长度（可能为 0）
+nlohmann::json encode_mask_rle(const cv::Mat& mask) {
+    nlohmann::json counts = nlohmann::json::array();
+    bool current = false;
+    uint32_t run = 0;
+    for (int y = 0; y < mask.rows; ++y) {
+        const uchar* row = mask.ptr<uchar>(y);
+        for (int x = 0; x < mask.cols; ++x) {
+            bool value = row[x] != 0;
+            if (value != current) {
+                counts.push_back(run);
+                run = 0;
+                current = value;
             }
-        } else if (sent == 0) {
-            // 连接已关闭
-            std::cerr << "连接已关闭 (fd=" << fd << ")" << std::endl;
-            return false;
+            ++run;
         }
-        
-        total_sent += sent;
     }
-    
-    // std::cout << "成功发送 " << total_sent << " 字节到客户端 fd=" << fd << std::endl;
-    LOG_INFO("成功发送 " + std::to_string(total_sent) + " 字节到客户端 fd=" + std::to_string(fd) );
-    return true;
+    counts.push_back(run);
+    return {{"size", {mask.rows, mask.cols}}, {"counts", std::move(counts)}};
 }
 
-// 发送HTTP响应
-bool send_http_response(int fd, const std::string& response) {
-    return safe_send(fd, response.c_str(), response.length());
+// 单个检测结果；置信度保留 4 位小数，让 JSON 保持简短
+nlohmann::json object_json(int class_id, const std::string& class_name, float confidence, const cv::Rect& box) {
+    return {
+        {"class_id", class_id},
+        {"class", class_name},
+        {"confidence", std::round(static_cast<double>(confidence) * 10000.0) / 10000.0},
+        {"box", {box.x, box.y, box.width, box.height}}
+    };
 }
 
-// 发送图像数据
-bool send_image_data(int fd, const std::vector<char>& image_data) {
-    return safe_send(fd, image_data.data(), image_data.size());
-}
+// 批量请求中的一张图像
+struct BatchItem {
+    size_t index;  // 在请求中的序号
+    std::string name;
+    std::vector<char> data;
+    std::string filter;
+    std::string blur_intensity;
+    std::string sharpen_intensity;
+};
+
+// 处理一个批量任务：YOLO 任务中的图像合并推理，其他任务只有一张图像
+void run_batch_task(const std::vector<BatchItem>& items, BatchResponse& response) {
+    const std::string& filter = items.front().filter;
+    if (ImageProcessor::isYOLOFilter(filter)) {
+        std::vector<ImageServerDEF::ByteView> inputs;
+        for (const BatchItem& item : items) {
+            inputs.emplace_back(item.data);
+        }
+        std::vector<cv::Mat> outputs;
+        ImageProcessor::renderYOLOBatch(inputs, filter, outputs);
+        for (size_t i = 0; i < items.size(); ++i) {
+            std::vector<char> encoded;
+            if (!outputs[i].empty() && !ImageProcessor::encode(outputs[i], "image/jpeg", encoded)) {
+                encoded.clear();
+            }
+            response.complete(items[i].index, items[i].name, "image/jpeg", std::move(encoded));
+        }
+        return;
+    }
 
+    for (const BatchItem& item : items) {
+        std::vector<char> encoded;
+        std::string content_type = "image/jpeg";
+        if (!ImageProcessor::process(item.data, encoded, item.filter, content_type,
+                                     item.blur_intensity, item.sharpen_intensity)) {
+            encoded.clear();
+        }
+        response.complete(item.index, item.name, content_type, std::move(encoded));
+    }
+}
 
+} // namespace
 
-// 支持百万级并发的配置
-constexpr int MAX_EVENTS = 10000;  // 增加单次epoll_wait处理的事件数
-constexpr int BUFFER_SIZE = 8192;  // 增加缓冲区大小
-constexpr int MAX_CONNECTIONS = 1000000;  // 最大连接数限制
 
-// SocketGuard 的析构函数，确保 socket 被关闭
-SocketGuard::~SocketGuard() {
-    if (_fd >= 0) {
-        ::close(_fd);
+// RequestGuard 的析构函数，任务未交还响应（例如抛出异常）时关闭连接
+RequestGuard::~RequestGuard() {
+    if (!_responded) {
+        Reactor* reactor = &_reactor;
+        uint64_t handle = _handle;
+        reactor->post([reactor, handle] { reactor->resume_connection(handle, false); });
     }
 }
 
-Server::Server(const char *addr,const std::vector<int>& ports, int thread_num)
-    : _addr(addr),_ports(ports), _epoll_fd(-1), _thread_pool(thread_num), _current_connections(0) {
-
+void RequestGuard::respond(HttpResponse response) {
+    _responded = true;
+    _reactor.post_response(_handle, std::move(response));
+}
 
-    // std::cout<<"Server() this->_addr: "<<this->_addr<<endl;// 输出 this->_addr: 1
-    // 绑定，监听,, ip + port
-    setup_listening_sockets();
+void RequestGuard::begin_stream(HttpResponse head) {
+    head.set_chunked();
+    _reactor.post_response(_handle, std::move(head));
+}
 
-    _epoll_fd = epoll_create1(0);
-    if (_epoll_fd == -1) {
-        throw std::runtime_error("无法创建 epoll 实例");
+void RequestGuard::send_chunk(std::vector<char> data) {
+    // 长度为 0 的分块表示响应结束
+    if (!data.empty()) {
+        _reactor.post_response(_handle, HttpResponse::chunk(std::move(data)));
     }
+}
 
-    // 将所有监听socket添加到epoll
-    for (int listen_fd : _listen_fds) {
-        epoll_event event;
-        event.events = EPOLLIN;
-        event.data.fd = listen_fd;
-        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == -1) {
-            throw std::runtime_error("无法将监听 socket " + std::to_string(listen_fd) + " 添加到 epoll");
-        }
-    }
-    
-    // std::cout << "服务器配置: 监听端口数=" << _ports.size() 
-    //           << ", 最大连接数=" << MAX_CONNECTIONS 
-    //           << ", 单次事件处理数=" << MAX_EVENTS 
-    //           << ", 缓冲区大小=" << BUFFER_SIZE << " 字节" << std::endl;
+void RequestGuard::end_stream() {
+    _responded = true;
+    _reactor.post_response(_handle, HttpResponse::last_chunk(_keep_alive));
 }
 
-Server::~Server() {
-    // 关闭所有监听socket
-    for (int listen_fd : _listen_fds) {
-        if (listen_fd != -1) close(listen_fd);
+Server::Server(const char *addr,const std::vector<int>& ports, int thread_num, int reactor_num,
+               const std::vector<ListenSocket>& inherited)
+    : _addr(addr),_ports(ports), _thread_pool(thread_num), _static_assets("web"),
+      _admission(admission_limits(), ConfigManager::getInstance().getAdmissionRetryAfterSeconds()),
+      _current_connections(0) {
+
+    ConfigManager& config = ConfigManager::getInstance();
+    _streaming_enabled = config.isStreamingEnabled();
+    _stream_min_pixels = static_cast<size_t>(std::max(0, config.getStreamingMinPixels()));
+    _stream_chunk_size = static_cast<size_t>(std::max(4096, config.getStreamingChunkSize()));
+    _batch_max_images = static_cast<size_t>(std::max(1, config.getBatchMaxImages()));
+    _yolo_batch_size = static_cast<size_t>(std::max(1, config.getBatchYOLOBatchSize()));
+    _http2_enabled = config.isHttp2Enabled();
+
+    // 启动时一次性加载 web 目录，之后只在文件变化时重新加载
+    _static_assets.load();
+    _static_assets.watch();
+
+    if (reactor_num < 1) {
+        reactor_num = 1;
     }
-    if (_epoll_fd != -1) close(_epoll_fd);
-}
 
-void Server::setup_listening_sockets() {
-    // 多个端口
-    for (int port : _ports) {
-        int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-        if (listen_fd == -1) {
-            throw std::runtime_error("无法创建 socket 用于端口 " + std::to_string(port));
+    // 接管的监听 socket 按端口轮流分配，每个都有 Reactor 负责 accept；
+    // 数量不足时其余 Reactor 自行创建 SO_REUSEPORT socket 加入同一端口
+    std::vector<std::vector<ListenSocket>> assigned(reactor_num);
+    std::map<int, int> assigned_per_port;
+    std::vector<ListenSocket> inherited_unix;
+    for (const ListenSocket& listener : inherited) {
+        if (!listener.unix_address.empty()) {
+            inherited_unix.push_back(listener);
+            continue;
         }
+        assigned[assigned_per_port[listener.port]++ % reactor_num].push_back(listener);
+    }
 
-        // 允许地址重用
-        int reuse = 1;
-        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
-        
-        // 设置发送和接收缓冲区大小
-        int send_buf_size = 4096;
-        int recv_buf_size = 4096;
-        setsockopt(listen_fd, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size));
-        setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &recv_buf_size, sizeof(recv_buf_size));
-        
-        // 设置TCP_NODELAY，减少延迟
-        // int tcp_nodelay = 1;
-        // setsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &tcp_nodelay, sizeof(tcp_nodelay));
-
-        sockaddr_in server_addr;
-        server_addr.sin_family = AF_INET;
-        // server_addr.sin_addr.s_addr = INADDR_ANY;
-        // server_addr.sin_addr.s_addr = inet_addr("192.168.25.130");
-        server_addr.sin_addr.s_addr = inet_addr(this->_addr);
-        // std::cout<<"set_up this->_addr: "<<this->_addr<<endl;// 输出 this->_addr: 1
-        server_addr.sin_port = htons(port);
-
-        if (bind(listen_fd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-            close(listen_fd);
-            throw std::runtime_error("无法绑定到端口 " + std::to_string(port));
+    // Unix 域 socket 不能多次绑定同一地址：每个地址只有一个监听 socket（热重启时从旧进程接管），
+    // 每个 Reactor 各持有一份复制的 fd 加入自己的事件循环
+    for (const std::string& address : config.getServerUnixSockets()) {
+        int listen_fd = -1;
+        for (ListenSocket& listener : inherited_unix) {
+            if (listener.fd != -1 && listener.unix_address == address) {
+                // 旧进程的每个 Reactor 都交来一份，保留一个即可
+                if (listen_fd == -1) {
+                    listen_fd = listener.fd;
+                } else {
+                    close(listener.fd);
+                }
+                listener.fd = -1;
+            }
         }
-
-        // 增加监听队列大小，支持更多待处理连接
-        int listen_backlog = 10000;
-        if (listen(listen_fd, listen_backlog) < 0) {
-            close(listen_fd);
-            throw std::runtime_error("无法监听端口 " + std::to_string(port));
+        if (listen_fd == -1) {
+            listen_fd = unix_socket::listen(address, UNIX_LISTEN_BACKLOG);
+        }
+        for (int i = 0; i < reactor_num; ++i) {
+            int copy = fcntl(listen_fd, F_DUPFD_CLOEXEC, 0);
+            if (copy == -1) {
+                close(listen_fd);
+                throw std::runtime_error("无法复制 " + address + " 的监听socket");
+            }
+            assigned[i].push_back({0, copy, address});
+        }
+        close(listen_fd);
+        LOG_INFO("监听 " + address);
+    }
+    for (const ListenSocket& listener : inherited_unix) {
+        if (listener.fd != -1) {
+            // 配置中已删除的地址
+            close(listener.fd);
         }
+    }
 
-        set_non_blocking(listen_fd);
-        
-        _listen_fds.push_back(listen_fd);
-        
-        // std::cout << "端口 " << port << " 监听socket配置: 发送缓冲区=" << send_buf_size 
-        //           << " 字节, 接收缓冲区=" << recv_buf_size 
-        //           << " 字节, 监听队列=" << listen_backlog << std::endl;
-        LOG_INFO( "端口 " + std::to_string(port) + " 监听socket配置: 发送缓冲区=" + std::to_string(send_buf_size)
-            + " 字节, 接收缓冲区=" + std::to_string(recv_buf_size)
-            + " 字节, 监听队列=" + std::to_string(listen_backlog) );
+    // 每个 Reactor 各自绑定，监听所有端口 (SO_REUSEPORT)
+    for (int i = 0; i < reactor_num; ++i) {
+        _reactors.push_back(make_reactor(i, *this, _addr, _ports, assigned[i]));
+    }
 
+    LOG_INFO("服务器配置: Reactor数=" + std::to_string(_reactors.size())
+        + " (" + _reactors[0]->backend_name() + ")"
+        + ", 监听端口数=" + std::to_string(_ports.size()));
+}
 
+Server::~Server() {
+    // 先等线程池任务执行完（它们会向 Reactor 投递响应），再销毁 Reactor
+    _thread_pool.shutdown();
+    _reactors.clear();
+}
+
+void Server::start_listening() {
+    for (auto& reactor : _reactors) {
+        reactor->start_listening();
     }
-    
-    // std::cout << "共创建 " << _listen_fds.size() << " 个监听socket" << std::endl;
-    LOG_INFO("共创建 " + std::to_string(_listen_fds.size()) + " 个监听socket");
 }
 
 void Server::run() {
-    std::vector<epoll_event> events(MAX_EVENTS);
-    while (true) {
-        int n = epoll_wait(_epoll_fd, events.data(), MAX_EVENTS, -1);
-        if (n < 0) {
-            if (errno == EINTR) continue;
-            perror("epoll_wait 出错");
-            break;
-        }
+    // 未调用 start_listening() 时在这里开始监听（已调用时不重复）
+    start_listening();
 
-        for (int i = 0; i < n; ++i) {
-            // 检查是否是监听socket
-            bool is_listen_socket = false;
-            for (int listen_fd : _listen_fds) {
-                if (events[i].data.fd == listen_fd) {
-                    handle_new_connection(listen_fd);
-                    is_listen_socket = true;
-                    break;
-                }
-            }
-            
-            if (!is_listen_socket) {
-                handle_client_data(events[i].data.fd);
-            }
+    // Reactor 0 在当前线程运行，其余各占一个线程
+    std::vector<std::thread> reactor_threads;
+    for (size_t i = 1; i < _reactors.size(); ++i) {
+        reactor_threads.emplace_back([this, i] { _reactors[i]->run(); });
+    }
+
+    _reactors[0]->run();
+
+    for (std::thread& t : reactor_threads) {
+        if (t.joinable()) {
+            t.join();
         }
     }
 }
 
-void Server::handle_new_connection(int listen_fd) {
-    // 检查连接数限制
-    if (_current_connections >= MAX_CONNECTIONS) {
-        std::cout << "达到最大连接数限制 (" << MAX_CONNECTIONS << ")，拒绝新连接" << std::endl;
-        return;
+void Server::begin_drain() {
+    for (auto& reactor : _reactors) {
+        Reactor* target = reactor.get();
+        target->post([target] { target->begin_drain(); });
     }
-    
-    sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    int client_fd = accept(listen_fd, (sockaddr*)&client_addr, &client_len);
-    if (client_fd < 0) {
-        // 在 ET 模式下，需要处理所有排队的连接
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-             return;
-        }
-        perror("accept 出错");
-        return;
+}
+
+std::vector<ListenSocket> Server::listen_sockets() const {
+    std::vector<ListenSocket> sockets;
+    for (const auto& reactor : _reactors) {
+        const std::vector<ListenSocket>& listeners = reactor->listen_sockets();
+        sockets.insert(sockets.end(), listeners.begin(), listeners.end());
     }
+    return sockets;
+}
+
+void Server::handle_request(Reactor& reactor, int client_fd, HttpParser& parser) {
+    std::string_view method = parser.get_method();
+    std::string_view path = parser.get_path();
+    std::string_view route = path.substr(0, path.find('?'));  // 去掉查询字符串
+    bool keep_alive = parser.keep_alive();
 
-    set_non_blocking(client_fd);
-    
-    _current_connections++;
-    
-    // 获取客户端连接的端口信息
-    char client_ip[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
-    int client_port = ntohs(client_addr.sin_port);
-    
-    // std::cout << "接受新连接，fd = " << client_fd 
-    //           << " 来自 " << client_ip << ":" << client_port
-    //           << " (当前连接数: " << _current_connections << "/" << MAX_CONNECTIONS << ")" << std::endl;
-
-
-    LOG_INFO("接受新连接，fd = " + std::to_string(client_fd) 
-              + " 来自 " + client_ip + ":" + std::to_string(client_port)
-              + " (当前连接数: " + std::to_string(_current_connections) 
-              + "/" + std::to_string(MAX_CONNECTIONS) + ")" ); 
-
-    epoll_event event;
-    event.events = EPOLLIN | EPOLLET; // 使用边缘触发
-    event.data.fd = client_fd;
-    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client_fd, &event) == -1) {
-        perror("无法将客户端 socket 添加到 epoll");
-        close(client_fd);
-        _current_connections--;
+    // 只有推流接管连接后自行解码请求体；其他请求无法确定 body 在哪里结束，
+    // 后续数据不能当作下一个请求处理，回复 501 并关闭连接
+    if (parser.has_transfer_encoding() && !(route == "/stream" && method == "POST")) {
+        reactor.send_response(client_fd, HttpResponse(501, false));
         return;
     }
-    _client_parsers[client_fd] = std::make_unique<HttpParser>();
-}
 
-void Server::handle_client_data(int client_fd) {
-    std::vector<char> buffer(BUFFER_SIZE);
-    
-    HttpParser* parser = _client_parsers[client_fd].get();
-
-    while(true) {
-        ssize_t bytes_read = recv(client_fd, buffer.data(), BUFFER_SIZE, 0);
-        // cout<<"bytes_read:"<<bytes_read<<endl;
-        if (bytes_read == -1) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // ET 模式下，数据已读完
-                break;
-            }
-            perror("recv 出错");
-            close_connection(client_fd);
+    // HTTP/2 流上的请求已转换为 HTTP/1.1 格式，不会再次升级
+    if (_http2_enabled && !ConnectionTable::is_stream_handle(reactor.handle_of(client_fd))) {
+        if (method == "PRI" && path == "*" && parser.get_version() == "HTTP/2.0") {
+            serve_http2(reactor, client_fd, parser, false);
             return;
-        } else if (bytes_read == 0) {
-            // 客户端关闭连接
-            // std::cout << "客户端 fd=" << client_fd << " 断开连接" << std::endl;
-            LOG_INFO("客户端 fd=" + std::to_string(client_fd) + " 断开连接"); 
-            close_connection(client_fd);
+        }
+        if (parser.get_version() == "HTTP/1.1" && HttpScanner::contains_ci(parser.get_header("Upgrade"), "h2c")
+            && parser.get_header("HTTP2-Settings").data() != nullptr) {
+            serve_http2(reactor, client_fd, parser, true);
             return;
         }
-
-
-        // 使用调试函数输出读取的数据
-        if(bytes_read>5 && buffer[0]=='P' && buffer[1]=='O'&& buffer[2]=='S'&& buffer[3]=='T')
-            debug_print_data(buffer.data(), bytes_read, "<<< 接收客户端 fd=" + std::to_string(client_fd) 
-            + " 的POST数据头, 数据长度="+std::to_string(bytes_read));
-        parser->parse(buffer.data(), bytes_read);
     }
 
+    if (method == "GET" && route == "/stats") {
+        serve_stats(reactor, client_fd, keep_alive);
+    }
+    else if (method == "GET" && route == "/ws") {
+        serve_websocket(reactor, client_fd, parser);
+    }
+    else if (method == "GET") {
+        // 提供 HTML 页面等静态资源
+        serve_static(reactor, client_fd, parser, keep_alive);
+    } 
+    else if (route == "/upload" && method == "POST") 
+    {
+        // cout<<"POST 方法，上传了图片，需要处理"<<endl;
+        // 将图像处理任务添加到线程池
+        // 图片缓冲区从解析器移入任务；文本字段很短，拷贝一份随任务保存
+        std::vector<char> image_data = parser.take_image();
+        std::string filter(parser.get_filter_type());
+        std::string_view image_uuid = parser.get_image_uuid();
+        std::string blur_intensity(parser.get_blur_intensity());
+        std::string sharpen_intensity(parser.get_sharpen_intensity());
+        // cout<<"filter: "<<filter<<"\nuuid: "<<image_uuid<<"\nblur_intensity: "<<blur_intensity<<"\nsharpen_intensity: "<<sharpen_intensity<<endl;
+        LOG_INFO("POST DESC:\nfilter: "+filter+"\nuuid: "+std::string(image_uuid)+"\nblur_intensity: "
+            +blur_intensity+"\nsharpen_intensity: "+sharpen_intensity);
+        
+        // // 保存原始图片到根目录
+        // std::string saved_filename = save_image(image_data);
+        // if (!saved_filename.empty()) {
+        //     std::cout << "图片已保存到根目录: " << saved_filename << std::endl;
+        // } else {
+        //     std::cout << "图片保存失败" << std::endl;
+        // }
 
-    // cout<<"读取完数据"<<endl;
-    // cout<<"parser->is_request_ready():"<<parser->is_request_ready()<<endl;
+			                
+			// // 计算并输出MD5值
+			// std::string md5_hash = calculate_md5(image_data);
+			// std::cout << "原始图片MD5值: " << md5_hash << std::endl;
 
-    // 输出解析后的HTTP信息
-    if(parser->is_request_ready()) {
-#if DEBUG_OUTPUT
-        std::cout << "=== HTTP请求解析完成 ===" << std::endl;
-        std::cout << "方法: " << parser->get_method() << std::endl;
-        std::cout << "路径: " << parser->get_path() << std::endl;
-        
-        std::vector<char> image_data = parser->get_image_data();
-        std::string filter = parser->get_filter_type();
-        
-        std::cout << "滤镜类型: " << filter << std::endl;
-        std::cout << "图像数据大小: " << image_data.size() << " 字节" << std::endl;
-        
-        if (!image_data.empty()) {
-            debug_print_data(image_data.data(), std::min(image_data.size(), size_t(100)), "图像数据预览:");
+        submit_image_task(reactor, client_fd, keep_alive, parser.get_version() == "HTTP/1.1", std::move(image_data),
+                          std::move(filter), std::move(blur_intensity), std::move(sharpen_intensity));
+    }
+    else if (route == "/process" && method == "POST")
+    {
+        // 机器调用的快速路径：body 就是图片本身，参数放在查询字符串中，不经过 multipart 解析
+        // Reactor 通过 body_window() 读入的缓冲区直接移入任务
+        if (!is_raw_image_type(parser.get_header(HeaderId::CONTENT_TYPE))) {
+            reject_media_type(reactor, client_fd, keep_alive);
+            return;
         }
-        std::cout << "================================" << std::endl;
-#endif
+        std::vector<char> image_data = parser.take_body();
+        if (image_data.empty()) {
+            reactor.send_response(client_fd, HttpResponse(400, keep_alive));
+            return;
+        }
+        std::string_view query = parser.get_query();
+        std::string filter = get_query_param(query, "filter");
+        std::string blur_intensity = get_query_param(query, "blur_intensity");
+        std::string sharpen_intensity = get_query_param(query, "sharpen_intensity");
+        LOG_INFO("POST /process:\nfilter: "+filter+"\nsize: "+std::to_string(image_data.size())+"\nblur_intensity: "
+            +blur_intensity+"\nsharpen_intensity: "+sharpen_intensity);
+
+        submit_image_task(reactor, client_fd, keep_alive, parser.get_version() == "HTTP/1.1", std::move(image_data),
+                          std::move(filter), std::move(blur_intensity), std::move(sharpen_intensity));
+    }
+    else if (route == "/batch" && method == "POST")
+    {
+        serve_batch(reactor, client_fd, parser, keep_alive);
+    }
+    else if ((route == "/detect" || route == "/segment") && method == "POST")
+    {
+        serve_detection(reactor, client_fd, parser, keep_alive, route == "/segment");
+    }
+    else if (route == "/stream" && method == "POST")
+    {
+        serve_stream(reactor, client_fd, parser);
+    } else {
+         reactor.send_response(client_fd, HttpResponse(404, keep_alive));
     }
+}
 
-    if(parser->is_request_ready()) {
-        std::string path = parser->get_path();
+void Server::serve_stream(Reactor& reactor, int client_fd, HttpParser& parser) {
+    // 响应是无限长的 chunked 流，需要 HTTP/1.1；请求体带 Content-Length 时已按普通请求整体接收
+    bool chunked_input = HttpScanner::contains_ci(parser.get_header("Transfer-Encoding"), "chunked");
+    if (parser.get_version() != "HTTP/1.1" || !parser.is_multipart()
+        || parser.get_header(HeaderId::CONTENT_LENGTH).data() != nullptr) {
+        HttpResponse response(400, false);
+        response.set_content_type("text/plain");
+        response.set_body(std::string_view("推流需要 HTTP/1.1、multipart 请求体且不带 Content-Length"));
+        reactor.send_response(client_fd, std::move(response));
+        return;
+    }
 
-        if (path == "/" && parser->get_method() == "GET") {
-            // 提供 HTML 页面
-            // cout<<"GET方法，需要 提供 HTML 页面"<<endl;
-            std::string html_content = load_file("web/index.html");
-            if (!html_content.empty()) {
-                std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " + std::to_string(html_content.length()) + "\r\n\r\n" + html_content;
-                // send(client_fd, response.c_str(), response.length(), 0);
-                LOG_INFO("response to fd="+std::to_string(client_fd) 
-                                +":\n HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " 
-                                + std::to_string(html_content.length())  
-                                + "\r\n\r\n[Serving file: web/index.htm]");
+    // 推流期间一直占用一个任务名额，限制同时推流的连接数
+    std::optional<AdmissionController::Ticket> ticket =
+        _admission.try_admit(0, AdmissionController::estimate_work("yolo_detect", 0));
+    if (!ticket) {
+        reject_overloaded(reactor, client_fd, false);
+        return;
+    }
 
+    ConfigManager& config = ConfigManager::getInstance();
+    size_t max_frame_size = std::min(static_cast<size_t>(std::max(0, config.getMaxImageSize())), ImageServerDEF::MAX_IMAGE_SIZE);
+    auto stream = std::make_shared<MjpegStream>(reactor, reactor.handle_of(client_fd), _thread_pool,
+                                                std::string(parser.get_boundary()), chunked_input,
+                                                max_frame_size, std::move(*ticket));
+    LOG_INFO("推流开始 fd=" + std::to_string(client_fd) + (chunked_input ? " (chunked)" : ""));
+
+    bool expect_continue = HttpScanner::equals_ci(parser.get_header(HeaderId::EXPECT), "100-continue");
+    reactor.attach_handler(client_fd, stream);
+    if (expect_continue) {
+        // 没有 Content-Length 时解析器不会自动回复 100（curl 等待约 1 秒后才开始发送）
+        reactor.send_response(client_fd, HttpResponse(100, true));
+    }
+    reactor.send_response(client_fd, stream->response_head());
+}
 
-                if (!send_http_response(client_fd, response)) {
-                    std::cerr << "发送HTML页面失败，客户端fd=" << client_fd << std::endl;
-                }
+void Server::serve_websocket(Reactor& reactor, int client_fd, HttpParser& parser) {
+    if (!parser.is_websocket_upgrade()) {
+        reactor.send_response(client_fd, HttpResponse(400, false));
+        return;
+    }
+    if (parser.get_header("Sec-WebSocket-Version") != "13") {
+        HttpResponse response(426, parser.keep_alive());
+        response.add_header("Sec-WebSocket-Version", "13");
+        reactor.send_response(client_fd, std::move(response));
+        return;
+    }
 
+    HttpResponse response(101, true);
+    response.add_header("Upgrade", "websocket");
+    response.add_header("Connection", "Upgrade");
+    response.add_header("Sec-WebSocket-Accept", WebSocketParser::accept_key(parser.get_header("Sec-WebSocket-Key")));
+
+    // 单条消息最多是一张图像加上参数 JSON
+    ConfigManager& config = ConfigManager::getInstance();
+    size_t max_image_size = std::min(static_cast<size_t>(std::max(0, config.getMaxImageSize())), ImageServerDEF::MAX_IMAGE_SIZE);
+    auto session = std::make_shared<WebSocketSession>(reactor, reactor.handle_of(client_fd), _thread_pool,
+                                                      _admission, max_image_size + 64 * 1024);
+    LOG_INFO("WebSocket 连接 fd=" + std::to_string(client_fd));
+    reactor.attach_handler(client_fd, session);
+    reactor.send_response(client_fd, std::move(response));
+}
 
-            } else {
-                std::string response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+void Server::serve_http2(Reactor& reactor, int client_fd, HttpParser& parser, bool upgrade) {
+    std::string settings;
+    if (upgrade && !Http2Session::decode_upgrade_settings(parser.get_header("HTTP2-Settings"), settings)) {
+        reactor.send_response(client_fd, HttpResponse(400, false));
+        return;
+    }
 
+    ConfigManager& config = ConfigManager::getInstance();
+    Http2Session::Limits limits;
+    limits.max_header_size = static_cast<size_t>(std::max(1024, config.getMaxHeaderSize()));
+    limits.max_body_size = std::min(static_cast<size_t>(std::max(0, config.getMaxImageSize())), ImageServerDEF::MAX_IMAGE_SIZE);
+    limits.max_concurrent_streams = static_cast<uint32_t>(std::max(1, config.getHttp2MaxConcurrentStreams()));
+    limits.initial_window_size = static_cast<uint32_t>(std::max(65535, config.getHttp2InitialWindowSize()));
+    auto session = std::make_shared<Http2Session>(reactor, reactor.handle_of(client_fd), limits, upgrade);
+    LOG_INFO(std::string("HTTP/2 连接 fd=") + std::to_string(client_fd) + (upgrade ? " (Upgrade)" : ""));
+
+    // 先接管连接，与请求一起收到的前言和帧缓存在会话中，start() 之后再处理
+    reactor.attach_handler(client_fd, session);
+    if (upgrade) {
+        HttpResponse response(101, true);
+        response.add_header("Connection", "Upgrade");
+        response.add_header("Upgrade", "h2c");
+        reactor.send_response(client_fd, std::move(response));
+    }
+    session->start(settings, upgrade ? &parser : nullptr);
+}
 
-                //  send(client_fd, response.c_str(), response.length(), 0);
-                 if (!send_http_response(client_fd, response)) {
-                    LOG_INFO("response to fd=: "+std::to_string(client_fd) + response);
-                     std::cerr << "发送404响应失败，客户端fd=" << client_fd << std::endl;
-                 }
+void Server::submit_image_task(Reactor& reactor, int client_fd, bool keep_alive, bool chunked_allowed,
+                               std::vector<char> image_data, std::string filter,
+                               std::string blur_intensity, std::string sharpen_intensity) {
+    // 准入控制：排队任务数、在途字节数或估算工作量超限时直接回复 503，
+    // 不让任务在线程池队列中无限堆积
+    size_t work = AdmissionController::estimate_work(filter, image_data.size());
+    std::optional<AdmissionController::Ticket> ticket = _admission.try_admit(image_data.size(), work);
+    if (!ticket) {
+        reject_overloaded(reactor, client_fd, keep_alive);
+        return;
+    }
 
+    Reactor* owner = &reactor;
+    uint64_t conn_handle = reactor.handle_of(client_fd);
+    // chunked 是 HTTP/1.1 的编码，HTTP/1.0 客户端始终使用 Content-Length
+    size_t stream_min_pixels = _streaming_enabled && chunked_allowed ? _stream_min_pixels : SIZE_MAX;
+    size_t stream_chunk_size = _stream_chunk_size;
+    // ticket 随任务销毁时归还占用
+    _thread_pool.enqueue([owner, conn_handle, keep_alive, stream_min_pixels, stream_chunk_size, ticket = std::move(*ticket), image_data = std::move(image_data), filter = std::move(filter), blur_intensity = std::move(blur_intensity), sharpen_intensity = std::move(sharpen_intensity)]() {
+        // RAII 包装器，确保函数退出时（包括异常）把连接交还给 Reactor
+        // 响应交给 Reactor 异步发送，线程在编码完成后即可处理下一个任务
+        RequestGuard guard(*owner, conn_handle, keep_alive); 
+
+        cv::Mat rendered;
+        std::string content_type = "image/jpeg";
+        bool success = ImageProcessor::render(image_data, rendered, filter, content_type, blur_intensity, sharpen_intensity);
+
+        if (success && rendered.total() >= stream_min_pixels) {
+            // 大图先发响应头，编码出的分块随即交给 Reactor 发送，首字节不必等整张图编码完成
+            HttpResponse head(200, keep_alive);
+            head.set_content_type(content_type);
+            guard.begin_stream(std::move(head));
+            if (ImageProcessor::encodeChunked(rendered, content_type, stream_chunk_size,
+                    [&guard](std::vector<char> chunk) { guard.send_chunk(std::move(chunk)); })) {
+                guard.end_stream();
+                LOG_INFO("ImageProcessor State: 1 (chunked)");
+            } else {
+                // 响应头已发出，guard 析构时关闭连接，客户端收不到结束分块
+                LOG_ERROR("分块编码失败，响应头已发出，关闭连接 (filter=" + filter + ")");
             }
-             close_connection(client_fd);
-        } 
-        else if (path == "/upload" && parser->get_method() == "POST") 
-        {
-            // cout<<"POST 方法，上传了图片，需要处理"<<endl;
-            // 将图像处理任务添加到线程池
-            std::vector<char> image_data = parser->get_image_data();
-            std::string filter = parser->get_filter_type();
-            std::string image_uuid = parser->get_image_uuid();
-            std::string blur_intensity = parser->get_blur_intensity();
-            std::string sharpen_intensity = parser->get_sharpen_intensity();
-            // cout<<"filter: "<<filter<<"\nuuid: "<<image_uuid<<"\nblur_intensity: "<<blur_intensity<<"\nsharpen_intensity: "<<sharpen_intensity<<endl;
-            LOG_INFO("POST DESC:\nfilter: "+filter+"\nuuid: "+image_uuid+"\nblur_intensity: "
-                +blur_intensity+"\nsharpen_intensity: "+sharpen_intensity);
-            
-            // // 保存原始图片到根目录
-            // std::string saved_filename = save_image(image_data);
-            // if (!saved_filename.empty()) {
-            //     std::cout << "图片已保存到根目录: " << saved_filename << std::endl;
-            // } else {
-            //     std::cout << "图片保存失败" << std::endl;
-            // }
-
-			                
-			// // 计算并输出MD5值
-			// std::string md5_hash = calculate_md5(image_data);
-			// std::cout << "原始图片MD5值: " << md5_hash << std::endl;
-
+            return;
+        }
 
+        std::vector<char> processed_image;
+        success = success && ImageProcessor::encode(rendered, content_type, processed_image);
+        // std::cout<<"ImageProcessor State: "<<success<<endl;
+        LOG_INFO("ImageProcessor State: " + std::to_string(success));
+
+        // 保存处理后图片到根目录
+        // std::string saved_filename = save_image(processed_image);
+        // if (!saved_filename.empty()) {
+        //     std::cout << "图片已保存到根目录: " << saved_filename << std::endl;
+        // } else {
+        //     std::cout << "图片保存失败" << std::endl;
+        // }
 
-            _thread_pool.enqueue([client_fd, image_data = std::move(image_data), filter = std::move(filter), blur_intensity = std::move(blur_intensity), sharpen_intensity = std::move(sharpen_intensity)]() {
-                // RAII 包装器，确保函数退出时关闭 fd
-                SocketGuard sg(client_fd); 
+        if(success) {
+            // 响应头和图像数据作为两个 iovec 由 Reactor 一次写出，图像数据不再拷贝
+            HttpResponse response(200, keep_alive);
+            response.set_content_type(content_type);
+            response.set_body(std::move(processed_image));
+            guard.respond(std::move(response));
+        } else {
+            HttpResponse response(500, keep_alive);
+            response.set_content_type("text/plain");
+            response.set_body(std::string_view("图像处理失败"));
+            guard.respond(std::move(response));
+        }
+    });
 
-                std::vector<char> processed_image;
-                std::string content_type = "image/jpeg";
-                bool success = ImageProcessor::process(image_data, processed_image, filter, content_type, blur_intensity, sharpen_intensity);
-                // std::cout<<"ImageProcessor State: "<<success<<endl;
-                LOG_INFO("ImageProcessor State: " + std::to_string(success));
+    // 连接保留在 Reactor 中（暂停读取），任务完成后由 RequestGuard 交还
+}
 
-                // 保存处理后图片到根目录
-                // std::string saved_filename = save_image(processed_image);
-                // if (!saved_filename.empty()) {
-                //     std::cout << "图片已保存到根目录: " << saved_filename << std::endl;
-                // } else {
-                //     std::cout << "图片保存失败" << std::endl;
-                // }
+void Server::serve_batch(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive) {
+    std::vector<MultipartParser::FilePart> files = parser.take_files();
+    if (parser.multipart_failed() || files.empty()) {
+        reactor.send_response(client_fd, HttpResponse(400, keep_alive));
+        return;
+    }
+    if (files.size() > _batch_max_images) {
+        HttpResponse response(413, keep_alive);
+        response.set_content_type("text/plain");
+        response.set_body(std::string_view("图像数超过 batch.max_images"));
+        reactor.send_response(client_fd, std::move(response));
+        return;
+    }
 
-                std::string response;
-                bool send_success = false;
+    // 请求级的文本字段是默认参数，每个文件 part 可以用 X-Filter / X-Blur-Intensity /
+    // X-Sharpen-Intensity 头部单独指定
+    std::string_view default_filter = parser.get_filter_type();
+    std::string_view default_blur = parser.get_blur_intensity();
+    std::string_view default_sharpen = parser.get_sharpen_intensity();
+    auto part_param = [](const MultipartParser::FilePart& file, std::string_view header, std::string_view fallback) {
+        std::string_view value = file.header_value(header);
+        return std::string(value.empty() ? fallback : value);
+    };
+
+    // 分组：YOLO 滤镜相同的图像每 _yolo_batch_size 张合成一个任务（一次推理），其他图像各一个任务
+    std::vector<std::vector<BatchItem>> tasks;
+    std::map<std::string, size_t> filling;  // YOLO 滤镜 -> 正在填充的任务
+    size_t total_bytes = 0;
+    size_t total_work = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        MultipartParser::FilePart& file = files[i];
+        BatchItem item{i, file.name, std::move(file.data), part_param(file, "X-Filter", default_filter),
+                       part_param(file, "X-Blur-Intensity", default_blur),
+                       part_param(file, "X-Sharpen-Intensity", default_sharpen)};
+        total_bytes += item.data.size();
+        total_work += AdmissionController::estimate_work(item.filter, item.data.size());
+
+        if (!ImageProcessor::isYOLOFilter(item.filter)) {
+            tasks.emplace_back();
+            tasks.back().push_back(std::move(item));
+            continue;
+        }
+        auto it = filling.find(item.filter);
+        if (it == filling.end() || tasks[it->second].size() >= _yolo_batch_size) {
+            filling[item.filter] = tasks.size();
+            tasks.emplace_back();
+        }
+        tasks[filling[item.filter]].push_back(std::move(item));
+    }
 
+    // 准入控制：整批只申请一张 Ticket，所有任务共享，最后一个任务结束时归还。
+    // 图像数据在请求处理期间一直占用内存，总字节数超过上限的批量永远无法准入，直接回复 413；
+    // 工作量是估算值，整批按上限计，批量最多独占全部工作量预算，不会因任务拆分被反复拒绝
+    const AdmissionController::Limits& limits = _admission.limits();
+    if (total_bytes > limits.max_bytes) {
+        HttpResponse response(413, keep_alive);
+        response.set_content_type("text/plain");
+        response.set_body(std::string_view("批量图像总大小超过 admission.max_inflight_bytes"));
+        reactor.send_response(client_fd, std::move(response));
+        return;
+    }
+    std::optional<AdmissionController::Ticket> admitted =
+        _admission.try_admit(total_bytes, std::min(total_work, limits.max_work));
+    if (!admitted) {
+        reject_overloaded(reactor, client_fd, keep_alive);
+        return;
+    }
+    auto ticket = std::make_shared<AdmissionController::Ticket>(std::move(*admitted));
+    LOG_INFO("POST /batch: " + std::to_string(files.size()) + " 张图像, " + std::to_string(total_bytes)
+        + " 字节, " + std::to_string(tasks.size()) + " 个任务");
+
+    // 所有任务共享响应，最后一个完成的任务写出结束分隔符
+    auto response = std::make_shared<BatchResponse>(reactor, reactor.handle_of(client_fd), keep_alive,
+                                                    parser.get_version() == "HTTP/1.1", files.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        _thread_pool.enqueue([response, ticket, items = std::move(tasks[i])]() {
+            run_batch_task(items, *response);
+        });
+    }
 
-                if(success) {
-                    response = "HTTP/1.1 200 OK\r\nContent-Type: " + content_type + "\r\nContent-Length: " + std::to_string(processed_image.size()) + "\r\n\r\n";
-                    // // send(client_fd, response.c_str(), response.length(), 0);
-                    // send(client_fd, processed_image.data(), processed_image.size(), 0);
-                    LOG_INFO("response to fd="+std::to_string(client_fd)+ ":\n"+response + "[processed_image]");
-                    // 发送HTTP响应头
-                    if (!send_http_response(client_fd, response)) {
-                        std::cerr << "发送HTTP响应头失败，客户端fd=" << client_fd << std::endl;
-                        return;
-                    }
-                    
-                    // 发送图像数据
-                    if (!send_image_data(client_fd, processed_image)) {
-                        std::cerr << "发送图像数据失败，客户端fd=" << client_fd << std::endl;
-                        return;
-                    }
+    // 连接保留在 Reactor 中（暂停读取），最后一个任务完成后由 BatchResponse 交还
+}
 
+void Server::serve_detection(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive, bool segment) {
+    // 与 /upload 相同的 multipart image 字段，或与 /process 相同的原始 body
+    std::vector<char> image_data;
+    if (parser.is_multipart()) {
+        image_data = parser.take_image();
+    } else if (is_raw_image_type(parser.get_header(HeaderId::CONTENT_TYPE))) {
+        image_data = parser.take_body();
+    } else {
+        reject_media_type(reactor, client_fd, keep_alive);
+        return;
+    }
+    if (image_data.empty()) {
+        reactor.send_response(client_fd, HttpResponse(400, keep_alive));
+        return;
+    }
+    std::string masks = get_query_param(parser.get_query(), "masks");
+    bool with_masks = segment && (masks == "1" || masks == "true");
 
-                } else {
-                    std::string error_msg = "图像处理失败";
-                    response = "HTTP/1.1 500 Internal Server Error\r\nContent-Type: text/plain\r\nContent-Length: " + std::to_string(error_msg.length()) + "\r\n\r\n" + error_msg;
-                    // send(client_fd, response.c_str(), response.length(), 0);
-                    if (!send_http_response(client_fd, response)) {
-                        std::cerr << "发送错误响应失败，客户端fd=" << client_fd << std::endl;
-                        return;
-                    }
-                    send_success = true;
+    size_t work = AdmissionController::estimate_work(segment ? "yolo_segment" : "yolo_detect", image_data.size());
+    std::optional<AdmissionController::Ticket> ticket = _admission.try_admit(image_data.size(), work);
+    if (!ticket) {
+        reject_overloaded(reactor, client_fd, keep_alive);
+        return;
+    }
 
+    Reactor* owner = &reactor;
+    uint64_t conn_handle = reactor.handle_of(client_fd);
+    _thread_pool.enqueue([owner, conn_handle, keep_alive, segment, with_masks, ticket = std::move(*ticket), image_data = std::move(image_data)]() {
+        RequestGuard guard(*owner, conn_handle, keep_alive);
+
+        // 只保留推理结果：不克隆原图绘制，也不重新编码 JPEG
+        cv::Size image_size;
+        nlohmann::json objects = nlohmann::json::array();
+        bool success;
+        if (segment) {
+            std::vector<YOLOSegmentation> segmentations;
+            success = ImageProcessor::segmentImage(image_data, image_size, segmentations);
+            for (const YOLOSegmentation& segmentation : segmentations) {
+                nlohmann::json object = object_json(segmentation.class_id, segmentation.class_name,
+                                                    segmentation.confidence, segmentation.box);
+                if (with_masks) {
+                    // 掩码覆盖 box 范围
+                    object["mask"] = encode_mask_rle(segmentation.mask);
                 }
-                if (send_success) {
-                    std::cout << "图像处理请求完成，客户端fd=" << client_fd << std::endl;
-                }
-            });
+                objects.push_back(std::move(object));
+            }
+        } else {
+            std::vector<YOLODetection> detections;
+            success = ImageProcessor::detectImage(image_data, image_size, detections);
+            for (const YOLODetection& detection : detections) {
+                objects.push_back(object_json(detection.class_id, detection.class_name,
+                                              detection.confidence, detection.box));
+            }
+        }
+        LOG_INFO(std::string(segment ? "POST /segment" : "POST /detect") + " State: " + std::to_string(success)
+            + ", objects: " + std::to_string(objects.size()));
+
+        if (!success) {
+            HttpResponse response(500, keep_alive);
+            response.set_content_type("text/plain");
+            response.set_body(std::string_view("图像处理失败"));
+            guard.respond(std::move(response));
+            return;
+        }
+        nlohmann::json body = {
+            {"width", image_size.width},
+            {"height", image_size.height},
+            {"objects", std::move(objects)}
+        };
+        HttpResponse response(200, keep_alive);
+        response.set_content_type("application/json");
+        response.set_body(body.dump());
+        guard.respond(std::move(response));
+    });
+}
 
-             // 从 epoll 中移除，因为任务将在线程池中完成并关闭连接
-            epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client_fd, nullptr);
-            _client_parsers.erase(client_fd);
+void Server::serve_static(Reactor& reactor, int client_fd, HttpParser& parser, bool keep_alive) {
+    std::shared_ptr<const StaticAsset> asset = _static_assets.find(parser.get_path());
+    if (!asset) {
+        LOG_INFO("response to fd=" + std::to_string(client_fd) + ": 404 Not Found [" + std::string(parser.get_path()) + "]");
+        reactor.send_response(client_fd, HttpResponse(404, keep_alive));
+        return;
+    }
 
-        } else {
-             std::string response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
-             send(client_fd, response.c_str(), response.length(), 0);
-             close_connection(client_fd);
+    // 根据 Accept-Encoding 选择预压缩版本，各版本使用不同的强 ETag
+    const char* encoding = StaticAssets::select_encoding(*asset, parser.get_header(HeaderId::ACCEPT_ENCODING));
+    const std::string* body = &asset->body;
+    std::string etag = asset->etag;
+    if (encoding) {
+        body = std::string_view(encoding) == "br" ? &asset->brotli_body : &asset->gzip_body;
+        etag.insert(etag.size() - 1, std::string("-") + encoding);
+    }
+    // 304 与 200 带相同的 Vary，缓存才能按编码分别保存
+    bool vary = !asset->gzip_body.empty() || !asset->brotli_body.empty();
+
+    std::string_view if_none_match = parser.get_header(HeaderId::IF_NONE_MATCH);
+    if (!if_none_match.empty() && (if_none_match == "*" || if_none_match.find(etag) != std::string_view::npos)) {
+        HttpResponse response(304, keep_alive);
+        response.add_header("ETag", etag);
+        if (vary) {
+            response.add_header("Vary", "Accept-Encoding");
         }
+        reactor.send_response(client_fd, std::move(response));
+        return;
     }
+
+    HttpResponse response(200, keep_alive);
+    response.set_content_type(asset->mime_type);
+    response.add_header("ETag", etag);
+    response.add_header("Cache-Control", "no-cache");
+    if (vary) {
+        response.add_header("Vary", "Accept-Encoding");
+    }
+    if (encoding) {
+        response.add_header("Content-Encoding", encoding);
+    }
+    // 响应体直接引用内存中的资源，asset 保证发送期间数据有效
+    response.set_body_view(body->data(), body->size(), asset);
+    reactor.send_response(client_fd, std::move(response));
+}
+
+void Server::serve_stats(Reactor& reactor, int client_fd, bool keep_alive) {
+    AdmissionController::Stats stats = _admission.stats();
+    nlohmann::json body = {
+        {"connections", _current_connections.load()},
+        {"admission", {
+            {"admitted", stats.admitted},
+            {"rejected_tasks", stats.rejected_tasks},
+            {"rejected_bytes", stats.rejected_bytes},
+            {"rejected_work", stats.rejected_work},
+            {"tasks", stats.tasks},
+            {"bytes", stats.bytes},
+            {"work", stats.work}
+        }}
+    };
+
+    HttpResponse response(200, keep_alive);
+    response.set_content_type("application/json");
+    response.add_header("Cache-Control", "no-store");
+    response.set_body(body.dump());
+    reactor.send_response(client_fd, std::move(response));
 }
 
-void Server::close_connection(int fd) {
-    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
-    close(fd);
-    _client_parsers.erase(fd);
-    _current_connections--;
-    // std::cout << "关闭连接 fd=" << fd << " (当前连接数: " << _current_connections << "/" << MAX_CONNECTIONS << ")" << std::endl;
-    LOG_INFO("关闭连接 fd=" + std::to_string(fd) + " (当前连接数: " + std::to_string(_current_connections) + "/" + std::to_string(MAX_CONNECTIONS) + ")");
+void Server::reject_overloaded(Reactor& reactor, int client_fd, bool keep_alive) {
+    LOG_DEBUG("线程池过载，拒绝 fd=" + std::to_string(client_fd) + " 的请求");
+    HttpResponse response(503, keep_alive);
+    response.set_content_type("text/plain");
+    response.add_header("Retry-After", std::to_string(_admission.retry_after_seconds()));
+    response.set_body(std::string_view("服务器繁忙，请稍后重试"));
+    reactor.send_response(client_fd, std::move(response));
 }
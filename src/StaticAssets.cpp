@@ -0,0 +1,289 @@
+#include "StaticAssets.h"
+#include "HttpScanner.h"
+#include "utils.h"
+#include "Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+// 读取二进制文件内容
+bool read_file(const fs::path& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+// 强 ETag：内容长度 + 64 位 FNV-1a 哈希
+std::string make_etag(const std::string& data) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream ss;
+    ss << '"' << std::hex << data.size() << '-' << std::setw(16) << std::setfill('0') << hash << '"';
+    return ss.str();
+}
+
+// 文本类资源才值得压缩，图片等已压缩格式直接跳过
+bool is_compressible(const std::string& mime_type) {
+    return mime_type.compare(0, 5, "text/") == 0
+        || mime_type == "application/javascript"
+        || mime_type == "application/json";
+}
+
+std::string gzip_compress(const std::string& data) {
+#ifdef HAVE_ZLIB
+    z_stream zs = {};
+    // windowBits 加 16 生成 gzip 格式
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return "";
+    }
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END) {
+        return "";
+    }
+    out.resize(zs.total_out);
+    return out;
+#else
+    (void)data;
+    return "";
+#endif
+}
+
+std::string brotli_compress(const std::string& data) {
+#ifdef HAVE_BROTLI
+    size_t out_size = BrotliEncoderMaxCompressedSize(data.size());
+    if (out_size == 0) {
+        return "";
+    }
+    std::string out(out_size, '\0');
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               data.size(), reinterpret_cast<const uint8_t*>(data.data()),
+                               &out_size, reinterpret_cast<uint8_t*>(&out[0]))) {
+        return "";
+    }
+    out.resize(out_size);
+    return out;
+#else
+    (void)data;
+    return "";
+#endif
+}
+
+// q 值（"0"～"1"，最多三位小数）换算为千分数，格式错误返回 -1
+int parse_quality(std::string_view value) {
+    if (value.empty() || (value[0] != '0' && value[0] != '1')) {
+        return -1;
+    }
+    int quality = (value[0] - '0') * 1000;
+    if (value.size() == 1) {
+        return quality;
+    }
+    if (value[1] != '.' || value.size() > 5) {
+        return -1;
+    }
+    int scale = 100;
+    for (char c : value.substr(2)) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        quality += (c - '0') * scale;
+        scale /= 10;
+    }
+    return quality <= 1000 ? quality : -1;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+// Accept-Encoding 中 coding 的 q 值（千分数）：没有列出时取 "*" 的值，都没有则为 0（不可接受）
+int encoding_quality(std::string_view accept_encoding, std::string_view coding) {
+    int quality = -1;
+    int wildcard = 0;
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view name = trim(item.substr(0, semicolon));
+        int item_quality = 1000;
+        while (semicolon != std::string_view::npos) {
+            item = item.substr(semicolon + 1);
+            semicolon = item.find(';');
+            std::string_view param = trim(item.substr(0, semicolon));
+            if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                item_quality = std::max(parse_quality(param.substr(2)), 0);
+            }
+        }
+        if (HttpScanner::equals_ci(name, coding)) {
+            quality = item_quality;
+        } else if (name == "*") {
+            wildcard = item_quality;
+        }
+    }
+    return quality >= 0 ? quality : wildcard;
+}
+
+// 为目录及其所有子目录添加 inotify 监视
+void add_watches(int inotify_fd, const std::string& root) {
+    inotify_add_watch(inotify_fd, root.c_str(), WATCH_MASK);
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            inotify_add_watch(inotify_fd, it->path().c_str(), WATCH_MASK);
+        }
+    }
+}
+
+} // namespace
+
+StaticAssets::StaticAssets(const std::string& root)
+    : _root(root), _table(std::make_shared<const Table>()), _stop(false) {
+}
+
+StaticAssets::~StaticAssets() {
+    _stop = true;
+    if (_watcher.joinable()) {
+        _watcher.join();
+    }
+}
+
+bool StaticAssets::load() {
+    auto table = std::make_shared<Table>();
+    size_t total_bytes = 0;
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(_root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+
+        auto asset = std::make_shared<StaticAsset>();
+        if (!read_file(it->path(), asset->body)) {
+            LOG_ERROR("无法读取静态文件: " + it->path().string());
+            continue;
+        }
+
+        std::string relative = fs::relative(it->path(), _root, ec).generic_string();
+        asset->mime_type = get_mime_type(relative);
+        asset->etag = make_etag(asset->body);
+
+        if (is_compressible(asset->mime_type)) {
+            // 只保留确实更小的压缩版本
+            asset->gzip_body = gzip_compress(asset->body);
+            if (asset->gzip_body.size() >= asset->body.size()) asset->gzip_body.clear();
+            asset->brotli_body = brotli_compress(asset->body);
+            if (asset->brotli_body.size() >= asset->body.size()) asset->brotli_body.clear();
+        }
+
+        total_bytes += asset->body.size();
+        LOG_INFO("加载静态文件 /" + relative + " (" + asset->mime_type + ", " + std::to_string(asset->body.size())
+            + " 字节, gzip " + std::to_string(asset->gzip_body.size())
+            + " 字节, br " + std::to_string(asset->brotli_body.size()) + " 字节)");
+        (*table)["/" + relative] = std::move(asset);
+    }
+
+    if (ec) {
+        LOG_ERROR("扫描静态资源目录失败: " + _root + " (" + ec.message() + ")");
+        return false;
+    }
+
+    std::atomic_store(&_table, std::shared_ptr<const Table>(std::move(table)));
+    LOG_INFO("静态资源加载完成: " + _root + ", 共 " + std::to_string(total_bytes) + " 字节");
+    return true;
+}
+
+std::shared_ptr<const StaticAsset> StaticAssets::find(std::string_view path) const {
+    std::shared_ptr<const Table> table = std::atomic_load(&_table);
+
+    // 去掉查询字符串
+    std::string key(path.substr(0, path.find('?')));
+    if (key.empty() || key.back() == '/') {
+        key += "index.html";
+    }
+
+    auto it = table->find(key);
+    if (it == table->end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+const char* StaticAssets::select_encoding(const StaticAsset& asset, std::string_view accept_encoding) {
+    int brotli = asset.brotli_body.empty() ? 0 : encoding_quality(accept_encoding, "br");
+    int gzip = asset.gzip_body.empty() ? 0 : encoding_quality(accept_encoding, "gzip");
+    if (brotli > 0 && brotli >= gzip) {
+        return "br";
+    }
+    if (gzip > 0) {
+        return "gzip";
+    }
+    return nullptr;
+}
+
+void StaticAssets::watch() {
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd == -1) {
+        LOG_ERROR("inotify 初始化失败，静态资源不会自动重新加载");
+        return;
+    }
+    add_watches(inotify_fd, _root);
+    _watcher = std::thread(&StaticAssets::watch_loop, this, inotify_fd);
+}
+
+void StaticAssets::watch_loop(int inotify_fd) {
+    char buffer[4096];
+    while (!_stop) {
+        pollfd pfd = { inotify_fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, 500);
+        if (ret <= 0) {
+            continue;
+        }
+
+        // 编辑器保存通常产生一串事件，稍等片刻后合并为一次重新加载
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        while (read(inotify_fd, buffer, sizeof(buffer)) > 0) {
+        }
+
+        LOG_INFO("检测到静态资源变化，重新加载: " + _root);
+        load();
+        add_watches(inotify_fd, _root);
+    }
+    close(inotify_fd);
+}
@@ -1,40 +1,219 @@
 #include "ThreadPool.h"
+#include "WorkStealingDeque.h"
 #include <iostream>
+#include <algorithm>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
-ThreadPool::ThreadPool(size_t threads) : stop(false) {
+namespace {
+
+constexpr size_t MAX_INJECT_BATCH = 32;  // 每次从注入队列转入本地队列的任务数上限
+constexpr uint32_t INJECTOR_CHECK_INTERVAL = 61;  // 本地任务不断时，每执行这么多个任务先看一次注入队列
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex 需要 32 位的原子变量");
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    // 值已改变时立即返回；被信号打断或虚假唤醒由调用方重新检查
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+} // namespace
+
+struct ThreadPool::Worker {
+    Worker(ThreadPool& pool, size_t index)
+        : pool(pool), index(index), rng(static_cast<uint32_t>(index) * 2654435761u + 1), ticks(0) {}
+
+    // xorshift，只用于选择窃取对象
+    uint32_t next_random() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    ThreadPool& pool;
+    size_t index;
+    WorkStealingDeque<Task> deque;
+    uint32_t rng;
+    uint32_t ticks;
+    std::thread thread;
+};
+
+thread_local ThreadPool::Worker* ThreadPool::_current_worker = nullptr;
+
+ThreadPool::ThreadPool(size_t threads) : _injected(0), _epoch(0), _sleepers(0), _stop(false) {
+    // 先创建全部队列再启动线程，窃取时其他线程的队列都已存在
     for(size_t i = 0; i < threads; ++i) {
-        workers.emplace_back([this] {
-            while(true) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this]{ return this->stop || !this->tasks.empty(); });
-                    
-                    if(this->stop && this->tasks.empty())
-                        return;
-                        
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
-                try {
-                    task();
-                } catch (const std::exception& e) {
-                    std::cerr << "线程池任务中发生异常: " << e.what() << std::endl;
-                }
-            }
-        });
+        _workers.push_back(std::make_unique<Worker>(*this, i));
+    }
+    for(size_t i = 0; i < threads; ++i) {
+        _workers[i]->thread = std::thread([this, i] { worker_loop(i); });
     }
 }
 
 ThreadPool::~ThreadPool() {
+    shutdown();
+    // 没有工作线程时注入队列中可能还有任务
+    for (Task* task : _injector) {
+        delete task;
+    }
+}
+
+void ThreadPool::shutdown() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        // 与注入队列的入队互斥：此后外部线程不能再提交任务
+        std::lock_guard<std::mutex> lock(_injector_mutex);
+        _stop.store(true, std::memory_order_seq_cst);
     }
-    condition.notify_all();
-    for(std::thread &worker: workers) {
-        if(worker.joinable()) {
-            worker.join();
+    _epoch.fetch_add(1, std::memory_order_release);
+    futex_wake(_epoch, INT_MAX);
+    for(auto& worker : _workers) {
+        if(worker->thread.joinable()) {
+            worker->thread.join();
         }
     }
 }
+
+void ThreadPool::submit(std::unique_ptr<Task> task) {
+    Worker* self = _current_worker;
+    if (self && &self->pool == this) {
+        if (_stop.load(std::memory_order_acquire))
+            throw std::runtime_error("在已停止的线程池上入队");
+        self->deque.push(task.release());
+    } else {
+        std::lock_guard<std::mutex> lock(_injector_mutex);
+        if (_stop.load(std::memory_order_relaxed))
+            throw std::runtime_error("在已停止的线程池上入队");
+        _injector.push_back(task.release());
+        _injected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 与 worker_loop() 中登记休眠后的再次检查配对：要么这里看到休眠的线程并唤醒，
+    // 要么休眠前的检查看到刚放入的任务
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleepers.load(std::memory_order_relaxed) > 0) {
+        wake_one();
+    }
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    Worker& self = *_workers[index];
+    _current_worker = &self;
+
+    while(true) {
+        // 先读取停止标志再找任务：停止后不会再有外部任务，本地队列只有自己会放入
+        bool stopping = _stop.load(std::memory_order_acquire);
+        if (Task* raw = find_task(self)) {
+            std::unique_ptr<Task> task(raw);
+            try {
+                (*task)();
+            } catch (const std::exception& e) {
+                std::cerr << "线程池任务中发生异常: " << e.what() << std::endl;
+            }
+            continue;
+        }
+        if (stopping) {
+            // 其他线程队列中剩余的任务由它们自己执行完
+            break;
+        }
+
+        // 登记休眠后再检查一次，避免错过登记之前刚提交的任务
+        uint32_t epoch = _epoch.load(std::memory_order_acquire);
+        _sleepers.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_work() && !_stop.load(std::memory_order_relaxed)) {
+            park(epoch);
+        }
+        _sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    _current_worker = nullptr;
+}
+
+ThreadPool::Task* ThreadPool::find_task(Worker& self) {
+    // 本地队列后进先出，工作线程不断提交后续任务时，定期让注入队列中的外部任务先执行
+    if (++self.ticks % INJECTOR_CHECK_INTERVAL == 0) {
+        if (Task* task = take_injected(self)) {
+            return task;
+        }
+    }
+    if (Task* task = self.deque.pop()) {
+        return task;
+    }
+    if (Task* task = take_injected(self)) {
+        return task;
+    }
+    return steal(self);
+}
+
+ThreadPool::Task* ThreadPool::take_injected(Worker& self) {
+    if (_injected.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    Task* first = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_injector_mutex);
+        if (_injector.empty()) {
+            return nullptr;
+        }
+        // 按线程数均分，一次取出多个，减少对注入队列的加锁次数
+        size_t batch = std::min({_injector.size(), _injector.size() / _workers.size() + 1, MAX_INJECT_BATCH});
+        first = _injector.front();
+        _injector.pop_front();
+        for (size_t i = 1; i < batch; ++i) {
+            self.deque.push(_injector.front());
+            _injector.pop_front();
+        }
+        _injected.fetch_sub(batch, std::memory_order_relaxed);
+    }
+    // 还有剩余任务时叫醒一个休眠的线程来分担
+    if (_sleepers.load(std::memory_order_relaxed) > 0 && has_work()) {
+        wake_one();
+    }
+    return first;
+}
+
+ThreadPool::Task* ThreadPool::steal(Worker& self) {
+    size_t count = _workers.size();
+    if (count < 2) {
+        return nullptr;
+    }
+    // 从随机位置开始依次尝试，避免所有空闲线程都盯着同一个队列
+    size_t start = self.next_random() % count;
+    for (size_t i = 0; i < count; ++i) {
+        Worker& victim = *_workers[(start + i) % count];
+        if (&victim == &self) {
+            continue;
+        }
+        if (Task* task = victim.deque.steal()) {
+            if (_sleepers.load(std::memory_order_relaxed) > 0 && !victim.deque.empty()) {
+                wake_one();
+            }
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadPool::has_work() const {
+    if (_injected.load(std::memory_order_relaxed) > 0) {
+        return true;
+    }
+    return std::any_of(_workers.begin(), _workers.end(),
+                       [](const std::unique_ptr<Worker>& worker) { return !worker->deque.empty(); });
+}
+
+void ThreadPool::wake_one() {
+    _epoch.fetch_add(1, std::memory_order_release);
+    futex_wake(_epoch, 1);
+}
+
+void ThreadPool::park(uint32_t epoch) {
+    // 登记休眠之后有任务提交时 _epoch 已改变，futex 立即返回
+    futex_wait(_epoch, epoch);
+}
@@ -0,0 +1,136 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+
+uint64_t slot_index(uint64_t tick, int level) {
+    return (tick >> (level * TimerWheel::SLOT_BITS)) & SLOT_MASK;
+}
+
+} // namespace
+
+TimerWheel::TimerWheel() : _start(Clock::now()), _current_tick(0), _count(0) {
+    for (auto& level : _slots) {
+        for (TimerNode& head : level) {
+            head.prev = head.next = &head;
+        }
+    }
+}
+
+uint64_t TimerWheel::to_tick(Clock::time_point time) const {
+    if (time <= _start) {
+        return 0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time - _start).count();
+    return static_cast<uint64_t>(elapsed) / TICK_MS;
+}
+
+void TimerWheel::schedule(TimerNode& node, Clock::time_point deadline) {
+    cancel(node);
+    if (_count == 0) {
+        // 时间轮为空时直接跳到当前时间，避免长时间空闲后逐个 tick 追赶
+        _current_tick = std::max(_current_tick, to_tick(Clock::now()));
+    }
+    // 向上取整，保证不会早于期限触发；已过期的定时器在下一个 tick 触发
+    uint64_t tick = to_tick(deadline) + 1;
+    node.expire_tick = std::max(tick, _current_tick + 1);
+    link(node);
+    ++_count;
+}
+
+void TimerWheel::cancel(TimerNode& node) {
+    if (!node.linked()) {
+        return;
+    }
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = node.next = nullptr;
+    --_count;
+}
+
+void TimerWheel::link(TimerNode& node) {
+    // 按距离到期的 tick 数选择层级，超出最大范围的放在最高层最远的槽
+    uint64_t delta = node.expire_tick - _current_tick;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << ((level + 1) * SLOT_BITS))) {
+        ++level;
+    }
+    uint64_t max_delta = (1ULL << (LEVELS * SLOT_BITS)) - 1;
+    uint64_t tick = delta > max_delta ? _current_tick + max_delta : node.expire_tick;
+
+    TimerNode& head = _slots[level][slot_index(tick, level)];
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+}
+
+void TimerWheel::cascade(int level) {
+    // 将该层当前槽的所有节点按剩余时间重新放入更低的层
+    TimerNode& head = _slots[level][slot_index(_current_tick, level)];
+    TimerNode* node = head.next;
+    head.prev = head.next = &head;
+    while (node != &head) {
+        TimerNode* next = node->next;
+        link(*node);
+        node = next;
+    }
+}
+
+void TimerWheel::advance(Clock::time_point now, const std::function<void(TimerNode&)>& on_expire) {
+    uint64_t target = to_tick(now);
+    if (_count == 0) {
+        _current_tick = std::max(_current_tick, target);
+        return;
+    }
+    while (_current_tick < target) {
+        ++_current_tick;
+
+        // 低层转完一圈时，从上一层取下对应的槽
+        for (int level = 1; level < LEVELS; ++level) {
+            if (slot_index(_current_tick, level - 1) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        TimerNode& head = _slots[0][slot_index(_current_tick, 0)];
+        while (head.next != &head) {
+            TimerNode& node = *head.next;
+            cancel(node);
+            if (node.expire_tick > _current_tick) {
+                // 超出时间轮范围的节点，重新放回
+                link(node);
+                ++_count;
+                continue;
+            }
+            on_expire(node);
+        }
+    }
+}
+
+int TimerWheel::next_timeout_ms(Clock::time_point now) const {
+    if (_count == 0) {
+        return -1;
+    }
+    // 在第 0 层查找最近的非空槽；找不到时在第 0 层转完一圈（需要 cascade）时醒来
+    uint64_t ticks = SLOTS - slot_index(_current_tick, 0);
+    for (uint64_t i = 1; i < static_cast<uint64_t>(SLOTS); ++i) {
+        uint64_t tick = _current_tick + i;
+        const TimerNode& head = _slots[0][slot_index(tick, 0)];
+        if (head.next != &head) {
+            ticks = i;
+            break;
+        }
+        if (slot_index(tick, 0) == SLOTS - 1) {
+            ticks = i + 1;
+            break;
+        }
+    }
+
+    auto wake_at = _start + std::chrono::milliseconds((_current_tick + ticks) * TICK_MS);
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake_at - now).count();
+    return static_cast<int>(std::max<int64_t>(0, wait));
+}
@@ -0,0 +1,120 @@
+#include "UnixSocket.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <Logger.h>
+
+namespace {
+
+// 抽象命名空间的名称以 '\0' 开头、不以 '\0' 结尾，地址长度必须精确
+socklen_t make_address(const std::string& address, sockaddr_un& addr) {
+    std::string_view name = std::string_view(address).substr(unix_socket::PREFIX.size());
+    bool abstract = !name.empty() && name[0] == '@';
+    if (name.empty() || (abstract && name.size() == 1)) {
+        throw std::runtime_error("无效的 Unix 域 socket 地址: " + address);
+    }
+    if (name.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Unix 域 socket 路径过长: " + address);
+    }
+
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, name.data(), name.size());
+    if (abstract) {
+        addr.sun_path[0] = '\0';
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + name.size());
+    }
+    return static_cast<socklen_t>(sizeof(addr));
+}
+
+// 路径上已有文件：没有进程在监听的 socket 文件（上次退出时遗留）删除，其余情况拒绝启动
+void remove_stale_socket(const std::string& address, const sockaddr_un& addr, socklen_t len) {
+    struct stat st;
+    if (stat(addr.sun_path, &st) < 0) {
+        return;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        throw std::runtime_error("Unix 域 socket 路径已被其他文件占用: " + address);
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe == -1) {
+        throw std::runtime_error("无法创建 Unix 域 socket: " + std::string(strerror(errno)));
+    }
+    int ret = connect(probe, reinterpret_cast<const sockaddr*>(&addr), len);
+    int err = errno;
+    close(probe);
+    if (ret == 0) {
+        throw std::runtime_error("已有进程在监听 " + address);
+    }
+    if (err == ECONNREFUSED) {
+        unlink(addr.sun_path);
+        LOG_INFO("删除遗留的 socket 文件 " + std::string(addr.sun_path));
+    }
+}
+
+} // namespace
+
+namespace unix_socket {
+
+bool is_address(std::string_view address) {
+    return address.substr(0, PREFIX.size()) == PREFIX;
+}
+
+int listen(const std::string& address, int backlog) {
+    sockaddr_un addr;
+    socklen_t len = make_address(address, addr);
+    bool abstract = addr.sun_path[0] == '\0';
+    if (!abstract) {
+        remove_stale_socket(address, addr, len);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        throw std::runtime_error("无法创建 Unix 域 socket: " + std::string(strerror(errno)));
+    }
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), len) < 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error("无法绑定到 " + address + ": " + strerror(err));
+    }
+    if (::listen(fd, backlog) < 0) {
+        int err = errno;
+        close(fd);
+        if (!abstract) unlink(addr.sun_path);
+        throw std::runtime_error("无法监听 " + address + ": " + strerror(err));
+    }
+    return fd;
+}
+
+std::string local_address(int fd) {
+    sockaddr_un addr = {};
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0 || addr.sun_family != AF_UNIX) {
+        return std::string();
+    }
+    size_t name_len = len > offsetof(sockaddr_un, sun_path) ? len - offsetof(sockaddr_un, sun_path) : 0;
+    if (name_len == 0) {
+        return std::string();
+    }
+    if (addr.sun_path[0] == '\0') {
+        return std::string(PREFIX) + "@" + std::string(addr.sun_path + 1, name_len - 1);
+    }
+    return std::string(PREFIX) + std::string(addr.sun_path, strnlen(addr.sun_path, name_len));
+}
+
+void set_buffer_sizes(int fd, int send_size, int recv_size) {
+    if (send_size > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_size, sizeof(send_size));
+    }
+    if (recv_size > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &recv_size, sizeof(recv_size));
+    }
+}
+
+} // namespace unix_socket
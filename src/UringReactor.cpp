@@ -0,0 +1,450 @@
+#include "UringReactor.h"
+#include "Server.h"
+#include "Connection.h"
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <Logger.h>
+
+namespace {
+
+constexpr unsigned RING_ENTRIES = 4096;
+constexpr unsigned BUFFER_COUNT = 1024;      // 缓冲区个数（2 的幂）
+constexpr size_t BUFFER_SIZE = 32 * 1024;    // 单个接收缓冲区大小
+constexpr uint16_t BUFFER_GROUP = 0;
+
+// user_data 高两位为操作类型，其余位为连接句柄（generation << 32 | fd）或 SendOp 指针
+enum Op : uint64_t {
+    OP_RECV = 0,
+    OP_SEND = 1,
+    OP_CLOSE = 2,
+    OP_CONTROL = 3   // 低 32 位为监听 fd，或 WAKEUP_ID
+};
+constexpr uint64_t OP_SHIFT = 62;
+constexpr uint64_t PAYLOAD_MASK = (1ULL << OP_SHIFT) - 1;
+constexpr uint32_t WAKEUP_ID = 0xFFFFFFFF;
+constexpr uint64_t IGNORED = 0;  // 取消、主动 close 等无需处理结果的操作
+
+uint64_t encode(Op op, uint64_t payload) {
+    return (static_cast<uint64_t>(op) << OP_SHIFT) | (payload & PAYLOAD_MASK);
+}
+
+} // namespace
+
+UringReactor::UringReactor(int id, Server& server, const char* addr, const std::vector<int>& ports,
+                           const std::vector<ListenSocket>& inherited)
+    : Reactor(id, server, addr, ports, inherited), _buf_ring(nullptr) {
+
+    io_uring_params params = {};
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    int ret = io_uring_queue_init_params(RING_ENTRIES, &_ring, &params);
+    if (ret == -EINVAL) {
+        // 旧内核不支持 COOP_TASKRUN
+        params = {};
+        ret = io_uring_queue_init_params(RING_ENTRIES, &_ring, &params);
+    }
+    if (ret < 0) {
+        throw std::runtime_error("Reactor " + std::to_string(_id) + " 无法初始化 io_uring: " + strerror(-ret));
+    }
+
+    // 注册接收缓冲区环，multishot recv 从中取缓冲区
+    _buf_ring = io_uring_setup_buf_ring(&_ring, BUFFER_COUNT, BUFFER_GROUP, 0, &ret);
+    if (!_buf_ring) {
+        io_uring_queue_exit(&_ring);
+        throw std::runtime_error("Reactor " + std::to_string(_id) + " 无法注册接收缓冲区环: " + strerror(-ret));
+    }
+    _buffers.resize(BUFFER_COUNT * BUFFER_SIZE);
+    for (unsigned i = 0; i < BUFFER_COUNT; ++i) {
+        io_uring_buf_ring_add(_buf_ring, _buffers.data() + i * BUFFER_SIZE, BUFFER_SIZE, i,
+                              io_uring_buf_ring_mask(BUFFER_COUNT), i);
+    }
+    io_uring_buf_ring_advance(_buf_ring, BUFFER_COUNT);
+
+    // io_uring 自行等待就绪，监听 socket 无需非阻塞；
+    // 接管的 socket 与旧进程共享文件状态，旧进程排空前仍在用它 accept，保持非阻塞
+    for (const ListenSocket& listener : _listeners) {
+        bool shared = std::any_of(inherited.begin(), inherited.end(),
+                                  [&listener](const ListenSocket& l) { return l.fd == listener.fd; });
+        if (!shared) {
+            int flags = fcntl(listener.fd, F_GETFL, 0);
+            fcntl(listener.fd, F_SETFL, flags & ~O_NONBLOCK);
+        }
+        arm_accept(listener.fd);
+    }
+    arm_wakeup();
+}
+
+UringReactor::~UringReactor() {
+    if (_buf_ring) {
+        io_uring_free_buf_ring(&_ring, _buf_ring, BUFFER_COUNT, BUFFER_GROUP);
+    }
+    io_uring_queue_exit(&_ring);
+}
+
+io_uring_sqe* UringReactor::get_sqe() {
+    io_uring_sqe* sqe = io_uring_get_sqe(&_ring);
+    if (!sqe) {
+        // 提交队列已满，先提交已有请求
+        io_uring_submit(&_ring);
+        sqe = io_uring_get_sqe(&_ring);
+    }
+    return sqe;
+}
+
+void UringReactor::reserve_sqes(unsigned count) {
+    // 链接的请求必须在同一次提交中，否则链接会被截断
+    if (io_uring_sq_space_left(&_ring) < count) {
+        io_uring_submit(&_ring);
+    }
+}
+
+UringReactor::IoState& UringReactor::io_state(int fd) {
+    if (static_cast<size_t>(fd) >= _io.size()) {
+        size_t capacity = _io.empty() ? 1024 : _io.size();
+        while (capacity <= static_cast<size_t>(fd)) capacity *= 2;
+        _io.resize(capacity);
+    }
+    return _io[fd];
+}
+
+void UringReactor::arm_accept(int listen_fd) {
+    io_uring_sqe* sqe = get_sqe();
+    // 客户端 socket 保持阻塞模式，由 io_uring 负责异步等待
+    io_uring_prep_multishot_accept(sqe, listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    io_uring_sqe_set_data64(sqe, encode(OP_CONTROL, static_cast<uint32_t>(listen_fd)));
+}
+
+void UringReactor::arm_wakeup() {
+    io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_poll_multishot(sqe, _wakeup_fd, POLLIN);
+    io_uring_sqe_set_data64(sqe, encode(OP_CONTROL, WAKEUP_ID));
+}
+
+void UringReactor::arm_recv(Connection& conn) {
+    io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_recv_multishot(sqe, conn.fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, encode(OP_RECV, ConnectionTable::make_handle(conn)));
+    io_state(conn.fd).recv_armed = true;
+}
+
+void UringReactor::pause_recv(int fd) {
+    Connection* conn = _connections.get(fd);
+    if (!conn || (!conn->in_flight && !conn->handler)) {
+        return;
+    }
+    IoState& io = io_state(fd);
+    if (!io.recv_armed || io.recv_cancelling || io.closing) {
+        return;
+    }
+    // 取消完成前已在完成队列中的数据仍会交给解析器缓存，最多几个缓冲区
+    io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_cancel64(sqe, encode(OP_RECV, ConnectionTable::make_handle(*conn)), 0);
+    io_uring_sqe_set_data64(sqe, IGNORED);
+    io.recv_cancelling = true;
+}
+
+void UringReactor::submit_close(int fd) {
+    // 先取消该 fd 上的所有请求（io_uring 持有的引用会让 socket 无法真正关闭），再关闭
+    reserve_sqes(2);
+    io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_cancel_fd(sqe, fd, IORING_ASYNC_CANCEL_ALL);
+    sqe->flags |= IOSQE_IO_HARDLINK;
+    io_uring_sqe_set_data64(sqe, IGNORED);
+
+    sqe = get_sqe();
+    io_uring_prep_close(sqe, fd);
+    io_uring_sqe_set_data64(sqe, IGNORED);
+}
+
+void UringReactor::recycle_buffer(uint16_t bid) {
+    io_uring_buf_ring_add(_buf_ring, _buffers.data() + bid * BUFFER_SIZE, BUFFER_SIZE, bid,
+                          io_uring_buf_ring_mask(BUFFER_COUNT), 0);
+    io_uring_buf_ring_advance(_buf_ring, 1);
+}
+
+void UringReactor::run() {
+    while (!drained()) {
+        // 提交积累的请求并等待完成事件；没有定时器时无限等待
+        int timeout = _timers.next_timeout_ms(TimerWheel::Clock::now());
+        __kernel_timespec ts;
+        __kernel_timespec* ts_ptr = nullptr;
+        if (timeout >= 0) {
+            ts.tv_sec = timeout / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout % 1000) * 1000000;
+            ts_ptr = &ts;
+        }
+
+        io_uring_cqe* cqe = nullptr;
+        int ret = io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, ts_ptr, nullptr);
+        if (ret < 0 && ret != -ETIME && ret != -EINTR) {
+            LOG_ERROR("Reactor " + std::to_string(_id) + " io_uring 等待失败: " + strerror(-ret));
+            break;
+        }
+
+        // 先标记完成事件已处理再分发，处理过程中可以继续提交新请求
+        while (io_uring_peek_cqe(&_ring, &cqe) == 0) {
+            uint64_t user_data = io_uring_cqe_get_data64(cqe);
+            int res = cqe->res;
+            uint32_t flags = cqe->flags;
+            io_uring_cqe_seen(&_ring, cqe);
+            handle_cqe(user_data, res, flags);
+        }
+
+        expire_timers();
+    }
+    // 提交排空过程中最后产生的 close
+    io_uring_submit(&_ring);
+    LOG_INFO("Reactor " + std::to_string(_id) + " 已停止");
+}
+
+void UringReactor::handle_cqe(uint64_t user_data, int res, uint32_t flags) {
+    if (user_data == IGNORED) {
+        return;
+    }
+    uint64_t payload = user_data & PAYLOAD_MASK;
+    switch (static_cast<Op>(user_data >> OP_SHIFT)) {
+        case OP_RECV:
+            on_recv(payload, res, flags);
+            break;
+        case OP_SEND:
+            on_send(reinterpret_cast<SendOp*>(payload), res);
+            break;
+        case OP_CLOSE:
+            on_close(payload, res);
+            break;
+        case OP_CONTROL:
+            if (static_cast<uint32_t>(payload) == WAKEUP_ID) {
+                uint64_t count;
+                while (read(_wakeup_fd, &count, sizeof(count)) > 0) {
+                }
+                if (!(flags & IORING_CQE_F_MORE)) {
+                    arm_wakeup();
+                }
+                run_pending_tasks();
+            } else {
+                on_accept(static_cast<int>(static_cast<uint32_t>(payload)), res, flags);
+            }
+            break;
+    }
+}
+
+void UringReactor::on_accept(int listen_fd, int res, uint32_t flags) {
+    // multishot accept 结束（出错或被取消）时重新提交；排空开始后监听socket已关闭
+    if (!(flags & IORING_CQE_F_MORE) && !_draining) {
+        arm_accept(listen_fd);
+    }
+    if (res < 0) {
+        if (res != -EAGAIN && res != -EINTR && res != -ECONNABORTED && res != -ECANCELED) {
+            LOG_ERROR("Reactor " + std::to_string(_id) + " accept 出错: " + strerror(-res));
+        }
+        return;
+    }
+
+    int client_fd = res;
+    Connection* conn = open_connection(client_fd, listen_fd);
+    if (!conn) {
+        LOG_ERROR("Reactor " + std::to_string(_id) + " 达到最大连接数限制 (" + std::to_string(_max_connections)
+            + ")，拒绝新连接");
+        return;
+    }
+    // fd 被复用时，旧连接遗留的请求在完成时会因句柄过期而被忽略
+    io_state(client_fd) = IoState();
+    arm_recv(*conn);
+}
+
+void UringReactor::on_recv(uint64_t handle, int res, uint32_t flags) {
+    bool has_buffer = flags & IORING_CQE_F_BUFFER;
+    uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    Connection* conn = _connections.get_by_handle(handle);
+    if (!conn) {
+        if (has_buffer) recycle_buffer(bid);
+        return;
+    }
+    int fd = conn->fd;
+    if (!(flags & IORING_CQE_F_MORE)) {
+        io_state(fd).recv_armed = false;
+        io_state(fd).recv_cancelling = false;
+    }
+
+    if (res > 0) {
+        // 请求处理期间收到的数据由解析器缓存（流水线），处理完成后继续解析
+        receive(*conn, _buffers.data() + bid * BUFFER_SIZE, static_cast<size_t>(res));
+        recycle_buffer(bid);
+        handle_client_data(fd);
+        return;
+    }
+    if (has_buffer) recycle_buffer(bid);
+
+    if (res == 0) {
+        // 客户端关闭连接
+        LOG_INFO("客户端 fd=" + std::to_string(fd) + " 断开连接");
+        close_connection(fd);
+    } else if (res == -ENOBUFS) {
+        // 缓冲区暂时用尽（已处理的缓冲区刚刚归还），重新提交 recv
+        handle_client_data(fd);
+    } else if (res == -ECANCELED) {
+        // 请求处理期间或发送积压时取消的 recv；若已在取消完成前恢复，这里重新提交
+        if (!io_state(fd).closing) {
+            handle_client_data(fd);
+        }
+    } else {
+        LOG_ERROR("recv 出错: " + std::string(strerror(-res)) + " (fd=" + std::to_string(fd) + ")");
+        close_connection(fd);
+    }
+}
+
+void UringReactor::handle_client_data(int client_fd) {
+    Connection* conn = dispatch_requests(client_fd);
+    if (!conn) {
+        // 请求处理期间（或接管连接的发送队列积压时）不再接收，否则客户端可以无限制地发送数据
+        pause_recv(client_fd);
+        return;
+    }
+    update_timer(*conn);
+    IoState& io = io_state(client_fd);
+    if (!io.recv_armed && !io.closing) {
+        arm_recv(*conn);
+    }
+}
+
+void UringReactor::flush(Connection& conn) {
+    int fd = conn.fd;
+    IoState& io = io_state(fd);
+    if (io.send || io.closing) {
+        // 上一次发送完成后会继续
+        return;
+    }
+    if (conn.out_queue.empty()) {
+        write_complete(conn);
+        return;
+    }
+
+    auto op = std::make_unique<SendOp>();
+    op->handle = ConnectionTable::make_handle(conn);
+    int iov_count = fill_iovecs(conn, op->iov, MAX_IOV);
+    op->msg.msg_iov = op->iov;
+    op->msg.msg_iovlen = iov_count;
+    // 整个队列一次发完且最后一个响应要求关闭连接时，链接 close（流式响应须等结束分块；
+    // 拒绝请求的响应发出后还要丢弃剩余数据，不能直接关闭）
+    op->close_linked = iov_count < MAX_IOV && !conn.streaming && !conn.out_queue.back().keep_alive()
+        && !conn.parser.has_error();
+
+    reserve_sqes(op->close_linked ? 3 : 1);
+    io_uring_sqe* sqe = get_sqe();
+    // 链接 close 时使用 MSG_WAITALL：未全部发出视为失败，链接的 close 随之取消
+    io_uring_prep_sendmsg(sqe, fd, &op->msg, MSG_NOSIGNAL | (op->close_linked ? MSG_WAITALL : 0));
+    io_uring_sqe_set_data64(sqe, encode(OP_SEND, reinterpret_cast<uint64_t>(op.get())));
+
+    if (op->close_linked) {
+        sqe->flags |= IOSQE_IO_LINK;
+
+        sqe = get_sqe();
+        io_uring_prep_cancel_fd(sqe, fd, IORING_ASYNC_CANCEL_ALL);
+        sqe->flags |= IOSQE_IO_HARDLINK;
+        io_uring_sqe_set_data64(sqe, IGNORED);
+
+        sqe = get_sqe();
+        io_uring_prep_close(sqe, fd);
+        io_uring_sqe_set_data64(sqe, encode(OP_CLOSE, op->handle));
+        io.closing = true;
+    }
+    io.send = op.release();
+
+    // 发送有进展即重新计时
+    update_timer(conn);
+}
+
+void UringReactor::on_send(SendOp* op, int res) {
+    std::unique_ptr<SendOp> owner(op);
+    Connection* conn = _connections.get_by_handle(op->handle);
+    if (!conn) {
+        // 连接已关闭，暂存的响应数据随 op 释放
+        return;
+    }
+    int fd = conn->fd;
+    io_state(fd).send = nullptr;
+
+    if (op->close_linked) {
+        if (res >= 0 && consume_sent(*conn, static_cast<size_t>(res))) {
+            // 全部发出，等待链接的 close 完成
+            return;
+        }
+        // 发送失败，链接的 close 已被取消，由 on_close 补上关闭
+        release_connection(fd);
+        return;
+    }
+
+    if (res < 0) {
+        if (res == -EINTR || res == -EAGAIN) {
+            flush(*conn);
+            return;
+        }
+        LOG_ERROR("send失败: " + std::string(strerror(-res)) + " (fd=" + std::to_string(fd) + ")");
+        close_connection(fd);
+        return;
+    }
+
+    if (!consume_sent(*conn, static_cast<size_t>(res))) {
+        // 部分写入，继续发送剩余数据
+        flush(*conn);
+        return;
+    }
+    // 响应已全部发出
+    write_complete(*conn);
+    handle_client_data(fd);
+}
+
+void UringReactor::on_close(uint64_t handle, int res) {
+    int fd = ConnectionTable::handle_fd(handle);
+    if (_connections.get_by_handle(handle)) {
+        release_connection(fd);
+    }
+    if (res == -ECANCELED) {
+        // 链接的发送失败或被取消，fd 仍未关闭
+        submit_close(fd);
+    }
+}
+
+void UringReactor::stop_accepting() {
+    // 取消 multishot accept 后关闭；已在完成队列中的连接照常处理
+    for (const ListenSocket& listener : _listeners) {
+        submit_close(listener.fd);
+    }
+}
+
+void UringReactor::close_connection(int fd) {
+    Connection* conn = _connections.get(fd);
+    if (!conn) {
+        return;
+    }
+    IoState& io = io_state(fd);
+    SendOp* op = io.send;
+    if (op) {
+        // 内核可能仍在读取这些数据，保留到发送完成
+        op->orphaned = std::move(conn->out_queue);
+    }
+    bool linked = io.closing;
+    release_connection(fd);
+    io.send = nullptr;
+    io.recv_armed = false;
+    io.closing = true;
+
+    if (linked) {
+        // 已链接 close：取消可能因客户端不读取而挂起的发送，close 被取消后由 on_close 补上
+        if (op) {
+            io_uring_sqe* sqe = get_sqe();
+            io_uring_prep_cancel64(sqe, encode(OP_SEND, reinterpret_cast<uint64_t>(op)), 0);
+            io_uring_sqe_set_data64(sqe, IGNORED);
+        }
+        return;
+    }
+    submit_close(fd);
+}
@@ -0,0 +1,287 @@
+#include "WebSocketParser.h"
+#include "HttpResponse.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr std::string_view WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr size_t MAX_CONTROL_PAYLOAD = 125;
+
+uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// 握手只需要对几十字节做一次 SHA-1，不为此引入 OpenSSL
+std::array<uint8_t, 20> sha1(std::string_view input) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string message(input);
+    uint64_t bit_len = static_cast<uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int i = 7; i >= 0; --i) {
+        message.push_back(static_cast<char>(bit_len >> (i * 8)));
+    }
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(message.data() + block + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            digest[i * 4 + j] = static_cast<uint8_t>(h[i] >> (24 - j * 8));
+        }
+    }
+    return digest;
+}
+
+std::string base64(const uint8_t* data, size_t len) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t group = uint32_t(data[i]) << 16;
+        if (i + 1 < len) group |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < len) group |= uint32_t(data[i + 2]);
+        out.push_back(table[(group >> 18) & 0x3f]);
+        out.push_back(table[(group >> 12) & 0x3f]);
+        out.push_back(i + 1 < len ? table[(group >> 6) & 0x3f] : '=');
+        out.push_back(i + 2 < len ? table[group & 0x3f] : '=');
+    }
+    return out;
+}
+
+// 去除掩码：offset 是这段数据在帧负载中的位置；对齐到掩码周期后按 8 字节处理
+void unmask(char* data, size_t len, const uint8_t mask[4], uint64_t offset) {
+    size_t i = 0;
+    for (; i < len && (offset + i) % 4 != 0; ++i) {
+        data[i] ^= mask[(offset + i) % 4];
+    }
+    uint8_t repeated[8] = {mask[0], mask[1], mask[2], mask[3], mask[0], mask[1], mask[2], mask[3]};
+    uint64_t word_mask;
+    std::memcpy(&word_mask, repeated, sizeof(word_mask));
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        word ^= word_mask;
+        std::memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < len; ++i) {
+        data[i] ^= mask[(offset + i) % 4];
+    }
+}
+
+} // namespace
+
+WebSocketParser::WebSocketParser(size_t max_message_size)
+    : _max_message_size(max_message_size), _error(0), _header_len(0), _header_need(2), _fin(false),
+      _opcode(CONTINUATION), _remaining(0), _offset(0), _message_opcode(CONTINUATION) {
+    std::memset(_mask, 0, sizeof(_mask));
+}
+
+bool WebSocketParser::fail(uint16_t code) {
+    _error = code;
+    _message.clear();
+    _control.clear();
+    return false;
+}
+
+bool WebSocketParser::feed(const char* data, size_t len, const Handler& handler) {
+    const char* end = data + len;
+    while (data < end && _error == 0) {
+        if (_header_len < _header_need) {
+            size_t n = std::min(_header_need - _header_len, static_cast<size_t>(end - data));
+            std::memcpy(_header + _header_len, data, n);
+            _header_len += n;
+            data += n;
+            if (_header_len < _header_need) {
+                break;
+            }
+            if (_header_len == 2) {
+                // 前两个字节决定帧头的实际长度：扩展长度和掩码
+                uint8_t len7 = _header[1] & 0x7f;
+                _header_need = 2 + (len7 == 126 ? 2 : len7 == 127 ? 8 : 0) + ((_header[1] & 0x80) ? 4 : 0);
+                if (_header_need > 2) {
+                    continue;
+                }
+            }
+            if (!start_frame()) {
+                return false;
+            }
+            if (_remaining == 0) {
+                finish_frame(handler);
+            }
+            continue;
+        }
+
+        // 负载：控制帧和数据帧写入各自的缓冲区，复制后原地去除掩码
+        std::vector<char>& target = (_opcode & 0x8) ? _control : _message;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(_remaining, end - data));
+        size_t old_size = target.size();
+        target.insert(target.end(), data, data + n);
+        unmask(target.data() + old_size, n, _mask, _offset);
+        data += n;
+        _offset += n;
+        _remaining -= n;
+        if (_remaining == 0) {
+            finish_frame(handler);
+        }
+    }
+    return _error == 0;
+}
+
+bool WebSocketParser::start_frame() {
+    uint8_t b0 = _header[0];
+    uint8_t b1 = _header[1];
+    if ((b0 & 0x70) != 0) {
+        return fail(CLOSE_PROTOCOL_ERROR);  // 没有协商扩展，RSV 位必须为 0
+    }
+    if ((b1 & 0x80) == 0) {
+        return fail(CLOSE_PROTOCOL_ERROR);  // 客户端帧必须带掩码
+    }
+    _fin = (b0 & 0x80) != 0;
+    _opcode = static_cast<Opcode>(b0 & 0x0f);
+
+    uint64_t len = b1 & 0x7f;
+    size_t pos = 2;
+    if (len == 126) {
+        len = (uint64_t(_header[2]) << 8) | _header[3];
+        pos = 4;
+    } else if (len == 127) {
+        len = 0;
+        for (int i = 0; i < 8; ++i) {
+            len = (len << 8) | _header[2 + i];
+        }
+        if (len >> 63) {
+            return fail(CLOSE_PROTOCOL_ERROR);
+        }
+        pos = 10;
+    }
+    std::memcpy(_mask, _header + pos, sizeof(_mask));
+
+    switch (_opcode) {
+        case CLOSE:
+        case PING:
+        case PONG:
+            // 控制帧不分片，负载最多 125 字节
+            if (!_fin || len > MAX_CONTROL_PAYLOAD) {
+                return fail(CLOSE_PROTOCOL_ERROR);
+            }
+            _control.clear();
+            break;
+        case CONTINUATION:
+            if (_message_opcode == CONTINUATION) {
+                return fail(CLOSE_PROTOCOL_ERROR);
+            }
+            break;
+        case TEXT:
+        case BINARY:
+            if (_message_opcode != CONTINUATION) {
+                return fail(CLOSE_PROTOCOL_ERROR);  // 上一条分片消息尚未结束
+            }
+            _message_opcode = _opcode;
+            _message.clear();
+            break;
+        default:
+            return fail(CLOSE_PROTOCOL_ERROR);
+    }
+    if (!(_opcode & 0x8)) {
+        if (len > _max_message_size - std::min(_message.size(), _max_message_size)) {
+            return fail(CLOSE_TOO_BIG);
+        }
+        _message.reserve(_message.size() + static_cast<size_t>(len));
+    }
+    _remaining = len;
+    _offset = 0;
+    return true;
+}
+
+void WebSocketParser::finish_frame(const Handler& handler) {
+    _header_len = 0;
+    _header_need = 2;
+    if (_opcode & 0x8) {
+        std::vector<char> payload;
+        payload.swap(_control);
+        handler(_opcode, std::move(payload));
+        return;
+    }
+    if (!_fin) {
+        return;
+    }
+    Opcode opcode = _message_opcode;
+    _message_opcode = CONTINUATION;
+    std::vector<char> message;
+    message.swap(_message);
+    handler(opcode, std::move(message));
+}
+
+std::string WebSocketParser::accept_key(std::string_view key) {
+    std::string input(key);
+    input += WEBSOCKET_GUID;
+    std::array<uint8_t, 20> digest = sha1(input);
+    return base64(digest.data(), digest.size());
+}
+
+HttpResponse WebSocketParser::frame(Opcode opcode, std::vector<char> payload, bool keep_alive,
+                                    std::string_view prefix) {
+    char head[10];
+    size_t n = 0;
+    head[n++] = static_cast<char>(0x80 | opcode);
+    uint64_t len = prefix.size() + payload.size();
+    if (len < 126) {
+        head[n++] = static_cast<char>(len);
+    } else if (len <= 0xffff) {
+        head[n++] = 126;
+        head[n++] = static_cast<char>(len >> 8);
+        head[n++] = static_cast<char>(len);
+    } else {
+        head[n++] = 127;
+        for (int i = 7; i >= 0; --i) {
+            head[n++] = static_cast<char>(len >> (i * 8));
+        }
+    }
+    std::string frame_head(head, n);
+    frame_head += prefix;
+    return HttpResponse::raw(frame_head, std::move(payload), keep_alive);
+}
@@ -0,0 +1,237 @@
+#include "WebSocketSession.h"
+#include "Reactor.h"
+#include "ThreadPool.h"
+#include "AdmissionController.h"
+#include "HttpResponse.h"
+#include "ImageProcessor.h"
+#include "Logger.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t MAX_ID_LENGTH = 256;  // 结果 JSON 与帧头一起放在响应头缓冲区中
+
+// 参数可以是字符串或数字（滑动条的值）
+std::string json_param(const nlohmann::json& body, const char* name) {
+    auto it = body.find(name);
+    if (it == body.end() || it->is_null()) {
+        return std::string();
+    }
+    return it->is_string() ? it->get<std::string>() : it->dump();
+}
+
+uint32_t read_be32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+} // namespace
+
+WebSocketSession::WebSocketSession(Reactor& reactor, uint64_t handle, ThreadPool& pool,
+                                   AdmissionController& admission, size_t max_message_size)
+    : _reactor(reactor), _handle(handle), _pool(pool), _admission(admission), _parser(max_message_size),
+      _busy(false), _pong_pending(false), _closing(false), _closed(false) {}
+
+bool WebSocketSession::on_data(const char* data, size_t len) {
+    if (_closing) {
+        // 已发送 CLOSE 帧，等待发送完毕后关闭
+        return true;
+    }
+    bool ok = _parser.feed(data, len, [this](WebSocketParser::Opcode opcode, std::vector<char> payload) {
+        on_message(opcode, std::move(payload));
+    });
+    if (!ok) {
+        LOG_INFO("WebSocket 协议错误，关闭码 " + std::to_string(_parser.error_code()));
+        close(_parser.error_code());
+    }
+    return true;
+}
+
+void WebSocketSession::on_close() {
+    _closed = true;
+    _pending.reset();
+    _image.reset();
+    _pong.clear();
+}
+
+void WebSocketSession::on_writable() {
+    if (_pong_pending && !_closing) {
+        _pong_pending = false;
+        send(WebSocketParser::frame(WebSocketParser::PONG, std::move(_pong)));
+    }
+}
+
+void WebSocketSession::on_message(WebSocketParser::Opcode opcode, std::vector<char> payload) {
+    if (_closing) {
+        return;
+    }
+    switch (opcode) {
+        case WebSocketParser::PING:
+            if (_reactor.queued_responses(_handle) == 0) {
+                send(WebSocketParser::frame(WebSocketParser::PONG, std::move(payload)));
+            } else {
+                // 发送队列未清空时只记下最新的 PING，清空后回复一个 PONG（RFC 6455 5.5.3 允许），
+                // 连续的 PING 不会在队列中堆积 PONG
+                _pong = std::move(payload);
+                _pong_pending = true;
+            }
+            return;
+        case WebSocketParser::PONG:
+            return;
+        case WebSocketParser::CLOSE: {
+            // 回复对方的关闭码，发送完毕后关闭连接
+            uint16_t code = WebSocketParser::CLOSE_NORMAL;
+            if (payload.size() >= 2) {
+                code = static_cast<uint16_t>((static_cast<unsigned char>(payload[0]) << 8)
+                                             | static_cast<unsigned char>(payload[1]));
+            }
+            close(code);
+            return;
+        }
+        default:
+            break;
+    }
+
+    Request request;
+    std::string error;
+    if (!parse_request(payload, opcode == WebSocketParser::BINARY, request, error)) {
+        reply(request.id, 400, error);
+        return;
+    }
+    if (_busy) {
+        // 只保留最新的请求，拖动滑动条时中间的参数不必处理
+        if (_pending) {
+            reply(_pending->id, 409, "已被更新的请求替换");
+        }
+        _pending = std::move(request);
+        return;
+    }
+    submit(std::move(request));
+}
+
+bool WebSocketSession::parse_request(std::vector<char>& payload, bool binary, Request& request,
+                                     std::string& error) {
+    // 二进制消息：4 字节大端 JSON 长度 + JSON + 图像；文本消息只有 JSON
+    const char* json_begin = payload.data();
+    size_t json_len = payload.size();
+    if (binary) {
+        if (payload.size() < 4 || read_be32(payload.data()) > payload.size() - 4) {
+            error = "消息格式错误";
+            return false;
+        }
+        json_begin += 4;
+        json_len = read_be32(payload.data());
+    }
+
+    nlohmann::json body = nlohmann::json::parse(json_begin, json_begin + json_len, nullptr, false);
+    if (body.is_discarded() || !body.is_object()) {
+        error = "参数不是有效的 JSON 对象";
+        return false;
+    }
+    auto id = body.find("id");
+    if (id != body.end() && id->dump().size() <= MAX_ID_LENGTH) {
+        request.id = *id;
+    }
+    request.filter = json_param(body, "filter");
+    request.blur_intensity = json_param(body, "blur_intensity");
+    request.sharpen_intensity = json_param(body, "sharpen_intensity");
+
+    size_t image_offset = 4 + json_len;
+    if (binary && payload.size() > image_offset) {
+        // 新图像替换本连接上缓存的图像：去掉前缀后移入，不重新分配
+        payload.erase(payload.begin(), payload.begin() + image_offset);
+        _image = std::make_shared<const std::vector<char>>(std::move(payload));
+    }
+    if (!_image) {
+        error = "没有图像：第一个请求须为带图像的二进制消息";
+        return false;
+    }
+    request.image = _image;
+    return true;
+}
+
+void WebSocketSession::submit(Request request) {
+    size_t bytes = request.image->size();
+    std::optional<AdmissionController::Ticket> ticket =
+        _admission.try_admit(bytes, AdmissionController::estimate_work(request.filter, bytes));
+    if (!ticket) {
+        reply(request.id, 503, "服务器繁忙");
+        return;
+    }
+
+    _busy = true;
+    std::shared_ptr<WebSocketSession> self = shared_from_this();
+    try {
+        _pool.enqueue([self, ticket = std::move(*ticket), request = std::move(request)]() {
+            std::vector<char> output;
+            std::string content_type;
+            bool success = false;
+            try {
+                success = ImageProcessor::process(*request.image, output, request.filter, content_type,
+                                                  request.blur_intensity, request.sharpen_intensity);
+            } catch (const std::exception& e) {
+                LOG_ERROR(std::string("WebSocket 图像处理异常: ") + e.what());
+            }
+            // 结果交回 Reactor 线程发送
+            self->_reactor.post([self, id = request.id, success, content_type, output = std::move(output)]() mutable {
+                self->complete(id, success ? 200 : 500, content_type, std::move(output));
+            });
+        });
+    } catch (const std::runtime_error&) {
+        // 线程池已停止（进程退出中）
+        _busy = false;
+        close(WebSocketParser::CLOSE_NORMAL);
+    }
+}
+
+void WebSocketSession::complete(const nlohmann::json& id, int status, const std::string& content_type,
+                                std::vector<char> image) {
+    _busy = false;
+    if (_closed || _closing) {
+        return;
+    }
+    if (status == 200) {
+        send_result({{"id", id}, {"status", status}, {"content_type", content_type}}, std::move(image));
+    } else {
+        reply(id, status, "图像处理失败");
+    }
+    if (_pending) {
+        Request next = std::move(*_pending);
+        _pending.reset();
+        submit(std::move(next));
+    }
+}
+
+void WebSocketSession::reply(const nlohmann::json& id, int status, const std::string& error) {
+    send_result({{"id", id}, {"status", status}, {"error", error}}, std::vector<char>());
+}
+
+void WebSocketSession::send_result(const nlohmann::json& head, std::vector<char> image) {
+    // 长度前缀和 JSON 与帧头一起放在响应头缓冲区，图像数据不拷贝
+    std::string json = head.dump();
+    std::string prefix(4, '\0');
+    uint32_t len = static_cast<uint32_t>(json.size());
+    for (int i = 0; i < 4; ++i) {
+        prefix[i] = static_cast<char>(len >> (24 - i * 8));
+    }
+    prefix += json;
+    send(WebSocketParser::frame(WebSocketParser::BINARY, std::move(image), true, prefix));
+}
+
+void WebSocketSession::send(HttpResponse frame) {
+    if (_closed || _reactor.queued_responses(_handle) == SIZE_MAX) {
+        return;
+    }
+    _reactor.send_response(ConnectionTable::handle_fd(_handle), std::move(frame));
+}
+
+void WebSocketSession::close(uint16_t code) {
+    if (_closing) {
+        return;
+    }
+    _closing = true;
+    _pending.reset();
+    std::vector<char> payload = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+    send(WebSocketParser::frame(WebSocketParser::CLOSE, std::move(payload), false));
+}
@@ -7,6 +7,23 @@
 #include <algorithm>
 #include <Logger.h>
 
+namespace {
+
+// 批量推理输出中第 index 张图像对应的部分：第 0 维取 1，数据不拷贝
+std::vector<cv::Mat> batch_item(const std::vector<cv::Mat>& outputs, size_t index) {
+    std::vector<cv::Mat> item;
+    for (const cv::Mat& output : outputs) {
+        std::vector<int> sizes(1, 1);
+        for (int d = 1; d < output.dims; ++d) {
+            sizes.push_back(output.size[d]);
+        }
+        item.emplace_back(output.dims, sizes.data(), output.type(), const_cast<uchar*>(output.ptr(static_cast<int>(index))));
+    }
+    return item;
+}
+
+} // namespace
+
 // COCO数据集的80个类别名称
 const std::vector<std::string> YOLOv8Detector::COCO_CLASSES = {
     "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
@@ -22,6 +39,7 @@ const std::vector<std::string> YOLOv8Detector::COCO_CLASSES = {
 
 YOLOv8Detector::YOLOv8Detector(float conf_threshold, float nms_thresh, int width, int height)
     : model_loaded(false)
+    , batch_supported(true)
     , confidence_threshold(conf_threshold)
     , nms_threshold(nms_thresh)
     , net_width(width)
@@ -44,7 +62,9 @@ bool YOLOv8Detector::loadModel(const std::string& model_path, const std::string&
         file.close();
         
         // 加载ONNX格式的YOLOv8模型
+        std::lock_guard<std::mutex> lock(net_mutex);
         yolo_net = cv::dnn::readNetFromONNX(model_path);
+        batch_supported = true;
         
         // 设置后端和目标设备
         ConfigManager& config = ConfigManager::getInstance();
@@ -99,12 +119,9 @@ std::vector<YOLODetection> YOLOv8Detector::detect(const cv::Mat& image) {
         cv::Mat blob;
         cv::dnn::blobFromImage(image, blob, 1.0/255.0, cv::Size(net_width, net_height), cv::Scalar(0,0,0), true, false);
         
-        // 设置输入
-        yolo_net.setInput(blob);
-        
-        // 前向传播
+        // 设置输入并前向传播
         std::vector<cv::Mat> outputs;
-        yolo_net.forward(outputs, yolo_net.getUnconnectedOutLayersNames());
+        forward(blob, outputs);
         
         // 解析输出
         detections = parseOutputs(outputs, image.size());
@@ -129,12 +146,9 @@ std::vector<YOLOSegmentation> YOLOv8Detector::detectSegmentation(const cv::Mat&
         cv::Mat blob;
         cv::dnn::blobFromImage(image, blob, 1.0/255.0, cv::Size(net_width, net_height), cv::Scalar(0,0,0), true, false);
         
-        // 设置输入
-        yolo_net.setInput(blob);
-        
-        // 前向传播
+        // 设置输入并前向传播
         std::vector<cv::Mat> outputs;
-        yolo_net.forward(outputs, yolo_net.getUnconnectedOutLayersNames());
+        forward(blob, outputs);
         
         // 解析分割输出
         segmentations = parseSegmentationOutputs(outputs, image.size());
@@ -146,6 +160,80 @@ std::vector<YOLOSegmentation> YOLOv8Detector::detectSegmentation(const cv::Mat&
     return segmentations;
 }
 
+std::vector<std::vector<YOLODetection>> YOLOv8Detector::detectBatch(const std::vector<cv::Mat>& images) {
+    std::vector<std::vector<YOLODetection>> results(images.size());
+    if (images.size() == 1) {
+        results[0] = detect(images[0]);
+        return results;
+    }
+    std::vector<cv::Mat> outputs;
+    if (forwardBatch(images, outputs)) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            results[i] = parseOutputs(batch_item(outputs, i), images[i].size());
+        }
+        return results;
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        results[i] = detect(images[i]);
+    }
+    return results;
+}
+
+std::vector<std::vector<YOLOSegmentation>> YOLOv8Detector::detectSegmentationBatch(const std::vector<cv::Mat>& images) {
+    std::vector<std::vector<YOLOSegmentation>> results(images.size());
+    if (images.size() == 1) {
+        results[0] = detectSegmentation(images[0]);
+        return results;
+    }
+    std::vector<cv::Mat> outputs;
+    if (forwardBatch(images, outputs)) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            results[i] = parseSegmentationOutputs(batch_item(outputs, i), images[i].size());
+        }
+        return results;
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        results[i] = detectSegmentation(images[i]);
+    }
+    return results;
+}
+
+void YOLOv8Detector::forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    // 输入 blob 保存在网络中，setInput 和 forward 之间不能被其他线程换掉；
+    // 输出可能直接引用网络内部的缓冲区，解锁前拷贝出来，下一次推理不会覆盖
+    std::lock_guard<std::mutex> lock(net_mutex);
+    yolo_net.setInput(blob);
+    yolo_net.forward(outputs, yolo_net.getUnconnectedOutLayersNames());
+    for (cv::Mat& output : outputs) {
+        output = output.clone();
+    }
+}
+
+bool YOLOv8Detector::forwardBatch(const std::vector<cv::Mat>& images, std::vector<cv::Mat>& outputs) {
+    if (!model_loaded || images.empty() || !batch_supported) {
+        return false;
+    }
+    try {
+        // 所有图像缩放到网络输入尺寸后合成一个 (N, 3, H, W) 的 blob
+        cv::Mat blob;
+        cv::dnn::blobFromImages(images, blob, 1.0/255.0, cv::Size(net_width, net_height), cv::Scalar(0,0,0), true, false);
+        forward(blob, outputs);
+    } catch (const cv::Exception& e) {
+        // 导出时 batch 固定为 1 的模型不接受批量输入
+        std::cerr << "⚠️ 批量推理失败，此后改为逐张推理: " << e.what() << std::endl;
+        batch_supported = false;
+        return false;
+    }
+    for (const cv::Mat& output : outputs) {
+        if (output.dims < 2 || output.size[0] != static_cast<int>(images.size())) {
+            std::cerr << "⚠️ 批量推理输出的 batch 维度不匹配，此后改为逐张推理" << std::endl;
+            batch_supported = false;
+            return false;
+        }
+    }
+    return true;
+}
+
 std::vector<YOLODetection> YOLOv8Detector::parseOutputs(const std::vector<cv::Mat>& outputs, const cv::Size& image_size) {
     std::vector<YOLODetection> detections;
     
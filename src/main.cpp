@@ -1,4 +1,6 @@
 #include "Server.h"
+#include "HotRestart.h"
+#include "ImageProcessor.h"
 #include "ConfigManager.h"
 #include "Logger.h"
 #include <iostream>
@@ -14,18 +16,23 @@ int main(int argc, char* argv[]) {
     // 加载配置文件 单例模式
     ConfigManager& config = ConfigManager::getInstance();
     std::string config_path = "config.json";
+    bool upgrade = false;  // 从正在运行的旧进程接管监听 socket
     
     // 使用getopt解析命令行参数
     int opt;
-    while ((opt = getopt(argc, argv, "p:h")) != -1) {
+    while ((opt = getopt(argc, argv, "p:uh")) != -1) {
         switch (opt) {
             case 'p':
                 config_path = optarg;
                 break;
+            case 'u':
+                upgrade = true;
+                break;
             case 'h':
-                std::cout << "用法: " << argv[0] << " [-p <配置文件路径>] [-h]" << std::endl;
+                std::cout << "用法: " << argv[0] << " [-p <配置文件路径>] [-u] [-h]" << std::endl;
                 std::cout << "选项:" << std::endl;
                 std::cout << "  -p <路径>    指定配置文件路径 (默认: config.json)" << std::endl;
+                std::cout << "  -u          热重启：从正在运行的旧进程接管监听 socket" << std::endl;
                 std::cout << "  -h          显示此帮助信息" << std::endl;
                 return 0;
             case '?':
@@ -63,6 +70,9 @@ int main(int argc, char* argv[]) {
         ports_str += std::to_string(ports[i]);
         if (i < ports.size() - 1) ports_str += ", ";
     }
+    for (const std::string& address : config.getServerUnixSockets()) {
+        ports_str += ", " + address;
+    }
     LOG_INFO(ports_str);
 
     // 从配置文件获取线程池大小
@@ -78,15 +88,33 @@ int main(int argc, char* argv[]) {
         num_threads = std::max(num_threads * 2, 4u);  // 最少4个线程
     }
     
+    // 从配置文件获取 Reactor (epoll 循环) 数量，0 表示每个CPU核心一个
+    int num_reactors = config.getReactorThreads();
+    if (num_reactors <= 0) {
+        num_reactors = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
     LOG_INFO("系统检测到 " + std::to_string(std::thread::hardware_concurrency()) + " 个CPU核心");
     LOG_INFO("配置线程池大小: " + std::to_string(num_threads) + " 个线程");
+    LOG_INFO("配置Reactor数量: " + std::to_string(num_reactors) + " 个epoll循环");
 
+    std::string hot_restart_socket = config.getHotRestartSocket();
     try {
+        HotRestart hot_restart(hot_restart_socket);
+        std::vector<ListenSocket> inherited;
+        if (upgrade) {
+            if (hot_restart_socket.empty()) {
+                throw std::runtime_error("未配置 server.hot_restart_socket，无法热重启");
+            }
+            inherited = hot_restart.fetch();
+        }
+
         // 创建并启动服务器
-        Server server(addr.data(),ports, num_threads);
+        Server server(addr.data(),ports, num_threads, num_reactors, inherited);
 
         
-        LOG_INFO("服务器正在 " + std::to_string(ports.size()) + " 个端口上启动，使用 " + std::to_string(num_threads) + " 个工作线程...");
+        LOG_INFO("服务器正在 " + std::to_string(ports.size()) + " 个端口上启动，使用 " + std::to_string(num_threads) + " 个工作线程, "
+            + std::to_string(num_reactors) + " 个Reactor...");
         
         std::string server_ip = config.getServerIP();
         LOG_INFO("请在浏览器中打开以下任一地址:");
@@ -94,7 +122,20 @@ int main(int argc, char* argv[]) {
             LOG_INFO("  http://" + server_ip + ":" + std::to_string(port));
         }
         
-        server.run(); //  启动
+        // 开始 accept 之前加载并预热模型；热重启时旧进程在此期间照常服务，
+        // 新建的 SO_REUSEPORT socket 预热完成后才开始监听，不会分到新连接
+        ImageProcessor::warmup();
+        server.start_listening();
+        if (upgrade) {
+            hot_restart.notify_ready();
+        }
+        if (!hot_restart_socket.empty()) {
+            hot_restart.serve([&server] { return server.listen_sockets(); },
+                              [&server] { server.begin_drain(); });
+        }
+
+        server.run(); //  启动，热重启交接后排空完成时返回
+        hot_restart.stop();
     } catch (const std::runtime_error& e) {
         LOG_ERROR("服务器启动失败: " + std::string(e.what()));
         return 1;
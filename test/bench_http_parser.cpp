@@ -0,0 +1,131 @@
+#include "HttpParser.h"
+#include "HttpScanner.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+
+// 编译: g++ -std=c++17 -O2 -I../include bench_http_parser.cpp ../src/HttpParser.cpp ../src/HttpScanner.cpp ../src/MultipartParser.cpp -o bench_http_parser
+// 运行: ./bench_http_parser [迭代次数]
+
+namespace {
+
+// 原来的头部解析方式：每行 substr 成 std::string，存入 unordered_map
+struct LegacyHead {
+    std::string method;
+    std::string path;
+    std::string version;
+    std::unordered_map<std::string, std::string> headers;
+};
+
+void legacy_parse(const std::string& buffer, LegacyHead& head) {
+    head.headers.clear();
+    size_t line_end = buffer.find("\r\n");
+    size_t line_start = 0;
+    if (line_end != std::string::npos) {
+        std::string request_line = buffer.substr(0, line_end);
+        size_t method_end = request_line.find(' ');
+        if (method_end != std::string::npos) {
+            head.method = request_line.substr(0, method_end);
+            size_t path_start = method_end + 1;
+            size_t path_end = request_line.find(' ', path_start);
+            if (path_end != std::string::npos) {
+                head.path = request_line.substr(path_start, path_end - path_start);
+                head.version = request_line.substr(path_end + 1);
+            }
+        }
+        line_start = line_end + 2;
+    }
+    while ((line_end = buffer.find("\r\n", line_start)) != std::string::npos) {
+        if (line_end == line_start) {
+            break;
+        }
+        std::string header_line = buffer.substr(line_start, line_end - line_start);
+        size_t colon_pos = header_line.find(':');
+        if (colon_pos != std::string::npos) {
+            head.headers[header_line.substr(0, colon_pos)] = header_line.substr(colon_pos + 2);
+        }
+        line_start = line_end + 2;
+    }
+}
+
+template <class Fn>
+double measure(const std::string& request, size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return request.size() * static_cast<double>(iterations) / elapsed.count() / (1024.0 * 1024.0);
+}
+
+void report(const std::string& name, double mb_per_second) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << mb_per_second << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 200000;
+
+    // 浏览器上传页面时的典型请求头
+    const std::string browser =
+        "POST /upload HTTP/1.1\r\n"
+        "Host: 192.168.25.130:9090\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: 0\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Content-Type: multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW\r\n"
+        "Accept: */*\r\n"
+        "Origin: http://192.168.25.130:9090\r\n"
+        "Referer: http://192.168.25.130:9090/\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+        "\r\n";
+    // curl 的最小请求头
+    const std::string curl =
+        "GET /stats HTTP/1.1\r\n"
+        "Host: localhost:9090\r\n"
+        "User-Agent: curl/7.81.0\r\n"
+        "Accept: */*\r\n"
+        "\r\n";
+
+    // 带长 Cookie / token 的请求头，长字段上向量宽度的差别才明显
+    const std::string long_fields =
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: 192.168.25.130:9090\r\n"
+        "Authorization: Bearer " + std::string(1024, 'a') + "\r\n"
+        "Cookie: " + std::string(2048, 'c') + "\r\n"
+        "\r\n";
+
+    std::cout << "=== 请求头解析吞吐量（" << iterations << " 次）===" << std::endl;
+    for (const auto& sample : {std::make_pair("浏览器", &browser), std::make_pair("curl", &curl), std::make_pair("长字段", &long_fields)}) {
+        const std::string& request = *sample.second;
+        std::cout << "\n" << sample.first << " 请求 (" << request.size() << " 字节):" << std::endl;
+
+        LegacyHead legacy;
+        report("原实现 (substr + map)", measure(request, iterations, [&] { legacy_parse(request, legacy); }));
+
+        RequestHead head;
+        for (HttpScanner::Backend backend : {HttpScanner::Backend::SCALAR, HttpScanner::Backend::SSE42, HttpScanner::Backend::AVX2}) {
+            if (!HttpScanner::select_backend(backend)) {
+                continue;
+            }
+            bool ok = true;
+            double rate = measure(request, iterations, [&] { ok &= HttpScanner::parse(request.data(), request.size(), head); });
+            report(std::string("HttpScanner ") + HttpScanner::backend_name(backend) + (ok ? "" : " (解析失败)"), rate);
+        }
+
+        // 完整路径：查找头部结尾、扫描、提取 Content-Length 等，解析器复用
+        HttpParser parser;
+        report(std::string("HttpParser (") + HttpScanner::backend_name(HttpScanner::backend()) + ")",
+               measure(request, iterations, [&] {
+                   parser.parse(request.data(), request.size());
+                   parser.reset();
+               }));
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "ChunkedDecoder.h"
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <cassert>
+
+// 编译: g++ -std=c++17 -I../include test_chunked_decoder.cpp ../src/ChunkedDecoder.cpp -o test_chunked_decoder
+
+namespace {
+
+// 按 step 字节切分输入逐段解码，返回拼接后的负载
+bool decode_all(const std::string& input, size_t step, std::string& output, ChunkedDecoder& decoder) {
+    output.clear();
+    decoder.reset();
+    for (size_t offset = 0; offset < input.size(); offset += step) {
+        size_t len = std::min(step, input.size() - offset);
+        bool ok = decoder.decode(input.data() + offset, len, [&output](const char* data, size_t n) {
+            output.append(data, n);
+        });
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== ChunkedDecoder 测试 ===" << std::endl;
+    ChunkedDecoder decoder;
+    std::string output;
+
+    // 1. 任意切分位置都得到相同的负载
+    std::cout << "\n1. 切分位置:" << std::endl;
+    {
+        const std::string input = "5\r\nhello\r\n1A;name=value\r\n" + std::string(26, 'x')
+            + "\r\n0\r\nX-Trailer: 1\r\n\r\nGET / HTTP/1.1\r\n";
+        for (size_t step = 1; step <= input.size(); ++step) {
+            assert(decode_all(input, step, output, decoder));
+            assert(output == "hello" + std::string(26, 'x'));
+            assert(decoder.done());
+        }
+        std::cout << "   ✅ 1 到 " << input.size() << " 字节切分均正确" << std::endl;
+    }
+
+    // 2. 未结束的流
+    std::cout << "\n2. 未结束:" << std::endl;
+    {
+        assert(decode_all("4\r\nabcd\r\n8\r\nefg", 3, output, decoder));
+        assert(output == "abcdefg" && !decoder.done());
+        std::cout << "   ✅ 已收到的负载立即交出" << std::endl;
+    }
+
+    // 3. 格式错误
+    std::cout << "\n3. 格式错误:" << std::endl;
+    {
+        assert(!decode_all("zz\r\n", 1, output, decoder));
+        assert(!decode_all("\r\n", 1, output, decoder));
+        assert(!decode_all("3\r\nabcX\r\n", 1, output, decoder));
+        assert(!decode_all("1000000000000000\r\n", 4, output, decoder));
+        // 出错后不再解码
+        assert(!decoder.decode("0\r\n\r\n", 5, [](const char*, size_t) {}));
+        std::cout << "   ✅ 非法长度、缺少 CRLF 和超长长度均被拒绝" << std::endl;
+    }
+
+    std::cout << "\n全部测试通过" << std::endl;
+    return 0;
+}
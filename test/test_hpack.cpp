@@ -0,0 +1,158 @@
+#include "Hpack.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+// 编译: g++ -std=c++17 -I../include test_hpack.cpp ../src/Hpack.cpp -o test_hpack
+
+namespace {
+
+std::string from_hex(const std::string& hex) {
+    std::string out;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+std::vector<HpackHeader> decode(HpackDecoder& decoder, const std::string& block, bool& ok, size_t max_list = 65536) {
+    std::vector<HpackHeader> headers;
+    bool oversized = false;
+    ok = decoder.decode(reinterpret_cast<const uint8_t*>(block.data()), block.size(), max_list, headers, oversized);
+    assert(!oversized);
+    return headers;
+}
+
+bool same(const std::vector<HpackHeader>& a, const std::vector<HpackHeader>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].name != b[i].name || a[i].value != b[i].value) return false;
+    }
+    return true;
+}
+
+// RFC 7541 C.3 / C.4 中连续的三个请求，后两个引用前面加入动态表的项
+void check_request_sequence(const std::vector<std::string>& blocks) {
+    const std::vector<std::vector<HpackHeader>> expected = {
+        {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"}},
+        {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"},
+         {"cache-control", "no-cache"}},
+        {{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"}, {":authority", "www.example.com"},
+         {"custom-key", "custom-value"}},
+    };
+    HpackDecoder decoder;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        bool ok = false;
+        std::vector<HpackHeader> headers = decode(decoder, from_hex(blocks[i]), ok);
+        assert(ok);
+        assert(same(headers, expected[i]));
+    }
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== HPACK 测试 ===" << std::endl;
+
+    // 1. RFC 示例：不使用 Huffman 编码
+    std::cout << "\n1. RFC 7541 C.3:" << std::endl;
+    check_request_sequence({
+        "828684410f7777772e6578616d706c652e636f6d",
+        "828684be58086e6f2d6361636865",
+        "828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565",
+    });
+    std::cout << "   ✅ 动态表引用正确" << std::endl;
+
+    // 2. RFC 示例：Huffman 编码
+    std::cout << "\n2. RFC 7541 C.4:" << std::endl;
+    check_request_sequence({
+        "828684418cf1e3c2e5f23a6ba0ab90f4ff",
+        "828684be5886a8eb10649cbf",
+        "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf",
+    });
+    {
+        std::string out;
+        hpack::encode_string("www.example.com", out);
+        assert(out == from_hex("8cf1e3c2e5f23a6ba0ab90f4ff"));
+    }
+    std::cout << "   ✅ Huffman 编解码与 RFC 一致" << std::endl;
+
+    // 3. 动态表按 RFC 的记账方式淘汰最旧的项
+    std::cout << "\n3. 动态表:" << std::endl;
+    {
+        HpackTable table(100);
+        table.add("custom-key", "custom-value");    // 10 + 12 + 32 = 54
+        table.add("cache-control", "private");      // 13 + 7 + 32 = 52，淘汰第一项
+        assert(table.get(62)->name == "cache-control");
+        assert(table.get(63) == nullptr);
+        size_t name_index = 0;
+        assert(table.find("cache-control", "private", name_index) == 62);
+        assert(table.find(":method", "GET", name_index) == 2);
+        assert(table.find("cache-control", "no-store", name_index) == 0 && name_index == 24);
+        table.set_max_size(0);
+        assert(table.get(62) == nullptr);
+    }
+    std::cout << "   ✅ 淘汰和查找正确" << std::endl;
+
+    // 4. 编码后解码得到原来的头部，重复的头部第二次只需索引
+    std::cout << "\n4. 编码往返:" << std::endl;
+    {
+        std::vector<HpackHeader> headers = {
+            {":status", "200"}, {"content-type", "image/jpeg"}, {"content-length", "123456"},
+            {"x-processing-time", "42ms"},
+        };
+        HpackEncoder encoder;
+        HpackDecoder decoder;
+        std::string first, second;
+        encoder.encode(headers, first);
+        encoder.encode(headers, second);
+        assert(second.size() < first.size());
+        bool ok = false;
+        assert(same(decode(decoder, first, ok), headers) && ok);
+        assert(same(decode(decoder, second, ok), headers) && ok);
+
+        // 对端缩小动态表：下一个头部块以表大小更新开头
+        encoder.set_max_table_size(0);
+        std::string third;
+        encoder.encode(headers, third);
+        assert(static_cast<uint8_t>(third[0]) == 0x20);
+        assert(same(decode(decoder, third, ok), headers) && ok);
+    }
+    std::cout << "   ✅ 往返一致，表大小更新生效" << std::endl;
+
+    // 5. 格式错误与超长头部
+    std::cout << "\n5. 错误处理:" << std::endl;
+    {
+        const std::vector<std::string> invalid = {
+            "80",                // 索引 0
+            "ff00",              // 超出表的索引
+            "823f",              // 表大小更新不在块的开头
+            "3fe21f",            // 表大小更新超过 SETTINGS 的上限（4097）
+            "82ffffffffffff",    // 整数溢出
+            "4188f1e3c2e5f23a6b",  // 字符串被截断
+            "4081ff",            // Huffman 填充超过 7 位
+        };
+        for (const std::string& hex : invalid) {
+            HpackDecoder decoder;
+            bool ok = true;
+            decode(decoder, from_hex(hex), ok);
+            assert(!ok);
+        }
+
+        HpackDecoder decoder;
+        std::string block = from_hex("828684410f7777772e6578616d706c652e636f6d");
+        std::vector<HpackHeader> headers;
+        bool oversized = false;
+        assert(decoder.decode(reinterpret_cast<const uint8_t*>(block.data()), block.size(), 64, headers, oversized));
+        assert(oversized && headers.empty());
+        // 超长的块仍然更新了动态表，之后的块可以引用
+        bool ok = false;
+        std::vector<HpackHeader> next = decode(decoder, from_hex("be"), ok);
+        assert(ok && next.size() == 1 && next[0].value == "www.example.com");
+    }
+    std::cout << "   ✅ 错误被拒绝，超长头部不破坏动态表" << std::endl;
+
+    std::cout << "\n全部测试通过" << std::endl;
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include "HttpParser.h"
+#include "utils.h"
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// 编译: g++ -std=c++17 -I../include test_http_parser.cpp ../src/HttpParser.cpp ../src/HttpScanner.cpp ../src/MultipartParser.cpp -o test_http_parser
+
+static void feed(HttpParser& parser, const std::string& data) {
+    parser.parse(data.data(), data.size());
+}
+
+int main() {
+    std::cout << "=== HttpParser 测试 ===" << std::endl;
+
+    // 1. keep-alive 判定
+    std::cout << "\n1. keep-alive 判定:" << std::endl;
+    {
+        HttpParser parser;
+        feed(parser, "GET / HTTP/1.1\r\nHost: a\r\n\r\n");
+        assert(parser.is_request_ready());
+        assert(parser.get_version() == "HTTP/1.1");
+        assert(parser.keep_alive());
+
+        HttpParser closing;
+        feed(closing, "GET / HTTP/1.1\r\nconnection: Close\r\n\r\n");
+        assert(!closing.keep_alive());
+
+        HttpParser http10;
+        feed(http10, "GET / HTTP/1.0\r\n\r\n");
+        assert(!http10.keep_alive());
+
+        HttpParser http10_keep;
+        feed(http10_keep, "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+        assert(http10_keep.keep_alive());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 2. 流水线请求：Content-Length 之后的数据属于下一个请求
+    std::cout << "\n2. 流水线请求:" << std::endl;
+    {
+        HttpParser parser;
+        feed(parser, "POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabcGET /b HTTP/1.1\r\n\r\nGET /c HT");
+        assert(parser.is_request_ready());
+        assert(parser.get_path() == "/a");
+
+        // 处理期间到达的数据被缓存
+        feed(parser, "TP/1.1\r\n\r\n");
+
+        parser.reset();
+        assert(parser.is_request_ready());
+        assert(parser.get_path() == "/b");
+
+        parser.reset();
+        assert(parser.is_request_ready());
+        assert(parser.get_path() == "/c");
+
+        parser.reset();
+        assert(!parser.is_request_ready());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 3. body 分多次到达，多余部分不会被丢弃
+    std::cout << "\n3. 分段 body:" << std::endl;
+    {
+        HttpParser parser;
+        feed(parser, "POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nab");
+        assert(!parser.is_request_ready());
+        feed(parser, "cdeGET /next HTTP/1.1\r\n\r\n");
+        assert(parser.is_request_ready());
+        parser.reset();
+        assert(parser.is_request_ready());
+        assert(parser.get_path() == "/next");
+    }
+    std::cout << "通过" << std::endl;
+
+    // 4. 通过 body_window()/commit_body() 直接写入 body（对应 Reactor 的 readv 路径）
+    std::cout << "\n4. 直接写入 body:" << std::endl;
+    {
+        std::string body = "--XX\r\nContent-Disposition: form-data; name=\"image\"; filename=\"a.jpg\"\r\n"
+                           "Content-Type: image/jpeg\r\n\r\nJPEGDATA\r\n--XX--\r\n";
+        HttpParser parser;
+        feed(parser, "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=XX\r\nContent-Length: "
+                     + std::to_string(body.size()) + "\r\n\r\n" + body.substr(0, 10));
+        assert(!parser.is_request_ready());
+
+        std::pair<char*, size_t> window = parser.body_window();
+        assert(window.second == body.size() - 10);
+        std::memcpy(window.first, body.data() + 10, window.second);
+        parser.commit_body(window.second);
+        assert(parser.is_request_ready());
+        assert(parser.body_window().second == 0);
+
+        ImageServerDEF::ByteView image = parser.get_image_data();
+        assert(std::string(image.data, image.size) == "JPEGDATA");
+
+        // take_image() 移出同一块缓冲区，不拷贝
+        const char* data = image.data;
+        std::vector<char> taken = parser.take_image();
+        assert(taken.data() == data);
+        assert(parser.get_image_data().empty());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 5. multipart 在任意位置被切开：图片中含有分隔符前缀，字段和图片都能正确取出
+    std::cout << "\n5. 任意切分的 multipart:" << std::endl;
+    {
+        std::string image = "\xff\xd8\r\n--boun\r\n-\r\n--boundar\x00\xff\xd9";
+        std::string body = "preamble\r\n--boundary\r\n"
+                           "Content-Disposition: form-data; name=\"filter\"\r\n\r\nblur\r\n--boundary  \r\n"
+                           "Content-Disposition: form-data; name=\"image\"; filename=\"a.jpg\"\r\n"
+                           "Content-Type: image/jpeg\r\n\r\n" + image + "\r\n--boundary\r\n"
+                           "Content-Disposition: form-data; name=\"uuid\"\r\n\r\nid-1\r\n--boundary--\r\nepilogue";
+        std::string head = "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=\"boundary\"\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+
+        for (size_t step = 1; step <= body.size(); ++step) {
+            // 奇数步长走 parse()，偶数步长走 body_window()/commit_body()
+            HttpParser parser;
+            feed(parser, head);
+            size_t offset = 0;
+            while (offset < body.size()) {
+                size_t len = std::min(step, body.size() - offset);
+                std::pair<char*, size_t> window = parser.body_window();
+                if (step % 2 == 1 || window.second == 0) {
+                    // 与 Reactor 相同：没有可直接写入的区域时走 parse()
+                    parser.parse(body.data() + offset, len);
+                } else {
+                    len = std::min(len, window.second);
+                    std::memcpy(window.first, body.data() + offset, len);
+                    parser.commit_body(len);
+                }
+                offset += len;
+            }
+            assert(parser.is_request_ready());
+            assert(parser.get_filter_type() == "blur");
+            assert(parser.get_header("content-type").substr(0, 19) == "multipart/form-data");
+            assert(parser.get_image_uuid() == "id-1");
+            std::vector<char> data = parser.take_image();
+            assert(std::string(data.begin(), data.end()) == image);
+            assert(parser.take_image().empty());
+        }
+    }
+    std::cout << "通过" << std::endl;
+
+    // 6. 大小限制与 Expect: 100-continue
+    std::cout << "\n6. 大小限制与 100-continue:" << std::endl;
+    {
+        // 请求头没有结束就已超过上限
+        HttpParser long_header;
+        long_header.set_limits(64, 1024);
+        feed(long_header, "GET / HTTP/1.1\r\nX-Long: " + std::string(64, 'a'));
+        assert(long_header.has_error());
+        assert(long_header.error_status() == 431);
+        assert(!long_header.is_request_ready());
+
+        // 头部解析完即拒绝，不等待 body
+        HttpParser too_large;
+        too_large.set_limits(1024, 100);
+        feed(too_large, "POST /upload HTTP/1.1\r\nContent-Length: 101\r\nExpect: 100-continue\r\n\r\n");
+        assert(too_large.has_error());
+        assert(too_large.error_status() == 413);
+        assert(!too_large.take_expect_continue());
+
+        HttpParser expect;
+        expect.set_limits(1024, 100);
+        feed(expect, "POST /upload HTTP/1.1\r\nContent-Length: 100\r\nexpect: 100-Continue\r\n\r\n");
+        assert(!expect.has_error());
+        assert(expect.take_expect_continue());
+        assert(!expect.take_expect_continue());
+        feed(expect, std::string(100, 'x'));
+        assert(expect.is_request_ready());
+
+        // body 已随请求头一起到达时不需要 100 Continue
+        HttpParser eager;
+        feed(eager, "POST /a HTTP/1.1\r\nContent-Length: 2\r\nExpect: 100-continue\r\n\r\nab");
+        assert(eager.is_request_ready());
+        assert(!eager.take_expect_continue());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 7. 请求头扫描：每种实现（CPU 支持时）结果一致
+    std::cout << "\n7. 请求头扫描:" << std::endl;
+    for (HttpScanner::Backend backend : {HttpScanner::Backend::SCALAR, HttpScanner::Backend::SSE42, HttpScanner::Backend::AVX2}) {
+        if (!HttpScanner::select_backend(backend)) {
+            continue;
+        }
+        std::cout << "  " << HttpScanner::backend_name(backend) << std::endl;
+
+        // 长字段跨越多个向量，分隔符出现在向量内的各个位置
+        std::string long_value(70, 'v');
+        HttpParser parser;
+        feed(parser, "POST /upload?filter=" + std::string(40, 'p') + " HTTP/1.1\r\n"
+                     "content-LENGTH:3\r\n"
+                     "Accept-Encoding: \t gzip, br \t\r\n"
+                     "X-Long-Header-Name-Over-Thirty-Two-Bytes:" + long_value + "\r\n"
+                     "X-Empty:\r\n"
+                     "X-Obs-Text: caf\xc3\xa9\r\n"
+                     "\r\nabc");
+        assert(parser.is_request_ready());
+        assert(parser.get_method() == "POST");
+        assert(parser.get_path() == "/upload?filter=" + std::string(40, 'p'));
+        assert(parser.get_header(HeaderId::ACCEPT_ENCODING) == "gzip, br");
+        assert(parser.get_header("accept-encoding") == "gzip, br");
+        assert(parser.get_header("x-long-header-name-over-thirty-two-bytes") == long_value);
+        assert(parser.get_header("X-Empty").empty() && parser.get_header("X-Empty").data() != nullptr);
+        assert(parser.get_header("X-Obs-Text") == "caf\xc3\xa9");
+        assert(parser.get_header("X-Missing").data() == nullptr);
+        assert(parser.body_received() == 3);
+
+        // 格式错误：400
+        const char* bad_requests[] = {
+            "GET /\r\n\r\n",                                     // 缺少版本
+            "GET  / HTTP/1.1\r\n\r\n",                            // 空路径
+            "GET / FTP/1.0\r\n\r\n",                              // 不是 HTTP
+            "GET / HTTP/1.1\r\nNo-Colon\r\n\r\n",                 // 缺少冒号
+            "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n",              // 名称含空格
+            "GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n",          // 折叠行
+            "GET / HTTP/1.1\r\nA: b\x01c\r\n\r\n",               // 值含控制字符
+            "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",      // 非法长度
+            "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n",
+        };
+        for (const char* request : bad_requests) {
+            HttpParser bad;
+            feed(bad, request);
+            assert(bad.has_error());
+            assert(bad.error_status() == 400);
+        }
+    }
+    std::cout << "通过" << std::endl;
+
+    // 8. 原始 body 与查询字符串（POST /process）
+    std::cout << "\n8. 原始 body 与查询字符串:" << std::endl;
+    {
+        HttpParser parser;
+        std::string image(5000, '\xff');
+        feed(parser, "POST /process?filter=blur&blur_intensity=15&note=a%20b+c HTTP/1.1\r\n"
+                     "Content-Type: application/octet-stream\r\nContent-Length: 5000\r\n\r\n");
+        assert(parser.get_path() == "/process?filter=blur&blur_intensity=15&note=a%20b+c");
+        assert(parser.get_body().empty());  // body 尚未接收完
+
+        // 按 Reactor 的方式直接读入 body 缓冲区
+        size_t offset = 0;
+        const char* first = nullptr;
+        while (offset < image.size()) {
+            std::pair<char*, size_t> window = parser.body_window();
+            assert(window.second > 0);
+            if (first == nullptr) {
+                first = window.first;
+            }
+            size_t len = std::min(window.second, image.size() - offset);
+            std::memcpy(window.first, image.data() + offset, len);
+            parser.commit_body(len);
+            offset += len;
+        }
+        assert(parser.is_request_ready());
+        assert(parser.get_body().size == image.size());
+
+        std::vector<char> body = parser.take_body();
+        assert(body.size() == image.size() && body.data() == first);  // 移出，不拷贝
+        assert(std::string(body.begin(), body.end()) == image);
+        assert(parser.get_body().empty());
+
+        std::string_view query = parser.get_query();
+        assert(get_query_param(query, "filter") == "blur");
+        assert(get_query_param(query, "blur_intensity") == "15");
+        assert(get_query_param(query, "note") == "a b c");
+        assert(get_query_param(query, "blur").empty());
+        assert(get_query_param(std::string_view(), "filter").empty());
+
+        // 只收到请求头时不按 Content-Length 初始化整个 body：每段窗口有上限，缓冲区不重新分配
+        HttpParser large;
+        feed(large, "POST /process HTTP/1.1\r\nContent-Length: 10485760\r\n\r\n");
+        std::pair<char*, size_t> window = large.body_window();
+        assert(window.second > 0 && window.second <= 64 * 1024);
+        char* start = window.first;
+        size_t received = 0;
+        while (!large.is_request_ready()) {
+            window = large.body_window();
+            assert(window.first == start + received && window.second > 0 && window.second <= (1 << 20));
+            std::memset(window.first, 'x', window.second);
+            large.commit_body(window.second);
+            received += window.second;
+        }
+        assert(received == 10485760 && large.take_body().data() == start);
+
+        // multipart 请求没有原始 body
+        HttpParser multipart;
+        feed(multipart, "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=b\r\n"
+                        "Content-Length: 6\r\n\r\n--b--\r\n");
+        assert(multipart.is_request_ready());
+        assert(multipart.take_body().empty());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 9. 批量上传：多个文件 part，各自带参数头部
+    std::cout << "\n9. 多个文件 part:" << std::endl;
+    {
+        std::string first(100000, 'a');
+        std::string second(300, 'b');
+        std::string body =
+            "--xyz\r\nContent-Disposition: form-data; name=\"filter\"\r\n\r\ngrayscale"
+            "\r\n--xyz\r\nContent-Disposition: form-data; name=\"a\"; filename=\"a.jpg\"\r\n"
+            "Content-Type: image/jpeg\r\nx-filter:  blur \r\nX-Blur-Intensity: 9\r\n\r\n" + first +
+            "\r\n--xyz\r\nContent-Disposition: form-data; name=\"b\"; filename=\"b.png\"\r\n\r\n" + second +
+            "\r\n--xyz--\r\n";
+        std::string request = "POST /batch HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=xyz\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+
+        // 头部按普通数据解析，body 按 Reactor 的方式直接读入窗口
+        HttpParser parser;
+        feed(parser, request);
+        size_t offset = 0;
+        while (offset < body.size()) {
+            std::pair<char*, size_t> window = parser.body_window();
+            size_t len = std::min(std::min(window.second, body.size() - offset), static_cast<size_t>(7000));
+            std::memcpy(window.first, body.data() + offset, len);
+            parser.commit_body(len);
+            offset += len;
+        }
+        assert(parser.is_request_ready());
+        assert(!parser.multipart_failed());
+        assert(parser.get_filter_type() == "grayscale");
+        assert(parser.get_image_data().empty());  // 没有名为 image 的字段
+
+        std::vector<MultipartParser::FilePart> files = parser.take_files();
+        assert(files.size() == 2);
+        assert(files[0].name == "a" && std::string(files[0].data.begin(), files[0].data.end()) == first);
+        assert(files[0].header_value("X-Filter") == "blur");
+        assert(files[0].header_value("x-blur-intensity") == "9");
+        assert(files[0].header_value("X-Sharpen-Intensity").empty());
+        assert(files[1].name == "b" && std::string(files[1].data.begin(), files[1].data.end()) == second);
+        // 缓冲区容量随数据增长，不按剩余 body 预留
+        assert(files[0].data.capacity() < first.size() * 2);
+        assert(files[1].data.capacity() <= 2 * second.size());
+        assert(parser.take_files().empty());
+
+        // 大量小文件，后面还有一大段被丢弃的数据：每个文件只占用与自身大小相当的容量，
+        // 不按其后剩余的 body 预留
+        std::string many_body;
+        for (int i = 0; i < 1000; ++i) {
+            many_body += "--xyz\r\nContent-Disposition: form-data; name=\"f\"; filename=\"f.jpg\"\r\n\r\n"
+                         + std::string(1000, 'c') + "\r\n";
+        }
+        many_body += "--xyz\r\n\r\n" + std::string(9 * 1024 * 1024, 'p') + "\r\n";
+        many_body += "--xyz--\r\n";
+        HttpParser many;
+        feed(many, "POST /batch HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=xyz\r\n"
+                   "Content-Length: " + std::to_string(many_body.size()) + "\r\n\r\n");
+        offset = 0;
+        while (offset < many_body.size()) {
+            std::pair<char*, size_t> window = many.body_window();
+            size_t len = std::min(window.second, many_body.size() - offset);
+            std::memcpy(window.first, many_body.data() + offset, len);
+            many.commit_body(len);
+            offset += len;
+        }
+        assert(many.is_request_ready() && !many.multipart_failed());
+        std::vector<MultipartParser::FilePart> many_files = many.take_files();
+        assert(many_files.size() == 1000);
+        size_t total_capacity = 0;
+        for (const MultipartParser::FilePart& file : many_files) {
+            assert(file.data.size() == 1000);
+            total_capacity += file.data.capacity();
+        }
+        assert(total_capacity <= 1000 * 1250);
+
+        // 只收到 part 头部时，图片窗口不按剩余 body 初始化
+        HttpParser large;
+        feed(large, "POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=xyz\r\n"
+                    "Content-Length: 10485760\r\n\r\n--xyz\r\nContent-Disposition: form-data; name=\"image\"\r\n\r\n");
+        std::pair<char*, size_t> window = large.body_window();
+        assert(window.second > 0 && window.second <= 64 * 1024);
+        std::memset(window.first, 'x', window.second);
+        large.commit_body(window.second);
+        window = large.body_window();
+        assert(window.second > 0 && window.second <= 128 * 1024);
+        // 图片缓冲区随收到的数据翻倍增长，容量不按剩余 body 预留
+        std::string part_end = "\r\n--xyz--\r\n";
+        size_t received = 128 * 1024;
+        while (received < 4 * 1024 * 1024) {
+            std::memset(window.first, 'x', window.second);
+            large.commit_body(window.second);
+            received += window.second;
+            window = large.body_window();
+        }
+        std::memcpy(window.first, part_end.data(), part_end.size());
+        large.commit_body(part_end.size());
+        std::vector<MultipartParser::FilePart> large_files = large.take_files();
+        assert(large_files.size() == 1 && large_files[0].data.capacity() <= large_files[0].data.size() * 5 / 4);
+    }
+    std::cout << "通过" << std::endl;
+
+    // 10. 推流（POST /stream）：没有长度的请求头，其后的 MJPEG part 交给 MultipartParser 逐帧取出
+    std::cout << "\n10. MJPEG 推流:" << std::endl;
+    {
+        HttpParser parser;
+        feed(parser, "POST /stream HTTP/1.1\r\nContent-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                     "Transfer-Encoding: chunked\r\n\r\n--frame\r\nContent-Type: image/jpeg\r\n\r\nAAAA");
+        assert(parser.is_request_ready() && parser.is_multipart());
+        assert(parser.get_boundary() == "frame");
+        std::string rest = parser.take_pipelined();
+        assert(rest == "--frame\r\nContent-Type: image/jpeg\r\n\r\nAAAA");
+
+        // 没有 Content-Disposition 的 part 也按文件接收；下一个分隔符到达时上一帧完成
+        MultipartParser frames;
+        frames.reset("frame", 16, true);
+        frames.feed(rest.data(), rest.size());
+        assert(frames.take_files().empty());
+        std::string more = "BB\r\n--frame\r\n\r\nCCC\r\n--frame";
+        frames.feed(more.data(), more.size());
+        std::vector<MultipartParser::FilePart> files = frames.take_files();
+        assert(files.size() == 2);
+        assert(std::string(files[0].data.begin(), files[0].data.end()) == "AAAABB");
+        assert(std::string(files[1].data.begin(), files[1].data.end()) == "CCC");
+        assert(!frames.complete() && !frames.failed());
+
+        // 单帧超过上限时视为格式错误
+        std::string large = "\r\n\r\n" + std::string(64, 'x');
+        frames.feed(large.data(), large.size());
+        assert(frames.failed());
+    }
+    std::cout << "通过" << std::endl;
+
+    // 11. Transfer-Encoding：body 边界未知，之后的数据不会被当作下一个请求
+    std::cout << "\n11. Transfer-Encoding:" << std::endl;
+    {
+        HttpParser parser;
+        feed(parser, "POST /process HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                     "12\r\nGET /stats HTTP/1.1\r\n\r\n0\r\n\r\n");
+        assert(parser.is_request_ready() && parser.has_transfer_encoding());
+        assert(parser.get_body().empty());
+        parser.reset();
+        assert(!parser.is_request_ready() && !parser.has_transfer_encoding());
+        assert(parser.take_pipelined().empty());
+
+        // 同时带 Content-Length 和 Transfer-Encoding
+        HttpParser both;
+        feed(both, "POST /process HTTP/1.1\r\nContent-Length: 4\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n");
+        assert(both.has_error() && both.error_status() == 400);
+    }
+    std::cout << "通过" << std::endl;
+
+    std::cout << "\n=== 测试完成 ===" << std::endl;
+    return 0;
+}
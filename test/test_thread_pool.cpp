@@ -0,0 +1,138 @@
+#include "ThreadPool.h"
+#include "WorkStealingDeque.h"
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cassert>
+
+// 编译: g++ -std=c++17 -O2 -pthread -I../include test_thread_pool.cpp ../src/ThreadPool.cpp -o test_thread_pool
+
+int main() {
+    std::cout << "=== ThreadPool 测试 ===" << std::endl;
+
+    // 1. 所属线程不断放入和取出，多个线程同时窃取，每个元素恰好被取走一次
+    std::cout << "\n1. 工作窃取队列:" << std::endl;
+    {
+        constexpr int COUNT = 200000;
+        std::vector<int> items(COUNT);
+        std::vector<std::atomic<int>> taken(COUNT);
+        for (int i = 0; i < COUNT; ++i) {
+            items[i] = i;
+            taken[i] = 0;
+        }
+
+        WorkStealingDeque<int> deque(4);  // 从很小的容量开始，覆盖扩容
+        std::atomic<bool> done(false);
+        std::vector<std::thread> thieves;
+        for (int t = 0; t < 3; ++t) {
+            thieves.emplace_back([&] {
+                while (!done.load() || !deque.empty()) {
+                    if (int* item = deque.steal()) {
+                        taken[*item].fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < COUNT; ++i) {
+            deque.push(&items[i]);
+            if (i % 3 == 0) {
+                if (int* item = deque.pop()) {
+                    taken[*item].fetch_add(1);
+                }
+            }
+        }
+        while (int* item = deque.pop()) {
+            taken[*item].fetch_add(1);
+        }
+        done = true;
+        for (std::thread& thief : thieves) {
+            thief.join();
+        }
+        for (int i = 0; i < COUNT; ++i) {
+            assert(taken[i].load() == 1);
+        }
+    }
+    std::cout << "   ✅ 没有丢失或重复" << std::endl;
+
+    // 2. 外部线程提交，future 返回结果，异常传回调用方
+    std::cout << "\n2. 外部提交:" << std::endl;
+    {
+        ThreadPool pool(4);
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 1000; ++i) {
+            results.push_back(pool.enqueue([](int x) { return x * 2; }, i));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            assert(results[i].get() == i * 2);
+        }
+        auto failed = pool.enqueue([]() -> int { throw std::runtime_error("失败"); });
+        bool thrown = false;
+        try {
+            failed.get();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "   ✅ 结果和异常都经由 future 返回" << std::endl;
+
+    // 3. 任务中继续提交（放入本线程的队列），空闲线程窃取后并行执行
+    std::cout << "\n3. 任务内提交与窃取:" << std::endl;
+    {
+        ThreadPool pool(4);
+        std::atomic<int> finished(0);
+        std::atomic<int> concurrent(0);
+        std::atomic<int> max_concurrent(0);
+        pool.enqueue([&] {
+            for (int i = 0; i < 16; ++i) {
+                pool.enqueue([&] {
+                    int now = ++concurrent;
+                    int seen = max_concurrent.load();
+                    while (now > seen && !max_concurrent.compare_exchange_weak(seen, now)) {}
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    --concurrent;
+                    ++finished;
+                });
+            }
+        }).get();
+        while (finished.load() < 16) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assert(max_concurrent.load() > 1);
+    }
+    std::cout << "   ✅ 子任务被其他线程窃取并行执行" << std::endl;
+
+    // 4. 休眠后再次提交能被唤醒；shutdown 执行完剩余任务，之后拒绝提交
+    std::cout << "\n4. 休眠与停止:" << std::endl;
+    {
+        ThreadPool pool(3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // 所有线程进入休眠
+        for (int round = 0; round < 100; ++round) {
+            assert(pool.enqueue([round] { return round; }).get() == round);
+        }
+
+        std::atomic<int> counter(0);
+        for (int i = 0; i < 500; ++i) {
+            pool.enqueue([&counter] {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                ++counter;
+            });
+        }
+        pool.shutdown();
+        assert(counter.load() == 500);
+        bool rejected = false;
+        try {
+            pool.enqueue([] {});
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+        pool.shutdown();  // 可重复调用
+    }
+    std::cout << "   ✅ 唤醒及时，停止前的任务全部执行" << std::endl;
+
+    std::cout << "\n全部测试通过" << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "TimerWheel.h"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cassert>
+
+// 编译: g++ -std=c++17 -I../include test_timer_wheel.cpp ../src/TimerWheel.cpp -o test_timer_wheel
+
+using Clock = TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+int main() {
+    std::cout << "=== TimerWheel 测试 ===" << std::endl;
+
+    // 1. 设置、取消、重新设置
+    std::cout << "\n1. 设置与取消:" << std::endl;
+    {
+        TimerWheel wheel;
+        Clock::time_point t0 = Clock::now();
+        TimerNode a, b;
+        wheel.schedule(a, t0 + milliseconds(300));
+        wheel.schedule(b, t0 + milliseconds(300));
+        assert(wheel.size() == 2);
+        wheel.cancel(b);
+        assert(wheel.size() == 1 && !b.linked());
+
+        int fired = 0;
+        wheel.advance(t0 + milliseconds(200), [&](TimerNode&) { ++fired; });
+        assert(fired == 0);
+        wheel.advance(t0 + milliseconds(500), [&](TimerNode& node) { assert(&node == &a); ++fired; });
+        assert(fired == 1 && wheel.size() == 0);
+        assert(wheel.next_timeout_ms(t0) == -1);
+    }
+    std::cout << "通过" << std::endl;
+
+    // 2. 跨层级的大量定时器：不早于期限触发，延迟不超过一个 tick
+    std::cout << "\n2. 分层 cascade:" << std::endl;
+    {
+        TimerWheel wheel;
+        Clock::time_point t0 = Clock::now();
+        std::vector<TimerNode> nodes(20000);
+        std::vector<int64_t> due(nodes.size());
+        std::mt19937 rng(1);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            due[i] = rng() % (3 * 3600 * 1000);
+            wheel.schedule(nodes[i], t0 + milliseconds(due[i]));
+        }
+
+        size_t fired = 0;
+        int64_t max_late = 0;
+        for (int64_t ms = 0; ms <= 3 * 3600 * 1000 + 1000; ms += 50) {
+            Clock::time_point now = t0 + milliseconds(ms);
+            wheel.advance(now, [&](TimerNode& node) {
+                size_t i = &node - &nodes[0];
+                assert(due[i] <= ms + 1);
+                max_late = std::max(max_late, ms - due[i]);
+                ++fired;
+            });
+            int timeout = wheel.next_timeout_ms(now);
+            assert(wheel.size() == 0 || (timeout >= 0 && timeout <= TimerWheel::SLOTS * TimerWheel::TICK_MS));
+        }
+        assert(fired == nodes.size());
+        assert(max_late <= 2 * TimerWheel::TICK_MS);
+        std::cout << "最大延迟: " << max_late << " ms" << std::endl;
+    }
+    std::cout << "通过" << std::endl;
+
+    std::cout << "\n=== 测试完成 ===" << std::endl;
+    return 0;
+}
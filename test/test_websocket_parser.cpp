@@ -0,0 +1,122 @@
+#include "WebSocketParser.h"
+#include "HttpResponse.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+// 编译: g++ -std=c++17 -I../include test_websocket_parser.cpp ../src/WebSocketParser.cpp ../src/HttpResponse.cpp -o test_websocket_parser
+
+namespace {
+
+using Message = std::pair<WebSocketParser::Opcode, std::string>;
+
+// 按客户端的方式构造带掩码的帧
+std::string client_frame(uint8_t first_byte, const std::string& payload) {
+    const uint8_t mask[4] = {0x37, 0xfa, 0x21, 0x3d};
+    std::string frame(1, static_cast<char>(first_byte));
+    if (payload.size() < 126) {
+        frame.push_back(static_cast<char>(0x80 | payload.size()));
+    } else if (payload.size() <= 0xffff) {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>(payload.size() >> 8));
+        frame.push_back(static_cast<char>(payload.size()));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 127));
+        for (int i = 7; i >= 0; --i) {
+            frame.push_back(static_cast<char>(static_cast<uint64_t>(payload.size()) >> (i * 8)));
+        }
+    }
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+bool feed_all(WebSocketParser& parser, const std::string& input, size_t step, std::vector<Message>& messages) {
+    for (size_t offset = 0; offset < input.size(); offset += step) {
+        size_t len = std::min(step, input.size() - offset);
+        bool ok = parser.feed(input.data() + offset, len, [&](WebSocketParser::Opcode opcode, std::vector<char> payload) {
+            messages.emplace_back(opcode, std::string(payload.begin(), payload.end()));
+        });
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== WebSocketParser 测试 ===" << std::endl;
+
+    // 1. 握手：RFC 6455 中的示例
+    std::cout << "\n1. Sec-WebSocket-Accept:" << std::endl;
+    assert(WebSocketParser::accept_key("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+    std::cout << "   ✅ 与 RFC 示例一致" << std::endl;
+
+    // 2. 分片消息中间夹着 PING，任意切分位置结果一致
+    std::cout << "\n2. 分片与控制帧:" << std::endl;
+    {
+        std::string large(70000, 'z');  // 64 位长度
+        std::string input = client_frame(0x02, "ab")            // BINARY，未结束
+                          + client_frame(0x89, "ping")           // PING
+                          + client_frame(0x00, std::string(300, 'c'))  // 继续（16 位长度）
+                          + client_frame(0x80, "end")            // 最后一片
+                          + client_frame(0x81, large);           // 完整的 TEXT
+        for (size_t step : {1, 3, 7, 64, 4096, 200000}) {
+            WebSocketParser parser(1 << 20);
+            std::vector<Message> messages;
+            assert(feed_all(parser, input, step, messages));
+            assert(messages.size() == 3);
+            assert(messages[0].first == WebSocketParser::PING && messages[0].second == "ping");
+            assert(messages[1].first == WebSocketParser::BINARY);
+            assert(messages[1].second == "ab" + std::string(300, 'c') + "end");
+            assert(messages[2].first == WebSocketParser::TEXT && messages[2].second == large);
+        }
+        std::cout << "   ✅ 消息按序交出，掩码正确去除" << std::endl;
+    }
+
+    // 3. 协议错误
+    std::cout << "\n3. 协议错误:" << std::endl;
+    {
+        std::vector<Message> messages;
+        WebSocketParser unmasked(1024);
+        std::string frame = "\x81\x02hi";
+        assert(!feed_all(unmasked, frame, 1, messages));
+        assert(unmasked.error_code() == WebSocketParser::CLOSE_PROTOCOL_ERROR);
+
+        WebSocketParser too_big(16);
+        assert(!feed_all(too_big, client_frame(0x02, std::string(17, 'x')), 5, messages));
+        assert(too_big.error_code() == WebSocketParser::CLOSE_TOO_BIG);
+
+        WebSocketParser orphan(1024);
+        assert(!feed_all(orphan, client_frame(0x80, "x"), 1, messages));  // 没有开头的继续帧
+
+        WebSocketParser long_ping(1024);
+        assert(!feed_all(long_ping, client_frame(0x89, std::string(126, 'p')), 1, messages));
+        assert(messages.empty());
+        std::cout << "   ✅ 未加掩码、超长消息、孤立继续帧、超长控制帧均被拒绝" << std::endl;
+    }
+
+    // 4. 服务端帧
+    std::cout << "\n4. 服务端帧:" << std::endl;
+    {
+        HttpResponse frame = WebSocketParser::frame(WebSocketParser::BINARY, std::vector<char>(200, 'd'), true, "pre");
+        frame.finish();
+        std::string_view head = frame.header();
+        assert(head.size() == 4 + 3);
+        assert(static_cast<uint8_t>(head[0]) == 0x82 && head[1] == 126);
+        assert(static_cast<uint8_t>(head[2]) == 0 && static_cast<uint8_t>(head[3]) == 203);
+        assert(head.substr(4) == "pre");
+        assert(frame.total_size() == 4 + 203);
+        std::cout << "   ✅ 长度包含前缀，负载不拷贝" << std::endl;
+    }
+
+    std::cout << "\n全部测试通过" << std::endl;
+    return 0;
+}